@@ -1,6 +1,7 @@
 /* See ecbuff.h and ecbuff_cfg.h for further information */
 
 #include "ecbuff.h"
+#include <stddef.h>
 
 #if defined(ECB_ASSERT)
 #include <assert.h>
@@ -28,13 +29,16 @@
 
 /* Verify configuration */
 #if defined ECB_THREAD_SINGLE
-#if defined(ECB_THREAD_MULTI) || defined(ECB_THREAD_BARRIER) || defined(ECB_THREAD_VOLATILE)
+#if defined(ECB_THREAD_MULTI) || defined(ECB_THREAD_BARRIER) || defined(ECB_THREAD_VOLATILE) || defined(ECB_THREAD_ATOMIC)
 #error ECB_THREAD_SINGLE and other ECB_THREAD options are mutually exclusive!
 #endif
 #else /* !ECB_THREAD_SINGLE */
 #if defined(ECB_THREAD_MULTI)
-#if !(defined(ECB_THREAD_BARRIER) ^ defined(ECB_THREAD_VOLATILE))
-#error ECB_THREAD_MULTI requires ECB_THREAD_BARRIER or ECB_THREAD_VOLATILE
+#if (defined(ECB_THREAD_BARRIER) + defined(ECB_THREAD_VOLATILE) + defined(ECB_THREAD_ATOMIC)) != 1
+#error ECB_THREAD_MULTI requires one of ECB_THREAD_BARRIER, ECB_THREAD_VOLATILE or ECB_THREAD_ATOMIC
+#endif
+#if defined(ECB_THREAD_ATOMIC) && !(__STDC_VERSION__ >= 201112L)
+#error ECB_THREAD_ATOMIC requires C11!
 #endif
 #else /* !ECB_THREAD_MULTI */
 #error ECB_THREAD_SINGLE or ECB_THREAD_MULTI required!
@@ -50,6 +54,23 @@
 #endif /* ECB_WRITE_DROP */
 #endif /* ECB_WRITE_OVERWRITE */
 
+#if defined(ECB_CACHE_PAD) && !defined(ECB_THREAD_MULTI)
+#error ECB_CACHE_PAD requires ECB_THREAD_MULTI!
+#endif
+
+#if defined(ECB_WAIT) && !defined(ECB_THREAD_ATOMIC)
+#error ECB_WAIT requires ECB_THREAD_ATOMIC!
+#endif
+
+#if defined(ECB_TIMESTAMP)
+#if !(__STDC_VERSION__ >= 201112L)
+#error ECB_TIMESTAMP requires C11!
+#endif
+#if !(ECB_TIMESTAMP_EVERY > 0 && (ECB_TIMESTAMP_EVERY & (ECB_TIMESTAMP_EVERY - 1)) == 0)
+#error ECB_TIMESTAMP_EVERY has to be a power of two!
+#endif
+#endif
+
 #if defined(ECB_EXTRA_CHECKS) && !(defined(ECB_WRITE_OVERWRITE) ^ defined(ECB_WRITE_DROP))
 #error ECB_EXTRA_CHECKS requires ECB_WRITE_DROP or ECB_WRITE_OVERWRITE to be defined!
 #endif
@@ -71,15 +92,102 @@
 #define FENCE_ACQUIRE() FENCE_FULL()
 #define FENCE_RELEASE() FENCE_FULL()
 #endif /* C11 */
-#else /* ECB_THREAD_SINGLE or ECB_THREAD_VOLATILE */
+#else /* ECB_THREAD_SINGLE, ECB_THREAD_VOLATILE or ECB_THREAD_ATOMIC */
 #define FENCE_FULL()
 #define FENCE_ACQUIRE() FENCE_FULL()
 #define FENCE_RELEASE() FENCE_FULL()
 #endif /* ECB_THREAD_BARRIER */
 
+/* Access to wp and rp. With ECB_THREAD_ATOMIC the own index is loaded relaxed,
+ * the peer's index with acquire and updates are published with release semantics.
+ * This replaces the standalone fences around ECB_MEMCPY_IN/ECB_MEMCPY_OUT. */
+#if defined(ECB_THREAD_ATOMIC)
+#define ECB_LOAD_RELAXED(x) ((ECB_UINT_T)atomic_load_explicit(&(x), memory_order_relaxed))
+#define ECB_LOAD_ACQUIRE(x) ((ECB_UINT_T)atomic_load_explicit(&(x), memory_order_acquire))
+#define ECB_STORE_RELEASE(x, v) atomic_store_explicit(&(x), (v), memory_order_release)
+#else
+#define ECB_LOAD_RELAXED(x) ((ECB_UINT_T)(x))
+#define ECB_LOAD_ACQUIRE(x) ((ECB_UINT_T)(x))
+#define ECB_STORE_RELEASE(x, v) ((x) = (v))
+#endif /* ECB_THREAD_ATOMIC */
+
+/* ECB_NOTIFY_CONSUMER / ECB_NOTIFY_PRODUCER
+ * Follow each publication of wp (rp). The full fence orders the index store
+ * before loading the peer's parked flag, while a parking peer orders setting
+ * its flag before checking the index again. Thus either the peer notices the
+ * new index or the flag is seen here, and the wake-up syscall is only issued
+ * for a peer that actually parked.
+ */
+#if defined(ECB_WAIT)
+static inline void ecbuff_notify(ECB_PARKED_T* const restrict parked)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if(atomic_load_explicit(parked, memory_order_relaxed))
+        ecbuff_wake(parked);
+}
+#define ECB_NOTIFY_CONSUMER(rb) ecbuff_notify(&(rb)->rd_parked)
+#define ECB_NOTIFY_PRODUCER(rb) ecbuff_notify(&(rb)->wr_parked)
+#else
+#define ECB_NOTIFY_CONSUMER(rb)
+#define ECB_NOTIFY_PRODUCER(rb)
+#endif /* ECB_WAIT */
+
+/* ECB_STAT_ADD / ECB_STAT_MAX
+ * Update a counter on the calling side's cache line. Each counter has a
+ * single writer, so a relaxed load and store replace a read-modify-write.
+ */
+#if defined(ECB_STATS)
+#if defined(ECB_THREAD_ATOMIC)
+#define ECB_STAT_LOAD(x) ((ECB_UINT_T)atomic_load_explicit(&(x), memory_order_relaxed))
+#define ECB_STAT_STORE(x, v) atomic_store_explicit(&(x), (v), memory_order_relaxed)
+#else
+#define ECB_STAT_LOAD(x) ((ECB_UINT_T)(x))
+#define ECB_STAT_STORE(x, v) ((x) = (v))
+#endif
+#define ECB_STAT_ADD(x, n) ECB_STAT_STORE(x, ECB_STAT_LOAD(x) + (n))
+#define ECB_STAT_MAX(x, v) do { if((v) > ECB_STAT_LOAD(x)) ECB_STAT_STORE(x, v); } while(0)
+#else
+#define ECB_STAT_ADD(x, n)
+#define ECB_STAT_MAX(x, v)
+#endif /* ECB_STATS */
+
 #define ECB_MODULUS(x, y) (x % y)
 #define ECB_CHECK_ALIGN(ptr, req) (((uintptr_t)ptr) % req == 0)
 
+#if defined(ECB_POW2)
+/* Count trailing zeros, used to divide by element_size */
+#if defined(__GNUC__) || defined(__clang__)
+#define ECB_CTZ(x) ((ECB_UINT_T)__builtin_ctzll(x))
+#else
+static inline ECB_UINT_T ecbuff_ctz(ECB_UINT_T x)
+{
+    ECB_UINT_T n = 0;
+    while(!(x & 1))
+    {
+        x >>= 1;
+        n++;
+    }
+    return n;
+}
+#define ECB_CTZ(x) ecbuff_ctz(x)
+#endif
+#define ECB_IS_POW2(x) ((x) && !((x) & ((x) - 1)))
+/* Indices run modulo 2 * total_size, the additional bit tells a full buffer
+ * from an empty one. Thus the whole buffer is usable and no division is needed. */
+#define ECB_RANGE(total) ((total) * 2)
+#define ECB_WRAP(x, total) ((x) & (ECB_RANGE(total) - 1))
+#define ECB_OFFSET(x, total) ((x) & ((total) - 1))
+#define ECB_CAPACITY(total, elem) ((void)(elem), (total))
+#define ECB_ELEMS(bytes, elem) ((bytes) >> ECB_CTZ(elem))
+#else
+/* Indices are byte offsets, one element stays unused to tell full from empty */
+#define ECB_RANGE(total) (total)
+#define ECB_WRAP(x, total) ECB_MODULUS((x), (total))
+#define ECB_OFFSET(x, total) ((void)(total), (x))
+#define ECB_CAPACITY(total, elem) ((total) - (elem))
+#define ECB_ELEMS(bytes, elem) ((bytes) / (elem))
+#endif /* ECB_POW2 */
+
 
 void ecbuff_init(ecbuff* const restrict rb, const ECB_UINT_T total_size, const ECB_UINT_T element_size)
 {
@@ -92,6 +200,11 @@ void ecbuff_init(ecbuff* const restrict rb, const ECB_UINT_T total_size, const E
     ASSERT(ECB_MODULUS(total_size, element_size) == 0);
     ASSERT(total_size >= element_size * 2);
     ASSERT(rb);
+#if defined(ECB_POW2)
+    ASSERT(ECB_IS_POW2(total_size));
+    ASSERT(ECB_IS_POW2(element_size));
+    ASSERT(total_size <= ECB_ATOMIC_MAX / 2 + 1);
+#endif
 #if defined(ECB_ELEM_ALIGN)
     ASSERT(ECB_CHECK_ALIGN(element_size, ECB_ELEM_ALIGN));
     ASSERT(ECB_CHECK_ALIGN(&rb->elems[0], ECB_ELEM_ALIGN));
@@ -99,16 +212,132 @@ void ecbuff_init(ecbuff* const restrict rb, const ECB_UINT_T total_size, const E
 #endif
     rb->total_size = total_size;
     rb->element_size = element_size;
-    rb->rp = 0;
-    rb->wp = 0;
+    ECB_STORE_RELEASE(rb->rp, 0);
+    ECB_STORE_RELEASE(rb->wp, 0);
+#if defined(ECB_CACHE_PAD)
+    rb->rp_cache = 0;
+    rb->wp_cache = 0;
+#endif
+#if defined(ECB_MIRROR)
+    rb->mirrored = 0;
+#endif
+#if defined(ECB_TIMESTAMP)
+    rb->timestamp.stamps = NULL;
+    rb->timestamp.hist = NULL;
+    rb->timestamp.stride = 0;
+#endif
+#if defined(ECB_WAIT)
+    atomic_init(&rb->rd_parked, 0);
+    atomic_init(&rb->wr_parked, 0);
+#endif
+#if defined(ECB_STATS)
+    ECB_STAT_STORE(rb->stats_producer.writes, 0);
+    ECB_STAT_STORE(rb->stats_producer.drops, 0);
+    ECB_STAT_STORE(rb->stats_producer.overwrites, 0);
+    ECB_STAT_STORE(rb->stats_producer.full, 0);
+    ECB_STAT_STORE(rb->stats_producer.high_water, 0);
+    ECB_STAT_STORE(rb->stats_consumer.reads, 0);
+    ECB_STAT_STORE(rb->stats_consumer.empty, 0);
+#endif
+}
+
+#if defined(ECB_STATS)
+void ecbuff_stats_get(const ecbuff* const restrict rb, ecbuff_stats* const restrict stats)
+{
+    ASSERT(rb);
+    ASSERT(stats);
+    stats->writes = ECB_STAT_LOAD(rb->stats_producer.writes);
+    stats->drops = ECB_STAT_LOAD(rb->stats_producer.drops);
+    stats->overwrites = ECB_STAT_LOAD(rb->stats_producer.overwrites);
+    stats->full = ECB_STAT_LOAD(rb->stats_producer.full);
+    stats->high_water = ECB_STAT_LOAD(rb->stats_producer.high_water);
+    stats->reads = ECB_STAT_LOAD(rb->stats_consumer.reads);
+    stats->empty = ECB_STAT_LOAD(rb->stats_consumer.empty);
+}
+#endif
+
+uint32_t ecbuff_config_fingerprint(void)
+{
+    uint32_t fp = 0;
+#if defined(ECB_THREAD_SINGLE)
+    fp |= 1u << 0;
+#endif
+#if defined(ECB_THREAD_BARRIER)
+    fp |= 1u << 1;
+#endif
+#if defined(ECB_THREAD_VOLATILE)
+    fp |= 1u << 2;
+#endif
+#if defined(ECB_THREAD_ATOMIC)
+    fp |= 1u << 3;
+#endif
+#if defined(ECB_POW2)
+    fp |= 1u << 4;
+#endif
+#if defined(ECB_CACHE_PAD)
+    fp |= 1u << 5;
+#endif
+#if defined(ECB_WAIT)
+    fp |= 1u << 6;
+#endif
+#if defined(ECB_WRITE_OVERWRITE)
+    fp |= 1u << 7;
+#endif
+#if defined(ECB_MIRROR)
+    fp |= 1u << 8;
+#endif
+#if defined(ECB_STATS)
+    fp |= 1u << 9;
+#endif
+#if defined(ECB_TIMESTAMP)
+    fp |= 1u << 10;
+#endif
+    fp |= (uint32_t)(sizeof(ECB_ATOMIC_T) & 0xf) << 12;
+    fp |= (uint32_t)(sizeof(ECB_UINT_T) & 0xf) << 16;
+    /* Covers ECB_CACHELINE and padding */
+    fp |= (uint32_t)(sizeof(ecbuff) & 0xfff) << 20;
+    return fp;
+}
+
+/* Returns the number of bytes occupied by ready elements */
+static inline ECB_UINT_T ecbuff_used_private(const ECB_UINT_T total_size, const ECB_UINT_T rp, const ECB_UINT_T wp)
+{
+    return ECB_WRAP((ECB_RANGE(total_size) + wp - rp), total_size);
+}
+
+/* Returns the number of bytes that can still be written */
+static inline ECB_UINT_T ecbuff_unused_private(const ECB_UINT_T total_size, const ECB_UINT_T element_size,
+                                               const ECB_UINT_T rp, const ECB_UINT_T wp)
+{
+    return ECB_CAPACITY(total_size, element_size) - ecbuff_used_private(total_size, rp, wp);
+}
+
+/* ECB_STAT_LEVEL
+ * Tracks the high-water mark, given the indices before n elements are added.
+ */
+#if defined(ECB_STATS)
+static inline void ecbuff_stat_level(ecbuff* const restrict rb, const ECB_UINT_T total_size,
+                                     const ECB_UINT_T element_size, const ECB_UINT_T rp,
+                                     const ECB_UINT_T wp, const ECB_UINT_T n)
+{
+    ECB_UINT_T capacity = ECB_ELEMS(ECB_CAPACITY(total_size, element_size), element_size);
+    ECB_UINT_T level = ECB_ELEMS(ecbuff_used_private(total_size, rp, wp), element_size) + n;
+    if(level > capacity)
+        level = capacity;
+    ECB_STAT_MAX(rb->stats_producer.high_water, level);
 }
+#define ECB_STAT_LEVEL(rb, total_size, element_size, rp, wp, n) \
+    ecbuff_stat_level((rb), (total_size), (element_size), (rp), (wp), (n))
+#else
+#define ECB_STAT_LEVEL(rb, total_size, element_size, rp, wp, n)
+#endif /* ECB_STATS */
 
 static inline bool ecbuff_is_full_private(const ECB_UINT_T total_size, const ECB_UINT_T element_size,
                                             const ECB_UINT_T rp, const ECB_UINT_T wp)
 {
     ASSERT(total_size);
     ASSERT(element_size);
-    return ECB_MODULUS((wp + element_size), total_size) == rp;
+    return ecbuff_used_private(total_size, rp, wp) == ECB_CAPACITY(total_size, element_size);
 }
 
 bool ecbuff_is_full(const ecbuff* const restrict rb)
@@ -116,8 +345,8 @@ bool ecbuff_is_full(const ecbuff* const restrict rb)
     ASSERT(rb);
     ECB_UINT_T total_size = rb->total_size;
     ECB_UINT_T element_size = rb->element_size;
-    ECB_UINT_T rp = rb->rp;
-    ECB_UINT_T wp = rb->wp;
+    ECB_UINT_T rp = ECB_LOAD_ACQUIRE(rb->rp);
+    ECB_UINT_T wp = ECB_LOAD_ACQUIRE(rb->wp);
 
     return ecbuff_is_full_private(total_size, element_size, rp, wp);
 }
@@ -130,57 +359,264 @@ static inline bool ecbuff_is_empty_private(const ECB_UINT_T rp, const ECB_UINT_T
 bool ecbuff_is_empty(const ecbuff* const restrict rb)
 {
     ASSERT(rb);
-    ECB_UINT_T rp = rb->rp;
-    ECB_UINT_T wp = rb->wp;
+    ECB_UINT_T rp = ECB_LOAD_ACQUIRE(rb->rp);
+    ECB_UINT_T wp = ECB_LOAD_ACQUIRE(rb->wp);
     return ecbuff_is_empty_private(rp, wp);
 }
 
-#if defined(ECB_THREAD_VOLATILE)
-#define ECB_MEMCPY ecbuff_vmemcpy
+/* ecbuff_producer_rp / ecbuff_consumer_wp
+ * Load the peer's index. With ECB_CACHE_PAD a private copy on the own cache
+ * line is used instead, which is only refreshed once it makes the buffer look
+ * too full (or too empty) for n elements.
+ */
+static inline ECB_UINT_T ecbuff_producer_rp(ecbuff* const restrict rb, const ECB_UINT_T total_size,
+                                            const ECB_UINT_T element_size, const ECB_UINT_T wp, const ECB_UINT_T n)
+{
+#if defined(ECB_CACHE_PAD)
+    ECB_UINT_T rp = rb->rp_cache;
+    ECB_UINT_T unused = ecbuff_unused_private(total_size, element_size, rp, wp);
+    if(unused < element_size || (n > 1 && ECB_ELEMS(unused, element_size) < n))
+        rb->rp_cache = rp = ECB_LOAD_ACQUIRE(rb->rp);
+    return rp;
+#else
+    (void)total_size;
+    (void)element_size;
+    (void)wp;
+    (void)n;
+    return ECB_LOAD_ACQUIRE(rb->rp);
+#endif
+}
+
+static inline ECB_UINT_T ecbuff_consumer_wp(ecbuff* const restrict rb, const ECB_UINT_T total_size,
+                                            const ECB_UINT_T element_size, const ECB_UINT_T rp, const ECB_UINT_T n)
+{
+#if defined(ECB_CACHE_PAD)
+    ECB_UINT_T wp = rb->wp_cache;
+    ECB_UINT_T used = ecbuff_used_private(total_size, rp, wp);
+    if(used < element_size || (n > 1 && ECB_ELEMS(used, element_size) < n))
+        rb->wp_cache = wp = ECB_LOAD_ACQUIRE(rb->wp);
+    return wp;
+#else
+    (void)total_size;
+    (void)element_size;
+    (void)rp;
+    (void)n;
+    return ECB_LOAD_ACQUIRE(rb->wp);
+#endif
+}
+
+/* Returns the number of bytes that are contiguous from offset on */
+static inline ECB_UINT_T ecbuff_contig_private(const ecbuff* const restrict rb, const ECB_UINT_T total_size,
+                                               const ECB_UINT_T offset)
+{
+#if defined(ECB_MIRROR)
+    if(rb->mirrored)
+        return total_size;
+#else
+    (void)rb;
+#endif
+    return total_size - offset;
+}
+
+/* ECB_MEMCPY_IN / ECB_MEMCPY_OUT
+ * Copy into (out of) the element storage with the engine selected by ECB_COPY.
+ */
+#if defined(ECB_THREAD_VOLATILE) && ECB_COPY != ECB_COPY_VBYTE && ECB_COPY != ECB_COPY_VWORD && ECB_COPY != ECB_COPY_VLINE
+#error ECB_THREAD_VOLATILE requires ECB_COPY_VBYTE, ECB_COPY_VWORD or ECB_COPY_VLINE!
+#endif
+
+#if ECB_COPY == ECB_COPY_VBYTE
+#define ECB_MEMCPY_IN ecbuff_vmemcpy
+#define ECB_MEMCPY_OUT ecbuff_vmemcpy
 static inline void ecbuff_vmemcpy(volatile void* restrict dest, volatile const void* restrict src, size_t len)
 {
     while(len--)
         *(volatile char* restrict)dest++ = *(volatile const char* restrict)src++;
 }
+#elif ECB_COPY == ECB_COPY_VWORD || ECB_COPY == ECB_COPY_VLINE
+#define ECB_MEMCPY_IN ecbuff_vmemcpy
+#define ECB_MEMCPY_OUT ecbuff_vmemcpy
+#if defined(__GNUC__)
+typedef size_t __attribute__((__may_alias__)) ecbuff_word;
+#else
+typedef size_t ecbuff_word;
+#endif
+#if defined(ECB_CACHELINE)
+#define ECB_LINE_WORDS (ECB_CACHELINE / sizeof(ecbuff_word))
+#else
+#define ECB_LINE_WORDS (64 / sizeof(ecbuff_word))
+#endif
+/* Every access remains volatile and in program order, words are only used
+ * once source and destination are both aligned. */
+static inline void ecbuff_vmemcpy(volatile void* restrict dest, volatile const void* restrict src, size_t len)
+{
+    volatile char* restrict d = dest;
+    volatile const char* restrict s = src;
+    if(!(((uintptr_t)d ^ (uintptr_t)s) % sizeof(ecbuff_word)))
+    {
+        for(; len && (uintptr_t)d % sizeof(ecbuff_word); len--)
+            *d++ = *s++;
+        volatile ecbuff_word* restrict dw = (volatile ecbuff_word*)d;
+        volatile const ecbuff_word* restrict sw = (volatile const ecbuff_word*)s;
+#if ECB_COPY == ECB_COPY_VLINE
+        for(; len >= ECB_LINE_WORDS * sizeof(ecbuff_word); len -= ECB_LINE_WORDS * sizeof(ecbuff_word))
+        {
+            ecbuff_word line[ECB_LINE_WORDS];
+            for(size_t i = 0; i < ECB_LINE_WORDS; i++)
+                line[i] = sw[i];
+            for(size_t i = 0; i < ECB_LINE_WORDS; i++)
+                dw[i] = line[i];
+            dw += ECB_LINE_WORDS;
+            sw += ECB_LINE_WORDS;
+        }
+#endif
+        for(; len >= sizeof(ecbuff_word); len -= sizeof(ecbuff_word))
+            *dw++ = *sw++;
+        d = (volatile char*)dw;
+        s = (volatile const char*)sw;
+    }
+    while(len--)
+        *d++ = *s++;
+}
+#elif ECB_COPY == ECB_COPY_SIMD
+#define ECB_MEMCPY_IN ecbuff_copy
+#define ECB_MEMCPY_OUT ecbuff_copy
+#elif ECB_COPY == ECB_COPY_STREAM
+#define ECB_MEMCPY_IN ecbuff_copy_stream
+#define ECB_MEMCPY_OUT ecbuff_copy
 #else
 #include <string.h>
-#define ECB_MEMCPY memcpy
+#define ECB_MEMCPY_IN memcpy
+#define ECB_MEMCPY_OUT memcpy
+#endif
+
+/* ECB_TIMESTAMP_IN / ECB_TIMESTAMP_OUT
+ * Stamp (evaluate) the sampled slots among len bytes starting at offset,
+ * which may run past the end of elems[]. The producer stamps before
+ * publishing wp, the consumer evaluates before publishing rp, so stamps are
+ * ordered by the same release/acquire pairs as the elements themselves.
+ */
+#if defined(ECB_TIMESTAMP)
+#if !defined(ECB_TIMESTAMP_NOW)
+#if defined(ECB_TIMESTAMP_TSC)
+#include <x86intrin.h>
+#define ECB_TIMESTAMP_NOW() ((uint64_t)__rdtsc())
+#else
+#include <time.h>
+static inline uint64_t ecbuff_timestamp_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#define ECB_TIMESTAMP_NOW() ecbuff_timestamp_now()
+#endif
+#endif /* ECB_TIMESTAMP_NOW */
+
+#if defined(ECB_POW2)
+#define ECB_STAMP_ROUND(x, stride) (((x) + (stride) - 1) & ~((stride) - 1))
+#define ECB_STAMP_INDEX(x, stride) ((x) >> ECB_CTZ(stride))
+#else
+#define ECB_STAMP_ROUND(x, stride) (((x) + (stride) - 1) / (stride) * (stride))
+#define ECB_STAMP_INDEX(x, stride) ((x) / (stride))
 #endif
 
+void ecbuff_timestamp_init(ecbuff* const restrict rb, uint64_t* const restrict stamps, ehist* const restrict hist)
+{
+    ASSERT(rb);
+    ASSERT(!stamps || hist);
+    rb->timestamp.stride = (ECB_UINT_T)(ECB_TIMESTAMP_EVERY * rb->element_size);
+    rb->timestamp.hist = hist;
+    rb->timestamp.stamps = stamps;
+}
+
+static inline void ecbuff_timestamp_range(ecbuff* const restrict rb, const ECB_UINT_T total_size,
+                                          ECB_UINT_T offset, ECB_UINT_T len, const bool in)
+{
+    ECB_VOLATILE_T uint64_t* stamps = rb->timestamp.stamps;
+    ECB_UINT_T stride = rb->timestamp.stride;
+    uint64_t now = 0;
+    bool have_now = false;
+    while(len)
+    {
+        ECB_UINT_T end = (offset + len > total_size) ? total_size : offset + len;
+        len -= end - offset;
+        for(offset = ECB_STAMP_ROUND(offset, stride); offset < end; offset += stride)
+        {
+            /* Most ranges hold no sampled slot, the clock is only read for
+             * those that do, once per call */
+            if(!have_now)
+            {
+                now = ECB_TIMESTAMP_NOW();
+                have_now = true;
+            }
+            ECB_UINT_T i = ECB_STAMP_INDEX(offset, stride);
+            if(in)
+            {
+                stamps[i] = now;
+                continue;
+            }
+            uint64_t stamp = stamps[i];
+            ehist_record(rb->timestamp.hist, now > stamp ? now - stamp : 0);
+        }
+        offset = 0;
+    }
+}
+#define ECB_TIMESTAMP_IN(rb, total_size, offset, len) \
+    do { if((rb)->timestamp.stamps) ecbuff_timestamp_range((rb), (total_size), (offset), (len), true); } while(0)
+#define ECB_TIMESTAMP_OUT(rb, total_size, offset, len) \
+    do { if((rb)->timestamp.stamps) ecbuff_timestamp_range((rb), (total_size), (offset), (len), false); } while(0)
+#else
+#define ECB_TIMESTAMP_IN(rb, total_size, offset, len)
+#define ECB_TIMESTAMP_OUT(rb, total_size, offset, len)
+#endif /* ECB_TIMESTAMP */
+
 ECB_VOID_BOOL_T ecbuff_write(ecbuff* const restrict rb, const void* const restrict element)
 {
     ASSERT(rb);
     ASSERT(element);
     ECB_UINT_T total_size = rb->total_size;
     ECB_UINT_T element_size = rb->element_size;
-    ECB_UINT_T wp = rb->wp;
-#if defined(ECB_WRITE_DROP) || defined(ECB_WRITE_OVERWRITE) || defined(ECB_ASSERT)
-    ECB_UINT_T rp = rb->rp;
+    ECB_UINT_T wp = ECB_LOAD_RELAXED(rb->wp);
+#if defined(ECB_WRITE_DROP) || defined(ECB_WRITE_OVERWRITE) || defined(ECB_ASSERT) || defined(ECB_STATS)
+    ECB_UINT_T rp = ecbuff_producer_rp(rb, total_size, element_size, wp, 1);
 #endif
 
 #if defined(ECB_WRITE_DROP)
     if(ecbuff_is_full_private(total_size, element_size, rp, wp))
+    {
+        ECB_STAT_ADD(rb->stats_producer.full, 1);
+        ECB_STAT_ADD(rb->stats_producer.drops, 1);
 #if defined(ECB_EXTRA_CHECKS)
         return false;
 #else
         return;
 #endif
+    }
 #endif
 
 #if !defined(ECB_WRITE_OVERWRITE)
     ASSERT(!ecbuff_is_full_private(total_size, element_size, rp, wp));
+#else
+    bool evict = ecbuff_is_full_private(total_size, element_size, rp, wp);
 #endif /* ECB_WRITE_OVERWRITE */
     FENCE_ACQUIRE();
-    ECB_MEMCPY(&rb->elems[wp], element, element_size);
+    ECB_MEMCPY_IN(&rb->elems[ECB_OFFSET(wp, total_size)], element, element_size);
+    ECB_TIMESTAMP_IN(rb, total_size, ECB_OFFSET(wp, total_size), element_size);
     FENCE_RELEASE();
-    wp = ECB_MODULUS((wp + element_size), total_size);
-    rb->wp = wp;
+    ECB_STAT_ADD(rb->stats_producer.writes, 1);
+    ECB_STAT_LEVEL(rb, total_size, element_size, rp, wp, 1);
+    wp = ECB_WRAP((wp + element_size), total_size);
+    ECB_STORE_RELEASE(rb->wp, wp);
+    ECB_NOTIFY_CONSUMER(rb);
 
 #if defined(ECB_WRITE_OVERWRITE)
-    if(ecbuff_is_empty_private(rp, wp))
-    {   /* Apparently we have just overwritten an element.
+    if(evict)
+    {   /* We have just overwritten an element.
          * Move rp to drop the oldest element. */
-        rb->rp = ECB_MODULUS((rp + element_size), total_size);
+        ECB_STORE_RELEASE(rb->rp, ECB_WRAP((rp + element_size), total_size));
+        ECB_STAT_ADD(rb->stats_producer.full, 1);
+        ECB_STAT_ADD(rb->stats_producer.overwrites, 1);
 #if defined(ECB_EXTRA_CHECKS)
         return false;
 #endif /* ECB_EXTRA_CHECKS */
@@ -195,22 +631,28 @@ ECB_VOID_BOOL_T ecbuff_read(ecbuff* const restrict rb, void* const restrict elem
 {
     ASSERT(rb);
     ASSERT(element);
-    ECB_UINT_T rp = rb->rp;
+    ECB_UINT_T total_size = rb->total_size;
+    ECB_UINT_T element_size = rb->element_size;
+    ECB_UINT_T rp = ECB_LOAD_RELAXED(rb->rp);
 #if defined(ECB_ASSERT) || defined(ECB_EXTRA_CHECKS)
-    ECB_UINT_T wp = rb->wp;
+    ECB_UINT_T wp = ecbuff_consumer_wp(rb, total_size, element_size, rp, 1);
 #if defined(ECB_ASSERT) && !defined(ECB_EXTRA_CHECKS)
     ASSERT(!ecbuff_is_empty_private(rp, wp));
 #elif defined(ECB_EXTRA_CHECKS)
     if(ecbuff_is_empty_private(rp, wp))
+    {
+        ECB_STAT_ADD(rb->stats_consumer.empty, 1);
         return false;
+    }
 #endif
 #endif
-    ECB_UINT_T total_size = rb->total_size;
-    ECB_UINT_T element_size = rb->element_size;
     FENCE_ACQUIRE();
-    ECB_MEMCPY(element, &rb->elems[rp], element_size);
+    ECB_MEMCPY_OUT(element, &rb->elems[ECB_OFFSET(rp, total_size)], element_size);
+    ECB_TIMESTAMP_OUT(rb, total_size, ECB_OFFSET(rp, total_size), element_size);
     FENCE_RELEASE();
-    rb->rp = ECB_MODULUS((rp + element_size), total_size);
+    ECB_STAT_ADD(rb->stats_consumer.reads, 1);
+    ECB_STORE_RELEASE(rb->rp, ECB_WRAP((rp + element_size), total_size));
+    ECB_NOTIFY_PRODUCER(rb);
 #if defined(ECB_EXTRA_CHECKS)
     return true;
 #endif
@@ -221,10 +663,10 @@ ECB_UINT_T ecbuff_used(const ecbuff* const restrict rb)
     ASSERT(rb);
     ECB_UINT_T total_size = rb->total_size;
     ECB_UINT_T element_size = rb->element_size;
-    ECB_UINT_T rp = rb->rp;
-    ECB_UINT_T wp = rb->wp;
+    ECB_UINT_T rp = ECB_LOAD_ACQUIRE(rb->rp);
+    ECB_UINT_T wp = ECB_LOAD_ACQUIRE(rb->wp);
 
-    return ECB_MODULUS((total_size + wp - rp), total_size) / element_size;
+    return ECB_ELEMS(ecbuff_used_private(total_size, rp, wp), element_size);
 }
 
 ECB_UINT_T ecbuff_unused(const ecbuff* const restrict rb)
@@ -232,25 +674,144 @@ ECB_UINT_T ecbuff_unused(const ecbuff* const restrict rb)
     ASSERT(rb);
     ECB_UINT_T total_size = rb->total_size;
     ECB_UINT_T element_size = rb->element_size;
-    ECB_UINT_T rp = rb->rp;
-    ECB_UINT_T wp = rb->wp;
+    ECB_UINT_T rp = ECB_LOAD_ACQUIRE(rb->rp);
+    ECB_UINT_T wp = ECB_LOAD_ACQUIRE(rb->wp);
+
+    return ECB_ELEMS(ecbuff_unused_private(total_size, element_size, rp, wp), element_size);
+}
+
+ECB_UINT_T ecbuff_write_n(ecbuff* const restrict rb, const void* const restrict elements, ECB_UINT_T n)
+{
+    ASSERT(rb);
+    ASSERT(elements || !n);
+    ECB_UINT_T total_size = rb->total_size;
+    ECB_UINT_T element_size = rb->element_size;
+    ECB_UINT_T wp = ECB_LOAD_RELAXED(rb->wp);
+    ECB_UINT_T rp = ecbuff_producer_rp(rb, total_size, element_size, wp, n);
+    const char* src = elements;
+    ECB_UINT_T avail = ECB_ELEMS(ecbuff_unused_private(total_size, element_size, rp, wp), element_size);
+    ECB_UINT_T count = n;
+
+#if defined(ECB_WRITE_OVERWRITE)
+    ECB_UINT_T capacity = ECB_ELEMS(ECB_CAPACITY(total_size, element_size), element_size);
+    if(count > capacity)
+    {   /* Leading elements would be overwritten by the tail of
+         * this very call, skip them right away. */
+        src += (count - capacity) * element_size;
+        count = capacity;
+    }
+#elif defined(ECB_WRITE_DROP)
+    if(count > avail)
+        count = avail;
+#else
+    ASSERT(count <= avail);
+#endif
+#if defined(ECB_STATS)
+    if(n > avail)
+    {
+        ECB_STAT_ADD(rb->stats_producer.full, 1);
+#if defined(ECB_WRITE_OVERWRITE)
+        ECB_STAT_ADD(rb->stats_producer.overwrites, n - avail);
+#else
+        ECB_STAT_ADD(rb->stats_producer.drops, n - count);
+#endif
+    }
+#if defined(ECB_WRITE_OVERWRITE)
+    ECB_STAT_ADD(rb->stats_producer.writes, n);
+#else
+    ECB_STAT_ADD(rb->stats_producer.writes, count);
+#endif
+    ECB_STAT_LEVEL(rb, total_size, element_size, rp, wp, count);
+#endif /* ECB_STATS */
+    if(!count)
+        return 0;
+
+    ECB_UINT_T len = count * element_size;
+    ECB_UINT_T offset = ECB_OFFSET(wp, total_size);
+    ECB_UINT_T first = ecbuff_contig_private(rb, total_size, offset);
+    if(first > len)
+        first = len;
+
+    FENCE_ACQUIRE();
+    ECB_MEMCPY_IN(&rb->elems[offset], src, first);
+    if(len > first)
+        ECB_MEMCPY_IN(&rb->elems[0], src + first, len - first);
+    ECB_TIMESTAMP_IN(rb, total_size, offset, len);
+    FENCE_RELEASE();
+    wp = ECB_WRAP((wp + len), total_size);
+    ECB_STORE_RELEASE(rb->wp, wp);
+    ECB_NOTIFY_CONSUMER(rb);
+
+#if defined(ECB_WRITE_OVERWRITE)
+    if(count > avail)
+    {   /* Oldest elements have been overwritten,
+         * move rp to the oldest remaining one. */
+        ECB_STORE_RELEASE(rb->rp, ECB_WRAP((wp + ECB_RANGE(total_size) - ECB_CAPACITY(total_size, element_size)), total_size));
+    }
+    return n;
+#else
+    (void)avail;
+    return count;
+#endif
+}
+
+ECB_UINT_T ecbuff_read_n(ecbuff* const restrict rb, void* const restrict elements, ECB_UINT_T n)
+{
+    ASSERT(rb);
+    ASSERT(elements || !n);
+    ECB_UINT_T total_size = rb->total_size;
+    ECB_UINT_T element_size = rb->element_size;
+    ECB_UINT_T rp = ECB_LOAD_RELAXED(rb->rp);
+    ECB_UINT_T wp = ecbuff_consumer_wp(rb, total_size, element_size, rp, n);
+    char* dst = elements;
+    ECB_UINT_T avail = ECB_ELEMS(ecbuff_used_private(total_size, rp, wp), element_size);
+    ECB_UINT_T count = n;
+
+#if defined(ECB_EXTRA_CHECKS)
+    if(count > avail)
+        count = avail;
+#else
+    ASSERT(count <= avail);
+#endif
+#if defined(ECB_STATS)
+    if(n && !avail)
+        ECB_STAT_ADD(rb->stats_consumer.empty, 1);
+    ECB_STAT_ADD(rb->stats_consumer.reads, count);
+#endif
+    (void)avail;
+    if(!count)
+        return 0;
 
-    return ECB_MODULUS((total_size - element_size + rp - wp), total_size) / element_size;
+    ECB_UINT_T len = count * element_size;
+    ECB_UINT_T offset = ECB_OFFSET(rp, total_size);
+    ECB_UINT_T first = ecbuff_contig_private(rb, total_size, offset);
+    if(first > len)
+        first = len;
+
+    FENCE_ACQUIRE();
+    ECB_MEMCPY_OUT(dst, &rb->elems[offset], first);
+    if(len > first)
+        ECB_MEMCPY_OUT(dst + first, &rb->elems[0], len - first);
+    ECB_TIMESTAMP_OUT(rb, total_size, offset, len);
+    FENCE_RELEASE();
+    ECB_STORE_RELEASE(rb->rp, ECB_WRAP((rp + len), total_size));
+    ECB_NOTIFY_PRODUCER(rb);
+    return count;
 }
 
 #ifdef ECB_DIRECT_ACCESS
 ECB_VOLATILE_T void* ecbuff_write_alloc(ecbuff* const restrict rb)
 {
     ASSERT(rb);
-    ECB_UINT_T wp = rb->wp;
-#if defined(ECB_ASSERT) && !defined(ECB_WRITE_OVERWRITE) && !defined(ECB_WRITE_DROP)
     ECB_UINT_T total_size = rb->total_size;
+    ECB_UINT_T wp = ECB_LOAD_RELAXED(rb->wp);
+#if defined(ECB_ASSERT) && !defined(ECB_WRITE_OVERWRITE) && !defined(ECB_WRITE_DROP)
     ECB_UINT_T element_size = rb->element_size;
-    ECB_UINT_T rp = rb->rp;
+    ECB_UINT_T rp = ecbuff_producer_rp(rb, total_size, element_size, wp, 1);
     ASSERT(!ecbuff_is_full_private(total_size, element_size, rp, wp));
 #endif
     FENCE_ACQUIRE();
-    return &rb->elems[wp];
+    return &rb->elems[ECB_OFFSET(wp, total_size)];
 }
 
 ECB_VOID_BOOL_T ecbuff_write_enqueue(ecbuff* const restrict rb)
@@ -259,25 +820,40 @@ ECB_VOID_BOOL_T ecbuff_write_enqueue(ecbuff* const restrict rb)
     FENCE_RELEASE();
     ECB_UINT_T total_size = rb->total_size;
     ECB_UINT_T element_size = rb->element_size;
-    ECB_UINT_T wp = rb->wp;
-#if defined(ECB_WRITE_DROP) || defined(ECB_WRITE_OVERWRITE)
-    ECB_UINT_T rp = rb->rp;
+    ECB_UINT_T wp = ECB_LOAD_RELAXED(rb->wp);
+#if defined(ECB_WRITE_DROP) || defined(ECB_WRITE_OVERWRITE) || defined(ECB_STATS)
+    ECB_UINT_T rp = ecbuff_producer_rp(rb, total_size, element_size, wp, 1);
 #endif
 #if defined(ECB_WRITE_DROP)
     if(ecbuff_is_full_private(total_size, element_size, rp, wp))
+    {
+        ECB_STAT_ADD(rb->stats_producer.full, 1);
+        ECB_STAT_ADD(rb->stats_producer.drops, 1);
 #if defined(ECB_EXTRA_CHECKS)
         return false;
 #else
         return;
 #endif
+    }
+#elif defined(ECB_WRITE_OVERWRITE)
+    bool evict = ecbuff_is_full_private(total_size, element_size, rp, wp);
+#endif
+#if defined(ECB_TIMESTAMP)
+    ECB_TIMESTAMP_IN(rb, total_size, ECB_OFFSET(wp, total_size), element_size);
+    FENCE_RELEASE();
 #endif
-    wp = ECB_MODULUS((wp + element_size), total_size);
-    rb->wp = wp;
+    ECB_STAT_ADD(rb->stats_producer.writes, 1);
+    ECB_STAT_LEVEL(rb, total_size, element_size, rp, wp, 1);
+    wp = ECB_WRAP((wp + element_size), total_size);
+    ECB_STORE_RELEASE(rb->wp, wp);
+    ECB_NOTIFY_CONSUMER(rb);
 #if defined(ECB_WRITE_OVERWRITE)
-    if(ecbuff_is_empty_private(rp, wp))
-    {   /* Apparently we have just overwritten an element.
+    if(evict)
+    {   /* We have just overwritten an element.
          * Move rp to drop the oldest element. */
-        rb->rp = ECB_MODULUS((rp + element_size), total_size);
+        ECB_STORE_RELEASE(rb->rp, ECB_WRAP((rp + element_size), total_size));
+        ECB_STAT_ADD(rb->stats_producer.full, 1);
+        ECB_STAT_ADD(rb->stats_producer.overwrites, 1);
 #if defined(ECB_EXTRA_CHECKS)
         return false;
 #endif /* ECB_EXTRA_CHECKS */
@@ -291,27 +867,34 @@ ECB_VOID_BOOL_T ecbuff_write_enqueue(ecbuff* const restrict rb)
 ECB_VOLATILE_T void* ecbuff_read_dequeue(ecbuff* const restrict rb)
 {
     ASSERT(rb);
-    ECB_UINT_T rp = rb->rp;
+    ECB_UINT_T total_size = rb->total_size;
+    ECB_UINT_T rp = ECB_LOAD_RELAXED(rb->rp);
 #if defined(ECB_ASSERT) || defined(ECB_EXTRA_CHECKS)
-    ECB_UINT_T wp = rb->wp;
+    ECB_UINT_T element_size = rb->element_size;
+    ECB_UINT_T wp = ecbuff_consumer_wp(rb, total_size, element_size, rp, 1);
 #if defined(ECB_ASSERT) && !defined(ECB_EXTRA_CHECKS)
     ASSERT(!ecbuff_is_empty_private(rp, wp));
 #elif defined(ECB_EXTRA_CHECKS)
     if(ecbuff_is_empty_private(rp, wp))
+    {
+        ECB_STAT_ADD(rb->stats_consumer.empty, 1);
         return NULL;
+    }
 #endif
 #endif
     FENCE_ACQUIRE();
-    return &rb->elems[rp];
+    return &rb->elems[ECB_OFFSET(rp, total_size)];
 }
 
 ECB_VOID_BOOL_T ecbuff_read_free(ecbuff* const restrict rb)
 {
     ASSERT(rb);
     FENCE_RELEASE();
-    ECB_UINT_T rp = rb->rp;
+    ECB_UINT_T total_size = rb->total_size;
+    ECB_UINT_T element_size = rb->element_size;
+    ECB_UINT_T rp = ECB_LOAD_RELAXED(rb->rp);
 #if defined(ECB_ASSERT) || defined(ECB_EXTRA_CHECKS)
-    ECB_UINT_T wp = rb->wp;
+    ECB_UINT_T wp = ecbuff_consumer_wp(rb, total_size, element_size, rp, 1);
 #if defined(ECB_ASSERT) && !defined(ECB_EXTRA_CHECKS)
     ASSERT(!ecbuff_is_empty_private(rp, wp));
 #elif defined(ECB_EXTRA_CHECKS)
@@ -319,12 +902,197 @@ ECB_VOID_BOOL_T ecbuff_read_free(ecbuff* const restrict rb)
         return false;
 #endif
 #endif
+#if defined(ECB_TIMESTAMP)
+    ECB_TIMESTAMP_OUT(rb, total_size, ECB_OFFSET(rp, total_size), element_size);
+    FENCE_RELEASE();
+#endif
+
+    ECB_STAT_ADD(rb->stats_consumer.reads, 1);
+    ECB_STORE_RELEASE(rb->rp, ECB_WRAP((rp + element_size), total_size));
+    ECB_NOTIFY_PRODUCER(rb);
+#if defined(ECB_EXTRA_CHECKS)
+    return true;
+#endif
+}
+
+ECB_VOLATILE_T void* ecbuff_write_alloc_span(ecbuff* const restrict rb, ECB_UINT_T* const restrict count)
+{
+    ASSERT(rb);
+    ASSERT(count);
+    ECB_UINT_T total_size = rb->total_size;
+    ECB_UINT_T element_size = rb->element_size;
+    ECB_UINT_T wp = ECB_LOAD_RELAXED(rb->wp);
+    ECB_UINT_T offset = ECB_OFFSET(wp, total_size);
+#if defined(ECB_WRITE_OVERWRITE)
+    /* Everything up to the wrap point may be overwritten */
+    ECB_UINT_T len = ECB_CAPACITY(total_size, element_size);
+#else
+    ECB_UINT_T rp = ecbuff_producer_rp(rb, total_size, element_size, wp, 1);
+    ECB_UINT_T len = ecbuff_unused_private(total_size, element_size, rp, wp);
+#endif
+    if(len > ecbuff_contig_private(rb, total_size, offset))
+        len = ecbuff_contig_private(rb, total_size, offset);
+    *count = ECB_ELEMS(len, element_size);
+    if(!*count)
+    {
+        ECB_STAT_ADD(rb->stats_producer.full, 1);
+        return NULL;
+    }
+    FENCE_ACQUIRE();
+    return &rb->elems[offset];
+}
+
+ECB_VOID_BOOL_T ecbuff_write_enqueue_n(ecbuff* const restrict rb, ECB_UINT_T n)
+{
+    ASSERT(rb);
+    FENCE_RELEASE();
+    ECB_UINT_T total_size = rb->total_size;
+    ECB_UINT_T element_size = rb->element_size;
+    ECB_UINT_T wp = ECB_LOAD_RELAXED(rb->wp);
+    ECB_UINT_T rp = ecbuff_producer_rp(rb, total_size, element_size, wp, n);
+    ECB_UINT_T avail = ECB_ELEMS(ecbuff_unused_private(total_size, element_size, rp, wp), element_size);
+#if defined(ECB_WRITE_DROP)
+    bool dropped = n > avail;
+    if(dropped)
+    {
+        ECB_STAT_ADD(rb->stats_producer.full, 1);
+        ECB_STAT_ADD(rb->stats_producer.drops, n - avail);
+        n = avail;
+    }
+#elif defined(ECB_WRITE_OVERWRITE)
+    ASSERT(n <= ECB_ELEMS(ECB_CAPACITY(total_size, element_size), element_size));
+#else
+    ASSERT(n <= avail);
+#endif
+#if defined(ECB_TIMESTAMP)
+    ECB_TIMESTAMP_IN(rb, total_size, ECB_OFFSET(wp, total_size), n * element_size);
+    FENCE_RELEASE();
+#endif
+    ECB_STAT_ADD(rb->stats_producer.writes, n);
+    ECB_STAT_LEVEL(rb, total_size, element_size, rp, wp, n);
+    wp = ECB_WRAP((wp + n * element_size), total_size);
+    ECB_STORE_RELEASE(rb->wp, wp);
+    ECB_NOTIFY_CONSUMER(rb);
+#if defined(ECB_WRITE_OVERWRITE)
+    if(n > avail)
+    {   /* Oldest elements have been overwritten,
+         * move rp to the oldest remaining one. */
+        ECB_STORE_RELEASE(rb->rp, ECB_WRAP((wp + ECB_RANGE(total_size) - ECB_CAPACITY(total_size, element_size)), total_size));
+        ECB_STAT_ADD(rb->stats_producer.full, 1);
+        ECB_STAT_ADD(rb->stats_producer.overwrites, n - avail);
+#if defined(ECB_EXTRA_CHECKS)
+        return false;
+#endif /* ECB_EXTRA_CHECKS */
+    }
+#elif defined(ECB_WRITE_DROP) && defined(ECB_EXTRA_CHECKS)
+    if(dropped)
+        return false;
+#else
+    (void)avail;
+#endif
+#if defined(ECB_EXTRA_CHECKS)
+    return true;
+#endif
+}
+
+ECB_VOLATILE_T void* ecbuff_read_dequeue_span(ecbuff* const restrict rb, ECB_UINT_T* const restrict count)
+{
+    ASSERT(rb);
+    ASSERT(count);
+    ECB_UINT_T total_size = rb->total_size;
+    ECB_UINT_T element_size = rb->element_size;
+    ECB_UINT_T rp = ECB_LOAD_RELAXED(rb->rp);
+    ECB_UINT_T wp = ecbuff_consumer_wp(rb, total_size, element_size, rp, 1);
+    ECB_UINT_T offset = ECB_OFFSET(rp, total_size);
+    ECB_UINT_T len = ecbuff_used_private(total_size, rp, wp);
+    if(len > ecbuff_contig_private(rb, total_size, offset))
+        len = ecbuff_contig_private(rb, total_size, offset);
+    *count = ECB_ELEMS(len, element_size);
+    if(!*count)
+    {
+        ECB_STAT_ADD(rb->stats_consumer.empty, 1);
+        return NULL;
+    }
+    FENCE_ACQUIRE();
+    return &rb->elems[offset];
+}
+
+ECB_VOID_BOOL_T ecbuff_read_free_n(ecbuff* const restrict rb, ECB_UINT_T n)
+{
+    ASSERT(rb);
+    FENCE_RELEASE();
     ECB_UINT_T total_size = rb->total_size;
     ECB_UINT_T element_size = rb->element_size;
+    ECB_UINT_T rp = ECB_LOAD_RELAXED(rb->rp);
+#if defined(ECB_ASSERT) || defined(ECB_EXTRA_CHECKS)
+    ECB_UINT_T wp = ecbuff_consumer_wp(rb, total_size, element_size, rp, n);
+#if defined(ECB_ASSERT) && !defined(ECB_EXTRA_CHECKS)
+    ASSERT(n <= ECB_ELEMS(ecbuff_used_private(total_size, rp, wp), element_size));
+#elif defined(ECB_EXTRA_CHECKS)
+    if(n > ECB_ELEMS(ecbuff_used_private(total_size, rp, wp), element_size))
+        return false;
+#endif
+#endif
+#if defined(ECB_TIMESTAMP)
+    ECB_TIMESTAMP_OUT(rb, total_size, ECB_OFFSET(rp, total_size), n * element_size);
+    FENCE_RELEASE();
+#endif
 
-    rb->rp = ECB_MODULUS((rp + element_size), total_size);
+    ECB_STAT_ADD(rb->stats_consumer.reads, n);
+    ECB_STORE_RELEASE(rb->rp, ECB_WRAP((rp + n * element_size), total_size));
+    ECB_NOTIFY_PRODUCER(rb);
 #if defined(ECB_EXTRA_CHECKS)
     return true;
 #endif
 }
+
+ECB_VOLATILE_T void* ecbuff_peek(ecbuff* const restrict rb, const ECB_UINT_T i)
+{
+    ASSERT(rb);
+    ECB_UINT_T total_size = rb->total_size;
+    ECB_UINT_T element_size = rb->element_size;
+    ECB_UINT_T rp = ECB_LOAD_RELAXED(rb->rp);
+    ECB_UINT_T wp = ecbuff_consumer_wp(rb, total_size, element_size, rp, i + 1);
+    if(i >= ECB_ELEMS(ecbuff_used_private(total_size, rp, wp), element_size))
+        return NULL;
+    /* i * element_size is below total_size, a subtraction replaces ECB_WRAP */
+    ECB_UINT_T offset = ECB_OFFSET(rp, total_size) + i * element_size;
+    if(offset >= total_size)
+        offset -= total_size;
+    FENCE_ACQUIRE();
+    return &rb->elems[offset];
+}
+
+ECB_UINT_T ecbuff_iter_init(ecbuff_iter* const restrict it, ecbuff* const restrict rb)
+{
+    ASSERT(it);
+    ASSERT(rb);
+    ECB_UINT_T total_size = rb->total_size;
+    ECB_UINT_T element_size = rb->element_size;
+    ECB_UINT_T rp = ECB_LOAD_RELAXED(rb->rp);
+    ECB_UINT_T wp = ECB_LOAD_ACQUIRE(rb->wp);
+#if defined(ECB_CACHE_PAD)
+    rb->wp_cache = wp;
+#endif
+    it->rb = rb;
+    it->offset = ECB_OFFSET(rp, total_size);
+    it->left = ECB_ELEMS(ecbuff_used_private(total_size, rp, wp), element_size);
+    FENCE_ACQUIRE();
+    return it->left;
+}
+
+ECB_VOLATILE_T void* ecbuff_iter_next(ecbuff_iter* const restrict it)
+{
+    ASSERT(it);
+    if(!it->left)
+        return NULL;
+    ECB_UINT_T total_size = it->rb->total_size;
+    ECB_UINT_T element_size = it->rb->element_size;
+    ECB_VOLATILE_T void* element = &it->rb->elems[it->offset];
+    it->offset += element_size;
+    if(it->offset == total_size)
+        it->offset = 0;
+    it->left--;
+    return element;
+}
 #endif
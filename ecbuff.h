@@ -29,24 +29,167 @@
 #define ECB_VOLATILE_T
 #endif
 
+/* Copy engines for ECB_COPY, see ecbuff_cfg.h */
+#define ECB_COPY_MEMCPY 1
+#define ECB_COPY_VBYTE 2
+#define ECB_COPY_VWORD 3
+#define ECB_COPY_VLINE 4
+#define ECB_COPY_SIMD 5
+#define ECB_COPY_STREAM 6
+#if !defined(ECB_COPY)
+#if defined(ECB_THREAD_VOLATILE)
+#define ECB_COPY ECB_COPY_VWORD
+#else
+#define ECB_COPY ECB_COPY_MEMCPY
+#endif
+#endif
+
+#if defined(ECB_THREAD_ATOMIC)
+#include <stdatomic.h>
+#define ECB_INDEX_T _Atomic ECB_ATOMIC_T
+#else
+#define ECB_INDEX_T ECB_VOLATILE_T ECB_ATOMIC_T
+#endif
+
+#if defined(ECB_WAIT)
+#include <stdint.h>
+/* Set by a side before it parks, futex word on Linux */
+#define ECB_PARKED_T _Atomic uint32_t
+#define ECB_WAIT_FOREVER UINT32_MAX
+#endif
+
+#if defined(ECB_STATS)
+/* Counters are only ever written by the side owning them */
+#if defined(ECB_THREAD_ATOMIC)
+#define ECB_STAT_T _Atomic ECB_UINT_T
+#elif defined(ECB_THREAD_MULTI)
+#define ECB_STAT_T volatile ECB_UINT_T
+#else
+#define ECB_STAT_T ECB_UINT_T
+#endif
+typedef struct {
+    ECB_STAT_T writes;                          /* elements written */
+    ECB_STAT_T drops;                           /* elements dropped, ECB_WRITE_DROP */
+    ECB_STAT_T overwrites;                      /* elements evicted, ECB_WRITE_OVERWRITE */
+    ECB_STAT_T full;                            /* writes finding the buffer full */
+    ECB_STAT_T high_water;                      /* highest number of used elements */
+} ecbuff_stats_producer;
+typedef struct {
+    ECB_STAT_T reads;                           /* elements read */
+    ECB_STAT_T empty;                           /* reads finding the buffer empty */
+} ecbuff_stats_consumer;
+#define ECB_STATS_PRODUCER_SIZE sizeof(ecbuff_stats_producer)
+#define ECB_STATS_CONSUMER_SIZE sizeof(ecbuff_stats_consumer)
+#else
+#define ECB_STATS_PRODUCER_SIZE 0
+#define ECB_STATS_CONSUMER_SIZE 0
+#endif
+
+#if defined(ECB_TIMESTAMP)
+#include "ehist.h"
+#if !defined(ECB_TIMESTAMP_EVERY)
+#define ECB_TIMESTAMP_EVERY 64
+#endif
+/* Number of stamps to allocate for a buffer */
+#define ECB_TIMESTAMP_SLOTS(total_size, element_size) ((total_size) / (element_size) / ECB_TIMESTAMP_EVERY + 1)
+typedef struct {
+    ECB_VOLATILE_T uint64_t* stamps;            /* written by the producer, NULL while disabled */
+    ehist* hist;                                /* updated by the consumer */
+    ECB_UINT_T stride;                          /* bytes between stamped slots */
+} ecbuff_timestamp;
+#define ECB_TIMESTAMP_SIZE sizeof(ecbuff_timestamp)
+#else
+#define ECB_TIMESTAMP_SIZE 0
+#endif
+
 #if defined(ECB_EXTRA_CHECKS)
 #define ECB_VOID_BOOL_T bool
 #else
 #define ECB_VOID_BOOL_T void
 #endif
 
+#if defined(ECB_CACHE_PAD)
+#if !defined(ECB_CACHELINE)
+#define ECB_CACHELINE 64
+#endif
+/* Producer and consumer each own a cache line, the read-only
+ * configuration lives on a third one. */
 typedef struct {
     ECB_VOLATILE_T ECB_ATOMIC_T total_size;
     ECB_VOLATILE_T ECB_ATOMIC_T element_size;
-    ECB_VOLATILE_T ECB_ATOMIC_T wp;             /* write pointer */
-    ECB_VOLATILE_T ECB_ATOMIC_T rp;             /* read pointer */
+#if defined(ECB_TIMESTAMP)
+    ecbuff_timestamp timestamp;
+#endif
+#if defined(ECB_MIRROR)
+    ECB_VOLATILE_T ECB_ATOMIC_T mirrored;       /* elems[] is followed by a second mapping of itself */
+    char pad_config[ECB_CACHELINE - 3 * sizeof(ECB_ATOMIC_T) - ECB_TIMESTAMP_SIZE];
+#else
+    char pad_config[ECB_CACHELINE - 2 * sizeof(ECB_ATOMIC_T) - ECB_TIMESTAMP_SIZE];
+#endif
+    ECB_INDEX_T wp;                             /* write pointer */
+    ECB_UINT_T rp_cache;                        /* producer's copy of rp */
+#if defined(ECB_STATS)
+    ecbuff_stats_producer stats_producer;
+#endif
+#if defined(ECB_WAIT)
+    ECB_PARKED_T rd_parked;                     /* consumer is parked, checked by the producer */
+    char pad_producer[ECB_CACHELINE - sizeof(ECB_ATOMIC_T) - sizeof(ECB_UINT_T) - ECB_STATS_PRODUCER_SIZE - sizeof(uint32_t)];
+#else
+    char pad_producer[ECB_CACHELINE - sizeof(ECB_ATOMIC_T) - sizeof(ECB_UINT_T) - ECB_STATS_PRODUCER_SIZE];
+#endif
+    ECB_INDEX_T rp;                             /* read pointer */
+    ECB_UINT_T wp_cache;                        /* consumer's copy of wp */
+#if defined(ECB_STATS)
+    ecbuff_stats_consumer stats_consumer;
+#endif
+#if defined(ECB_WAIT)
+    ECB_PARKED_T wr_parked;                     /* producer is parked, checked by the consumer */
+    char pad_consumer[ECB_CACHELINE - sizeof(ECB_ATOMIC_T) - sizeof(ECB_UINT_T) - ECB_STATS_CONSUMER_SIZE - sizeof(uint32_t)];
+#else
+    char pad_consumer[ECB_CACHELINE - sizeof(ECB_ATOMIC_T) - sizeof(ECB_UINT_T) - ECB_STATS_CONSUMER_SIZE];
+#endif
     ECB_VOLATILE_T char elems[];                /* flexible array member can be used to allocate buffer as part of this struct */
 } ecbuff;
+#else
+typedef struct {
+    ECB_VOLATILE_T ECB_ATOMIC_T total_size;
+    ECB_VOLATILE_T ECB_ATOMIC_T element_size;
+#if defined(ECB_MIRROR)
+    ECB_VOLATILE_T ECB_ATOMIC_T mirrored;       /* elems[] is followed by a second mapping of itself */
+#endif
+#if defined(ECB_TIMESTAMP)
+    ecbuff_timestamp timestamp;
+#endif
+    ECB_INDEX_T wp;                             /* write pointer */
+    ECB_INDEX_T rp;                             /* read pointer */
+#if defined(ECB_STATS)
+    ecbuff_stats_producer stats_producer;
+    ecbuff_stats_consumer stats_consumer;
+#endif
+#if defined(ECB_WAIT)
+    ECB_PARKED_T rd_parked;                     /* consumer is parked */
+    ECB_PARKED_T wr_parked;                     /* producer is parked */
+#endif
+    ECB_VOLATILE_T char elems[];                /* flexible array member can be used to allocate buffer as part of this struct */
+} ecbuff;
+#endif /* ECB_CACHE_PAD */
 
 /* ecbuff_init
  * total_size has to be an integer multiple of element_size
  */
 void ecbuff_init(ecbuff* const restrict rb, const ECB_UINT_T total_size, const ECB_UINT_T element_size);
+#if defined(ECB_MIRROR)
+/* ecbuff_new_mirror / ecbuff_delete_mirror (ecbuff_mirror.c)
+ * Alternative to allocating memory and calling ecbuff_init(). Maps the
+ * element storage twice back-to-back, so any window of up to total_size
+ * bytes starting within elems[] is virtually contiguous. total_size is
+ * rounded up to a multiple of the page size (and element_size), with
+ * ECB_POW2 to a power of two of at least one page.
+ * Returns NULL and sets errno on failure.
+ */
+ecbuff* ecbuff_new_mirror(const ECB_UINT_T total_size, const ECB_UINT_T element_size);
+void ecbuff_delete_mirror(ecbuff* const restrict rb);
+#endif
 bool ecbuff_is_full(const ecbuff* const restrict rb);
 bool ecbuff_is_empty(const ecbuff* const restrict rb);
 ECB_VOID_BOOL_T ecbuff_write(ecbuff* const restrict rb, const void* const restrict element);
@@ -54,11 +197,124 @@ ECB_VOID_BOOL_T ecbuff_read(ecbuff* const restrict rb, void* const restrict elem
 ECB_UINT_T ecbuff_unused(const ecbuff* const restrict rb);
 ECB_UINT_T ecbuff_used(const ecbuff* const restrict rb);
 
+#if defined(ECB_STATS)
+/* Plain copy of the counters, filled in by ecbuff_stats_get() */
+typedef struct {
+    ECB_UINT_T writes;
+    ECB_UINT_T reads;
+    ECB_UINT_T drops;
+    ECB_UINT_T overwrites;
+    ECB_UINT_T full;
+    ECB_UINT_T empty;
+    ECB_UINT_T high_water;
+} ecbuff_stats;
+
+/* ecbuff_stats_get
+ * Copies the counters without locking, any thread may poll them. Each
+ * counter is read atomically, but they are not read at the same instant,
+ * so e.g. writes - reads may briefly disagree with ecbuff_used().
+ * Counters wrap around at ECB_UINT_MAX and are cleared by ecbuff_init().
+ */
+void ecbuff_stats_get(const ecbuff* const restrict rb, ecbuff_stats* const restrict stats);
+#endif
+
+#if defined(ECB_TIMESTAMP)
+/* ecbuff_timestamp_init
+ * Attaches stamps, an array of ECB_TIMESTAMP_SLOTS(total_size, element_size)
+ * entries, and hist to a buffer that is empty, e.g. right after
+ * ecbuff_init(). From then on every ECB_TIMESTAMP_EVERY-th element is timed
+ * from being published to being released by the consumer. Pass NULL for
+ * stamps to disable it again. Snapshot hist from any thread.
+ */
+void ecbuff_timestamp_init(ecbuff* const restrict rb, uint64_t* const restrict stamps, ehist* const restrict hist);
+#endif
+
+/* ecbuff_config_fingerprint
+ * Identifies the options and type sizes that determine ecbuff's memory
+ * layout and index protocol. Instances can only be shared between code
+ * (e.g. processes) reporting the same fingerprint.
+ */
+uint32_t ecbuff_config_fingerprint(void);
+
+/* ecbuff_write_n / ecbuff_read_n
+ * Bulk variants that move up to n consecutive elements with at most two
+ * copies (split at the wrap point, a single one if mirrored) and a single
+ * index update.
+ * Both return the number of elements actually moved. ecbuff_write_n()
+ * stores fewer than n elements only with ECB_WRITE_DROP, ecbuff_read_n()
+ * returns fewer than n only with ECB_EXTRA_CHECKS. Otherwise requesting more
+ * than ecbuff_unused()/ecbuff_used() is undefined behaviour.
+ * With ECB_WRITE_OVERWRITE all n elements are accepted, evicting the oldest.
+ */
+ECB_UINT_T ecbuff_write_n(ecbuff* const restrict rb, const void* const restrict elements, ECB_UINT_T n);
+ECB_UINT_T ecbuff_read_n(ecbuff* const restrict rb, void* const restrict elements, ECB_UINT_T n);
+
+#if defined(ECB_WAIT)
+/* ecbuff_read_wait / ecbuff_write_wait (ecbuff_wait.c)
+ * Blocking variants of ecbuff_read() and ecbuff_write(). If the buffer is
+ * empty (full) they spin for ECB_WAIT_SPIN iterations, then park the calling
+ * thread until the peer publishes or timeout_us microseconds have passed.
+ * Return false on timeout, pass ECB_WAIT_FOREVER to wait indefinitely.
+ */
+bool ecbuff_read_wait(ecbuff* const restrict rb, void* const restrict element, const uint32_t timeout_us);
+bool ecbuff_write_wait(ecbuff* const restrict rb, const void* const restrict element, const uint32_t timeout_us);
+/* Wakes a parked peer, used internally by ecbuff.c */
+void ecbuff_wake(ECB_PARKED_T* const restrict parked);
+#endif // ECB_WAIT
+
+#if ECB_COPY == ECB_COPY_SIMD || ECB_COPY == ECB_COPY_STREAM
+#include <stddef.h>
+/* ecbuff_copy / ecbuff_copy_stream (ecbuff_copy.c)
+ * Element copies used internally by ecbuff.c, also usable for filling
+ * spans. ecbuff_copy() picks AVX2 or SSE2 at runtime on x86 and uses NEON
+ * on ARM. ecbuff_copy_stream() writes copies of at least
+ * ECB_COPY_STREAM_MIN bytes with non-temporal stores that bypass the
+ * cache, it's ordered before any subsequent store. ecbuff_copy_name()
+ * names the variant in use.
+ */
+void ecbuff_copy(void* const restrict dest, const void* const restrict src, const size_t len);
+void ecbuff_copy_stream(void* const restrict dest, const void* const restrict src, const size_t len);
+const char* ecbuff_copy_name(void);
+#endif
+
 #ifdef ECB_DIRECT_ACCESS
 ECB_VOLATILE_T void* ecbuff_write_alloc(ecbuff* const restrict rb);
 ECB_VOID_BOOL_T ecbuff_write_enqueue(ecbuff* const restrict rb);
 ECB_VOLATILE_T void* ecbuff_read_dequeue(ecbuff* const restrict rb);
 ECB_VOID_BOOL_T ecbuff_read_free(ecbuff* const restrict rb);
+
+/* ecbuff_write_alloc_span / ecbuff_read_dequeue_span
+ * Return a pointer to the largest contiguous run of free (or ready) elements,
+ * limited by the wrap point unless mirrored, and store its length in
+ * elements to *count.
+ * Return NULL and set *count to 0 if nothing is available.
+ * ecbuff_write_enqueue_n() / ecbuff_read_free_n() commit the first n elements
+ * of such a run. A single DMA transfer or syscall can thus cover many slots.
+ */
+ECB_VOLATILE_T void* ecbuff_write_alloc_span(ecbuff* const restrict rb, ECB_UINT_T* const restrict count);
+ECB_VOID_BOOL_T ecbuff_write_enqueue_n(ecbuff* const restrict rb, ECB_UINT_T n);
+ECB_VOLATILE_T void* ecbuff_read_dequeue_span(ecbuff* const restrict rb, ECB_UINT_T* const restrict count);
+ECB_VOID_BOOL_T ecbuff_read_free_n(ecbuff* const restrict rb, ECB_UINT_T n);
+
+/* ecbuff_peek
+ * Returns a pointer to the i-th ready element counting from the oldest, or
+ * NULL if fewer than i + 1 elements are ready. Nothing is consumed, release
+ * a prefix with ecbuff_read_free_n() once it has been processed.
+ */
+ECB_VOLATILE_T void* ecbuff_peek(ecbuff* const restrict rb, const ECB_UINT_T i);
+
+/* ecbuff_iter_init / ecbuff_iter_next
+ * Walks the elements ready at the time of ecbuff_iter_init(), which returns
+ * their number, across the wrap point. ecbuff_iter_next() returns NULL once
+ * all have been visited. Consumer side only, nothing is consumed.
+ */
+typedef struct {
+    ecbuff* rb;
+    ECB_UINT_T offset;                          /* next element in elems[] */
+    ECB_UINT_T left;                            /* elements not yet visited */
+} ecbuff_iter;
+ECB_UINT_T ecbuff_iter_init(ecbuff_iter* const restrict it, ecbuff* const restrict rb);
+ECB_VOLATILE_T void* ecbuff_iter_next(ecbuff_iter* const restrict it);
 #endif // ECB_DIRECT_ACCESS
 
 #endif // ECBUFF_H
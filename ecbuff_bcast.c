@@ -0,0 +1,214 @@
+/* See ecbuff_bcast.h for further information */
+
+#include "ecbuff_bcast.h"
+#include <string.h>
+
+#if defined(ECB_ASSERT)
+#include <assert.h>
+
+#if !defined(ASSERT)
+//use standard assert() if nothing custom was defined
+#define ASSERT(x) assert(x)
+#endif
+
+#else
+#define NDEBUG
+#undef ASSERT	//ignore earlier definition from ecbuff_cfg.h
+#define ASSERT(x)
+#endif
+
+_Static_assert(sizeof(ecbuff_bcast_reader) == ECB_CACHELINE, "ecbuff_bcast_reader has to fill a cache line");
+
+static inline char* ecbuff_bcast_elem(const ecbuff_bcast* const restrict rb, const size_t pos)
+{
+    return (char*)&rb->elems[(pos & rb->mask) * rb->element_size];
+}
+
+void ecbuff_bcast_init(ecbuff_bcast* const restrict rb, const ECB_UINT_T count, const ECB_UINT_T element_size,
+                       const ECB_UINT_T readers, const ecbuff_bcast_mode mode)
+{
+    ASSERT(rb);
+    ASSERT(count >= 2);
+    ASSERT(!(count & (count - 1)));
+    ASSERT(element_size);
+    ASSERT(readers && readers <= ECB_BCAST_READERS_MAX);
+    ASSERT(mode == ECB_BCAST_GATE || mode == ECB_BCAST_DROP_LAGGING);
+    rb->mask = count - 1;
+    rb->element_size = element_size;
+    rb->readers = readers;
+    rb->mode = mode;
+    atomic_init(&rb->tail, 0);
+    rb->min_head = 0;
+    for(size_t i = 0; i < ECB_BCAST_READERS_MAX; i++)
+    {
+        atomic_init(&rb->reader[i].head, 0);
+        rb->reader[i].tail_cache = 0;
+        atomic_init(&rb->reader[i].state, i < readers ? ECB_BCAST_ACTIVE : ECB_BCAST_DETACHED);
+    }
+}
+
+/* ecbuff_bcast_reserve
+ * Returns whether the slot at tail may be written. Only once the cached
+ * minimum makes the buffer look full, the active readers' heads are scanned.
+ * In ECB_BCAST_DROP_LAGGING mode readers still holding that slot are flagged
+ * as lagged first. The release fence orders the flag before the element
+ * stores, pairing with the acquire fence in ecbuff_bcast_read_free().
+ */
+static bool ecbuff_bcast_reserve(ecbuff_bcast* const restrict rb, const size_t tail)
+{
+    size_t count = rb->mask + 1;
+    if(tail - rb->min_head < count)
+        return true;
+
+    size_t min = tail;
+    bool flagged = false;
+    for(size_t i = 0; i < rb->readers; i++)
+    {
+        ecbuff_bcast_reader* r = &rb->reader[i];
+        if(atomic_load_explicit(&r->state, memory_order_acquire) != ECB_BCAST_ACTIVE)
+            continue;
+        size_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+        if(tail - head >= count && rb->mode == ECB_BCAST_DROP_LAGGING)
+        {
+            unsigned int expected = ECB_BCAST_ACTIVE;
+            /* Fails if the reader detached meanwhile, either way it's out */
+            atomic_compare_exchange_strong_explicit(&r->state, &expected, ECB_BCAST_LAGGED,
+                                                    memory_order_relaxed, memory_order_relaxed);
+            flagged = true;
+            continue;
+        }
+        if(tail - head > tail - min)
+            min = head;
+    }
+    if(flagged)
+        atomic_thread_fence(memory_order_release);
+    rb->min_head = min;
+    return tail - min < count;
+}
+
+bool ecbuff_bcast_write(ecbuff_bcast* const restrict rb, const void* const restrict element)
+{
+    ASSERT(rb);
+    ASSERT(element);
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    if(!ecbuff_bcast_reserve(rb, tail))
+        return false;
+    memcpy(ecbuff_bcast_elem(rb, tail), element, rb->element_size);
+    atomic_store_explicit(&rb->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+/* Returns the reader's next element or NULL if there is none or it lagged */
+static inline const char* ecbuff_bcast_next(ecbuff_bcast* const restrict rb, ecbuff_bcast_reader* const restrict r)
+{
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    if(head == r->tail_cache)
+    {
+        r->tail_cache = atomic_load_explicit(&rb->tail, memory_order_acquire);
+        if(head == r->tail_cache)
+            return NULL;
+    }
+    /* Flagged before the slot gets overwritten, visible once tail is */
+    if(atomic_load_explicit(&r->state, memory_order_acquire) != ECB_BCAST_ACTIVE)
+        return NULL;
+    return ecbuff_bcast_elem(rb, head);
+}
+
+/* Advances the reader unless it lagged while accessing its element */
+static inline bool ecbuff_bcast_release(ecbuff_bcast_reader* const restrict r)
+{
+    atomic_thread_fence(memory_order_acquire);
+    if(atomic_load_explicit(&r->state, memory_order_relaxed) != ECB_BCAST_ACTIVE)
+        return false;
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    return true;
+}
+
+bool ecbuff_bcast_read(ecbuff_bcast* const restrict rb, const ECB_UINT_T reader, void* const restrict element)
+{
+    ASSERT(rb);
+    ASSERT(element);
+    ASSERT(reader < rb->readers);
+    ecbuff_bcast_reader* r = &rb->reader[reader];
+    const char* src = ecbuff_bcast_next(rb, r);
+    if(!src)
+        return false;
+    memcpy(element, src, rb->element_size);
+    return ecbuff_bcast_release(r);
+}
+
+ECB_UINT_T ecbuff_bcast_used(const ecbuff_bcast* const restrict rb, const ECB_UINT_T reader)
+{
+    ASSERT(rb);
+    ASSERT(reader < rb->readers);
+    size_t head = atomic_load_explicit(&rb->reader[reader].head, memory_order_acquire);
+    size_t used = atomic_load_explicit(&rb->tail, memory_order_acquire) - head;
+    /* A lagged reader may be any number of laps behind */
+    if(used > rb->mask + 1)
+        return rb->mask + 1;
+    return used;
+}
+
+ecbuff_bcast_state ecbuff_bcast_reader_state(const ecbuff_bcast* const restrict rb, const ECB_UINT_T reader)
+{
+    ASSERT(rb);
+    ASSERT(reader < rb->readers);
+    return (ecbuff_bcast_state)atomic_load_explicit(&rb->reader[reader].state, memory_order_acquire);
+}
+
+/* The producer ignores inactive readers and its cached minimum can't be
+ * ahead of the current tail, so publishing head before state is safe.
+ */
+size_t ecbuff_bcast_rejoin(ecbuff_bcast* const restrict rb, const ECB_UINT_T reader)
+{
+    ASSERT(rb);
+    ASSERT(reader < rb->readers);
+    ecbuff_bcast_reader* r = &rb->reader[reader];
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+    atomic_store_explicit(&r->head, tail, memory_order_relaxed);
+    r->tail_cache = tail;
+    atomic_store_explicit(&r->state, ECB_BCAST_ACTIVE, memory_order_seq_cst);
+    return tail - head;
+}
+
+void ecbuff_bcast_detach(ecbuff_bcast* const restrict rb, const ECB_UINT_T reader)
+{
+    ASSERT(rb);
+    ASSERT(reader < rb->readers);
+    atomic_store_explicit(&rb->reader[reader].state, ECB_BCAST_DETACHED, memory_order_release);
+}
+
+#ifdef ECB_DIRECT_ACCESS
+void* ecbuff_bcast_write_alloc(ecbuff_bcast* const restrict rb)
+{
+    ASSERT(rb);
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    if(!ecbuff_bcast_reserve(rb, tail))
+        return NULL;
+    return ecbuff_bcast_elem(rb, tail);
+}
+
+void ecbuff_bcast_write_enqueue(ecbuff_bcast* const restrict rb)
+{
+    ASSERT(rb);
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    ASSERT(tail - rb->min_head <= rb->mask);
+    atomic_store_explicit(&rb->tail, tail + 1, memory_order_release);
+}
+
+const void* ecbuff_bcast_read_dequeue(ecbuff_bcast* const restrict rb, const ECB_UINT_T reader)
+{
+    ASSERT(rb);
+    ASSERT(reader < rb->readers);
+    return ecbuff_bcast_next(rb, &rb->reader[reader]);
+}
+
+bool ecbuff_bcast_read_free(ecbuff_bcast* const restrict rb, const ECB_UINT_T reader)
+{
+    ASSERT(rb);
+    ASSERT(reader < rb->readers);
+    return ecbuff_bcast_release(&rb->reader[reader]);
+}
+#endif
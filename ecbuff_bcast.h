@@ -0,0 +1,113 @@
+/*
+ * ecbuff_bcast is a single-producer broadcast ring: every element written is
+ * seen by each of a fixed set of readers, each owning a read cursor on its
+ * own cache line. The producer writes an element once, instead of copying it
+ * into one ecbuff per consumer, and readers access it in place.
+ *
+ * In ECB_BCAST_GATE mode the producer is held back by the slowest reader,
+ * writes fail while the oldest slot has not been freed by every reader.
+ * In ECB_BCAST_DROP_LAGGING mode the producer never waits. A reader that
+ * falls a whole buffer behind is flagged ECB_BCAST_LAGGED instead and no
+ * longer holds the producer back, until it calls ecbuff_bcast_rejoin().
+ * The producer only scans the readers' cursors once its cached minimum says
+ * the buffer is full, so the cost per write does not grow with the readers.
+ *
+ * It works on fixed size elements in caller-provided storage, requires C11
+ * atomics and a power of two element count.
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#ifndef ECBUFF_BCAST_H
+#define ECBUFF_BCAST_H
+
+#include "ecbuff.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+#if !defined(ECB_CACHELINE)
+#define ECB_CACHELINE 64
+#endif
+
+/* ECB_BCAST_READERS_MAX
+ * Upper limit of readers per instance, each one costs a cache line.
+ */
+#if !defined(ECB_BCAST_READERS_MAX)
+#define ECB_BCAST_READERS_MAX 8
+#endif
+
+typedef enum {
+    ECB_BCAST_GATE = 0,                         /* the slowest reader holds back the producer */
+    ECB_BCAST_DROP_LAGGING                      /* readers a whole buffer behind are dropped */
+} ecbuff_bcast_mode;
+
+typedef enum {
+    ECB_BCAST_ACTIVE = 0,
+    ECB_BCAST_LAGGED,                           /* overrun by the producer, see ecbuff_bcast_rejoin() */
+    ECB_BCAST_DETACHED                          /* left by ecbuff_bcast_detach() */
+} ecbuff_bcast_state;
+
+typedef struct {
+    atomic_size_t head;                         /* next position to be read */
+    size_t tail_cache;                          /* reader's copy of tail */
+    atomic_uint state;                          /* ecbuff_bcast_state, set to LAGGED by the producer */
+    char pad[ECB_CACHELINE - 2 * sizeof(atomic_size_t) - sizeof(atomic_uint)];
+} ecbuff_bcast_reader;
+
+typedef struct {
+    size_t mask;                                /* element count - 1 */
+    size_t element_size;
+    size_t readers;
+    ecbuff_bcast_mode mode;
+    char pad_config[ECB_CACHELINE - 3 * sizeof(size_t) - sizeof(ecbuff_bcast_mode)];
+    atomic_size_t tail;                         /* next position to be written */
+    size_t min_head;                            /* producer's copy of the slowest reader's head */
+    char pad_tail[ECB_CACHELINE - 2 * sizeof(atomic_size_t)];
+    ecbuff_bcast_reader reader[ECB_BCAST_READERS_MAX];
+    char elems[];                               /* count * element_size bytes */
+} ecbuff_bcast;
+
+/* Number of bytes to allocate for an instance holding count elements */
+#define ECBUFF_BCAST_SIZE(count, element_size) \
+    (sizeof(ecbuff_bcast) + (size_t)(count) * (size_t)(element_size))
+
+/* ecbuff_bcast_init
+ * count has to be a power of two and at least 2, readers at most
+ * ECB_BCAST_READERS_MAX. Readers are numbered 0 to readers - 1 and start
+ * out active. rb has to provide ECBUFF_BCAST_SIZE(count, element_size) bytes.
+ */
+void ecbuff_bcast_init(ecbuff_bcast* const restrict rb, const ECB_UINT_T count, const ECB_UINT_T element_size,
+                       const ECB_UINT_T readers, const ecbuff_bcast_mode mode);
+/* Producer only, returns false if the slowest reader still holds the oldest slot (ECB_BCAST_GATE) */
+bool ecbuff_bcast_write(ecbuff_bcast* const restrict rb, const void* const restrict element);
+/* ecbuff_bcast_read
+ * Copies the reader's next element. Returns false if there is none or if
+ * the reader lagged, which ecbuff_bcast_reader_state() tells apart.
+ */
+bool ecbuff_bcast_read(ecbuff_bcast* const restrict rb, const ECB_UINT_T reader, void* const restrict element);
+/* Number of elements the reader has yet to read */
+ECB_UINT_T ecbuff_bcast_used(const ecbuff_bcast* const restrict rb, const ECB_UINT_T reader);
+ecbuff_bcast_state ecbuff_bcast_reader_state(const ecbuff_bcast* const restrict rb, const ECB_UINT_T reader);
+/* ecbuff_bcast_rejoin
+ * Called by a lagged or detached reader, continues with the next element
+ * written. Returns the number of elements skipped.
+ */
+size_t ecbuff_bcast_rejoin(ecbuff_bcast* const restrict rb, const ECB_UINT_T reader);
+/* Called by a reader leaving, the producer no longer waits for it */
+void ecbuff_bcast_detach(ecbuff_bcast* const restrict rb, const ECB_UINT_T reader);
+
+#ifdef ECB_DIRECT_ACCESS
+/* Producer: ecbuff_bcast_write_alloc() returns the next slot or NULL like
+ * ecbuff_bcast_write() would fail, ecbuff_bcast_write_enqueue() publishes it.
+ * Readers: ecbuff_bcast_read_dequeue() returns the reader's next element in
+ * place or NULL, ecbuff_bcast_read_free() releases it. The latter returns
+ * false if the reader lagged meanwhile, the element may then have been
+ * overwritten while it was accessed.
+ */
+void* ecbuff_bcast_write_alloc(ecbuff_bcast* const restrict rb);
+void ecbuff_bcast_write_enqueue(ecbuff_bcast* const restrict rb);
+const void* ecbuff_bcast_read_dequeue(ecbuff_bcast* const restrict rb, const ECB_UINT_T reader);
+bool ecbuff_bcast_read_free(ecbuff_bcast* const restrict rb, const ECB_UINT_T reader);
+#endif // ECB_DIRECT_ACCESS
+
+#endif // ECBUFF_BCAST_H
@@ -0,0 +1,317 @@
+/*
+ * Tests for ecbuff_bcast
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#include "ecbuff_bcast.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define ECBBT_READERS 3
+#define ECBBT_PER_RUN 50000
+
+typedef struct {
+    ecbuff_bcast* buff;
+    uint32_t id;
+    uint32_t received;
+    uint32_t skipped;
+} ecbbt_thread;
+
+static atomic_uint ecbbt_done;
+
+ecbuff_bcast* ecbbt_new(ECB_UINT_T readers, ecbuff_bcast_mode mode);
+void ecbbt_delete(ecbuff_bcast* buff);
+void ecbbt_test_st_gate(ECB_UINT_T count);
+void ecbbt_test_st_drop(void);
+void ecbbt_test_mt(ecbuff_bcast_mode mode, ECB_UINT_T count);
+void* ecbbt_mt_source(void* buff);
+void* ecbbt_mt_sink(void* arg);
+bool ecbbt_put(ecbuff_bcast* buff, uint32_t seq, bool direct);
+bool ecbbt_get(ecbuff_bcast* buff, ECB_UINT_T reader, uint32_t* seq, bool direct);
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    ecbbt_test_st_gate(1337);
+    ecbbt_test_st_drop();
+    ecbbt_test_mt(ECB_BCAST_GATE, 5);
+    ecbbt_test_mt(ECB_BCAST_DROP_LAGGING, 5);
+    return 0;
+}
+
+ecbuff_bcast* ecbbt_new(ECB_UINT_T readers, ecbuff_bcast_mode mode)
+{
+    ecbuff_bcast* buff = malloc(ECBUFF_BCAST_SIZE(ECBT_ELEM_CNT, ECBT_ELEM_SIZ));
+    assert(buff);
+    ecbuff_bcast_init(buff, ECBT_ELEM_CNT, ECBT_ELEM_SIZ, readers, mode);
+    for(ECB_UINT_T i = 0; i < readers; i++)
+        assert(ecbuff_bcast_used(buff, i) == 0 && ecbuff_bcast_reader_state(buff, i) == ECB_BCAST_ACTIVE);
+    return buff;
+}
+
+void ecbbt_delete(ecbuff_bcast* buff)
+{
+    assert(buff);
+    free(buff);
+}
+
+/* Every byte of an element is derived from seq, so overwritten ones stand out */
+bool ecbbt_put(ecbuff_bcast* buff, uint32_t seq, bool direct)
+{
+    uint8_t value[ECBT_ELEM_SIZ];
+    memset(value, (uint8_t)(seq * 7 + 1), ECBT_ELEM_SIZ);
+    memcpy(value, &seq, sizeof(seq));
+#if defined(ECB_DIRECT_ACCESS)
+    if(direct)
+    {
+        void* ptr = ecbuff_bcast_write_alloc(buff);
+        if(!ptr)
+            return false;
+        memcpy(ptr, value, ECBT_ELEM_SIZ);
+        ecbuff_bcast_write_enqueue(buff);
+        return true;
+    }
+#else
+    (void)direct;
+#endif
+    return ecbuff_bcast_write(buff, value);
+}
+
+bool ecbbt_get(ecbuff_bcast* buff, ECB_UINT_T reader, uint32_t* seq, bool direct)
+{
+    uint8_t value[ECBT_ELEM_SIZ];
+#if defined(ECB_DIRECT_ACCESS)
+    if(direct)
+    {
+        const uint8_t* ptr = ecbuff_bcast_read_dequeue(buff, reader);
+        if(!ptr)
+            return false;
+        memcpy(value, ptr, ECBT_ELEM_SIZ);
+        if(!ecbuff_bcast_read_free(buff, reader))
+            return false;
+    }
+    else
+#else
+    (void)direct;
+#endif
+    if(!ecbuff_bcast_read(buff, reader, value))
+        return false;
+    memcpy(seq, value, sizeof(*seq));
+    for(size_t i = sizeof(*seq); i < ECBT_ELEM_SIZ; i++)
+    {
+        if(value[i] != (uint8_t)(*seq * 7 + 1))
+        {
+            printf("Read overwritten element! (seq %u)\n", *seq);
+            assert(false);
+        }
+    }
+    return true;
+}
+
+void ecbbt_test_st_gate(ECB_UINT_T count)
+{
+    ecbuff_bcast* buff = ecbbt_new(ECBBT_READERS, ECB_BCAST_GATE);
+    uint32_t wseq = 0;
+    uint32_t rseq[ECBBT_READERS] = {0};
+
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        /* The slowest reader determines the free space */
+        uint32_t slowest = wseq;
+        for(ECB_UINT_T r = 0; r < ECBBT_READERS; r++)
+            if(wseq - rseq[r] > wseq - slowest)
+                slowest = rseq[r];
+        ECB_UINT_T num = rand() % (ECBT_ELEM_CNT + 2);
+        for(ECB_UINT_T j = 0; j < num; j++)
+        {
+            bool ret = ecbbt_put(buff, wseq, wseq & 1);
+            assert(ret == (wseq - slowest < ECBT_ELEM_CNT));
+            if(ret)
+                wseq++;
+        }
+
+        for(ECB_UINT_T r = 0; r < ECBBT_READERS; r++)
+        {
+            assert(ecbuff_bcast_used(buff, r) == wseq - rseq[r]);
+            num = rand() % (wseq - rseq[r] + 1);
+            for(ECB_UINT_T j = 0; j < num; j++)
+            {
+                uint32_t seq;
+                assert(ecbbt_get(buff, r, &seq, (j + r) & 1));
+                if(seq != rseq[r])
+                {
+                    printf("Read unexpected value! (%u instead of %u)\n", seq, rseq[r]);
+                    assert(false);
+                    return;
+                }
+                rseq[r]++;
+            }
+        }
+    }
+
+    /* A detached reader no longer holds back the producer */
+    uint32_t seq;
+    for(ECB_UINT_T r = 1; r < ECBBT_READERS; r++)
+        ecbuff_bcast_detach(buff, r);
+    while(ecbbt_get(buff, 0, &seq, false))
+        ;
+    for(ECB_UINT_T j = 0; j < ECBT_ELEM_CNT; j++)
+        assert(ecbbt_put(buff, wseq++, false));
+    assert(!ecbbt_put(buff, wseq, false));
+    assert(!ecbbt_get(buff, 1, &seq, false));
+    assert(ecbuff_bcast_reader_state(buff, 1) == ECB_BCAST_DETACHED);
+
+    /* Rejoining continues with the next element written */
+    assert(ecbuff_bcast_rejoin(buff, 1) == wseq - rseq[1]);
+    assert(ecbuff_bcast_used(buff, 1) == 0);
+    assert(ecbbt_get(buff, 0, &seq, false));
+    assert(ecbbt_put(buff, wseq, true));
+    assert(ecbbt_get(buff, 1, &seq, true) && seq == wseq);
+    ecbbt_delete(buff);
+}
+
+void ecbbt_test_st_drop(void)
+{
+    ecbuff_bcast* buff = ecbbt_new(2, ECB_BCAST_DROP_LAGGING);
+    uint32_t wseq = 0;
+    uint32_t seq;
+
+    /* Reader 1 falls behind, the producer carries on without it */
+    for(; wseq < ECBT_ELEM_CNT; wseq++)
+    {
+        assert(ecbbt_put(buff, wseq, false));
+        assert(ecbbt_get(buff, 0, &seq, false) && seq == wseq);
+    }
+    assert(ecbuff_bcast_reader_state(buff, 1) == ECB_BCAST_ACTIVE);
+    assert(ecbbt_put(buff, wseq++, false));
+    assert(ecbuff_bcast_reader_state(buff, 1) == ECB_BCAST_LAGGED);
+    assert(ecbuff_bcast_reader_state(buff, 0) == ECB_BCAST_ACTIVE);
+    assert(!ecbbt_get(buff, 1, &seq, false));
+    for(ECB_UINT_T j = 0; j < ECBT_ELEM_CNT; j++)
+        assert(ecbbt_put(buff, wseq++, false));
+    assert(ecbuff_bcast_rejoin(buff, 1) == wseq);
+    assert(ecbuff_bcast_reader_state(buff, 1) == ECB_BCAST_ACTIVE);
+    assert(ecbbt_put(buff, wseq, false));
+    assert(ecbbt_get(buff, 1, &seq, false) && seq == wseq);
+    wseq++;
+
+#if defined(ECB_DIRECT_ACCESS)
+    /* An element overwritten while being accessed is reported */
+    assert(ecbuff_bcast_rejoin(buff, 0) == ECBT_ELEM_CNT + 2);
+    assert(ecbbt_put(buff, wseq++, false));
+    const void* ptr = ecbuff_bcast_read_dequeue(buff, 0);
+    assert(ptr);
+    for(ECB_UINT_T j = 0; j < ECBT_ELEM_CNT; j++)
+        assert(ecbbt_put(buff, wseq++, true));
+    assert(!ecbuff_bcast_read_free(buff, 0));
+    assert(ecbuff_bcast_reader_state(buff, 0) == ECB_BCAST_LAGGED);
+    assert(!ecbuff_bcast_read_dequeue(buff, 0));
+#endif
+    ecbbt_delete(buff);
+}
+
+void ecbbt_test_mt(ecbuff_bcast_mode mode, ECB_UINT_T count)
+{
+    ecbuff_bcast* buff = ecbbt_new(ECBBT_READERS, mode);
+
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        pthread_t threads[ECBBT_READERS + 1];
+        ecbbt_thread args[ECBBT_READERS];
+        atomic_store(&ecbbt_done, 0);
+        ecbuff_bcast_init(buff, ECBT_ELEM_CNT, ECBT_ELEM_SIZ, ECBBT_READERS, mode);
+
+        for(uint32_t t = 0; t < ECBBT_READERS; t++)
+        {
+            args[t] = (ecbbt_thread){buff, t, 0, 0};
+            if(pthread_create(&threads[t], NULL, ecbbt_mt_sink, &args[t]))
+            {
+                printf("Failed to spawn thread!\n");
+                assert(false);
+                return;
+            }
+        }
+        if(pthread_create(&threads[ECBBT_READERS], NULL, ecbbt_mt_source, buff))
+        {
+            printf("Failed to spawn thread!\n");
+            assert(false);
+            return;
+        }
+
+        for(uint32_t t = 0; t <= ECBBT_READERS; t++)
+            pthread_join(threads[t], NULL);
+        for(uint32_t t = 0; t < ECBBT_READERS; t++)
+        {
+            /* Gating loses nothing, otherwise every gap was reported */
+            if(args[t].received + args[t].skipped != ECBBT_PER_RUN ||
+               (mode == ECB_BCAST_GATE && args[t].skipped))
+            {
+                printf("Reader %u: received %u, skipped %u elements!\n", t, args[t].received, args[t].skipped);
+                assert(false);
+                return;
+            }
+        }
+    }
+
+    ecbbt_delete(buff);
+}
+
+void* ecbbt_mt_source(void* buff)
+{
+    for(uint32_t seq = 0; seq < ECBBT_PER_RUN;)
+    {
+        if(ecbbt_put(buff, seq, seq & 1))
+            seq++;
+        else
+            sched_yield();
+    }
+    atomic_store(&ecbbt_done, 1);
+
+    pthread_exit((void*)true);
+}
+
+void* ecbbt_mt_sink(void* arg)
+{
+    ecbbt_thread* t = arg;
+    uint32_t expected = 0;
+
+    /* Reader 0 is slowed down, making it lag in ECB_BCAST_DROP_LAGGING mode */
+    for(uint32_t n = 0;; n++)
+    {
+        uint32_t seq;
+        if(!t->id && !(rand() % 16))
+            sched_yield();
+        if(!ecbbt_get(t->buff, t->id, &seq, (n + t->id) & 1))
+        {
+            if(ecbuff_bcast_reader_state(t->buff, t->id) == ECB_BCAST_LAGGED)
+            {
+                size_t skipped = ecbuff_bcast_rejoin(t->buff, t->id);
+                t->skipped += skipped;
+                expected += skipped;
+                continue;
+            }
+            if(atomic_load(&ecbbt_done) && !ecbuff_bcast_used(t->buff, t->id))
+                break;
+            sched_yield();
+            continue;
+        }
+        if(seq != expected)
+        {
+            printf("Reader %u: read unexpected value! (%u instead of %u)\n", t->id, seq, expected);
+            assert(false);
+            pthread_exit((void*)false);
+        }
+        expected++;
+        t->received++;
+    }
+
+    pthread_exit((void*)true);
+}
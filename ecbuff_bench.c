@@ -0,0 +1,518 @@
+/*
+ * Benchmark for ecbuff
+ *
+ * Measures throughput (one producer, one consumer) and round-trip latency
+ * (ping-pong over two buffers) for the configuration it was compiled with.
+ * Both threads can be pinned to CPUs, ecbuff_run_bench.sh picks same-core,
+ * cross-core and cross-socket pairs and iterates over configurations.
+ * Results are printed as CSV or JSON lines to track regressions.
+ *
+ * Usage: ecbuff_bench [-m throughput|pingpong] [-a copy|bulk|direct]
+ *                     [-e element_size] [-b buffer_size] [-n count]
+ *                     [-p producer_cpu] [-c consumer_cpu] [-P placement]
+ *                     [-f csv|json] [-H]
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // pthread_setaffinity_np()
+#endif
+
+#include "ecbuff.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#if !defined(ECB_THREAD_MULTI)
+#error ecbuff_bench requires ECB_THREAD_MULTI!
+#endif
+
+#if defined(ECB_THREAD_BARRIER)
+#define ECBB_THREAD "barrier"
+#elif defined(ECB_THREAD_VOLATILE)
+#define ECBB_THREAD "volatile"
+#else
+#define ECBB_THREAD "atomic"
+#endif
+
+#if defined(ECB_CACHE_PAD)
+#define ECBB_PAD "_pad"
+#else
+#define ECBB_PAD ""
+#endif
+
+#if defined(ECB_POW2)
+#define ECBB_POW2 "_pow2"
+#else
+#define ECBB_POW2 ""
+#endif
+
+#if defined(ECB_WAIT)
+#define ECBB_WAIT "_wait"
+#else
+#define ECBB_WAIT ""
+#endif
+
+#if defined(ECB_EXTRA_CHECKS)
+#define ECBB_EXTRA "_extra"
+#else
+#define ECBB_EXTRA ""
+#endif
+
+#if ECB_COPY == ECB_COPY_VBYTE
+#define ECBB_ENGINE "_vbyte"
+#elif ECB_COPY == ECB_COPY_VLINE
+#define ECBB_ENGINE "_vline"
+#elif ECB_COPY == ECB_COPY_SIMD
+#define ECBB_ENGINE "_simd"
+#elif ECB_COPY == ECB_COPY_STREAM
+#define ECBB_ENGINE "_stream"
+#else
+#define ECBB_ENGINE ""
+#endif
+
+#if defined(ECB_TIMESTAMP)
+#define ECBB_TIMESTAMP "_ts"
+#else
+#define ECBB_TIMESTAMP ""
+#endif
+
+#define ECBB_CONFIG ECBB_THREAD ECBB_PAD ECBB_POW2 ECBB_WAIT ECBB_EXTRA ECBB_ENGINE ECBB_TIMESTAMP
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ECBB_PAUSE() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define ECBB_PAUSE() __asm__ __volatile__("yield")
+#else
+#define ECBB_PAUSE()
+#endif
+
+/* Polls before yielding, keeps both threads progressing on a shared CPU */
+#define ECBB_SPIN 1024
+#define ECBB_HIST_BUCKETS 32
+
+typedef enum { ECBB_THROUGHPUT, ECBB_PINGPONG } ecbb_mode;
+typedef enum { ECBB_COPY, ECBB_BULK, ECBB_DIRECT } ecbb_api;
+
+typedef struct {
+    ecbb_mode mode;
+    ecbb_api api;
+    ECB_UINT_T element_size;
+    ECB_UINT_T buffer_size;
+    uint64_t count;
+    int producer_cpu;
+    int consumer_cpu;
+    const char* placement;
+    bool json;
+    bool header;
+} ecbb_opts;
+
+typedef struct {
+    const ecbb_opts* opts;
+    ecbuff* rb[2];
+    uint64_t* samples;
+    volatile bool* start;
+} ecbb_thread;
+
+static const char* const ecbb_mode_names[] = {"throughput", "pingpong"};
+static const char* const ecbb_api_names[] = {"copy", "bulk", "direct"};
+
+static uint64_t ecbb_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+static void ecbb_pin(int cpu)
+{
+    if(cpu < 0)
+        return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if(pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+    {
+        fprintf(stderr, "Failed to pin thread to CPU %d!\n", cpu);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static inline void ecbb_backoff(unsigned int* spins)
+{
+    if(++*spins < ECBB_SPIN)
+        ECBB_PAUSE();
+    else
+    {
+        *spins = 0;
+        sched_yield();
+    }
+}
+
+static void ecbb_wait_start(const ecbb_thread* t, int cpu)
+{
+    ecbb_pin(cpu);
+    while(!*t->start)
+        sched_yield();
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+/* Moves up to n elements, returns the number moved */
+static ECB_UINT_T ecbb_put(ecbuff* rb, ecbb_api api, const char* src, ECB_UINT_T n)
+{
+    ECB_UINT_T elem = rb->element_size;
+    switch(api)
+    {
+    case ECBB_BULK:
+        n = n < ecbuff_unused(rb) ? n : ecbuff_unused(rb);
+        return n ? ecbuff_write_n(rb, src, n) : 0;
+#if defined(ECB_DIRECT_ACCESS)
+    case ECBB_DIRECT:
+    {
+        ECB_UINT_T cnt;
+        void* dst = (void*)ecbuff_write_alloc_span(rb, &cnt);
+        if(!dst)
+            return 0;
+        n = n < cnt ? n : cnt;
+        memcpy(dst, src, (size_t)n * elem);
+        ecbuff_write_enqueue_n(rb, n);
+        return n;
+    }
+#endif
+    default:
+        (void)elem;
+        if(ecbuff_is_full(rb))
+            return 0;
+        ecbuff_write(rb, src);
+        return 1;
+    }
+}
+
+static ECB_UINT_T ecbb_get(ecbuff* rb, ecbb_api api, char* dst, ECB_UINT_T n)
+{
+    ECB_UINT_T elem = rb->element_size;
+    switch(api)
+    {
+    case ECBB_BULK:
+        n = n < ecbuff_used(rb) ? n : ecbuff_used(rb);
+        return n ? ecbuff_read_n(rb, dst, n) : 0;
+#if defined(ECB_DIRECT_ACCESS)
+    case ECBB_DIRECT:
+    {
+        ECB_UINT_T cnt;
+        const void* src = (const void*)ecbuff_read_dequeue_span(rb, &cnt);
+        if(!src)
+            return 0;
+        n = n < cnt ? n : cnt;
+        memcpy(dst, src, (size_t)n * elem);
+        ecbuff_read_free_n(rb, n);
+        return n;
+    }
+#endif
+    default:
+        (void)elem;
+        if(ecbuff_is_empty(rb))
+            return 0;
+        ecbuff_read(rb, dst);
+        return 1;
+    }
+}
+
+static void* ecbb_producer(void* arg)
+{
+    ecbb_thread* t = arg;
+    const ecbb_opts* o = t->opts;
+    ECB_UINT_T batch = o->api == ECBB_COPY ? 1 : o->buffer_size / o->element_size;
+    char* buf = calloc(batch, o->element_size);
+    unsigned int spins = 0;
+
+    ecbb_wait_start(t, o->producer_cpu);
+    for(uint64_t i = 0; i < o->count;)
+    {
+        ECB_UINT_T n = o->count - i < batch ? (ECB_UINT_T)(o->count - i) : batch;
+        n = ecbb_put(t->rb[0], o->api, buf, n);
+        if(!n)
+            ecbb_backoff(&spins);
+        i += n;
+    }
+    free(buf);
+    return NULL;
+}
+
+static void* ecbb_consumer(void* arg)
+{
+    ecbb_thread* t = arg;
+    const ecbb_opts* o = t->opts;
+    ECB_UINT_T batch = o->api == ECBB_COPY ? 1 : o->buffer_size / o->element_size;
+    char* buf = calloc(batch, o->element_size);
+    unsigned int spins = 0;
+
+    ecbb_wait_start(t, o->consumer_cpu);
+    for(uint64_t i = 0; i < o->count;)
+    {
+        ECB_UINT_T n = ecbb_get(t->rb[0], o->api, buf, batch);
+        if(!n)
+            ecbb_backoff(&spins);
+        i += n;
+    }
+    free(buf);
+    return NULL;
+}
+
+/* Sends one element to the echo thread and waits for its return */
+static void* ecbb_ping(void* arg)
+{
+    ecbb_thread* t = arg;
+    const ecbb_opts* o = t->opts;
+    char* buf = calloc(1, o->element_size);
+    uint64_t warmup = o->count / 10;
+    unsigned int spins = 0;
+
+    ecbb_wait_start(t, o->producer_cpu);
+    for(uint64_t i = 0; i < warmup + o->count; i++)
+    {
+        uint64_t t0 = ecbb_now_ns();
+        while(!ecbb_put(t->rb[0], o->api, buf, 1))
+            ecbb_backoff(&spins);
+        while(!ecbb_get(t->rb[1], o->api, buf, 1))
+            ecbb_backoff(&spins);
+        uint64_t t1 = ecbb_now_ns();
+        if(i >= warmup)
+            t->samples[i - warmup] = t1 - t0;
+    }
+    free(buf);
+    return NULL;
+}
+
+static void* ecbb_pong(void* arg)
+{
+    ecbb_thread* t = arg;
+    const ecbb_opts* o = t->opts;
+    char* buf = calloc(1, o->element_size);
+    uint64_t total = o->count / 10 + o->count;
+    unsigned int spins = 0;
+
+    ecbb_wait_start(t, o->consumer_cpu);
+    for(uint64_t i = 0; i < total; i++)
+    {
+        while(!ecbb_get(t->rb[0], o->api, buf, 1))
+            ecbb_backoff(&spins);
+        while(!ecbb_put(t->rb[1], o->api, buf, 1))
+            ecbb_backoff(&spins);
+    }
+    free(buf);
+    return NULL;
+}
+
+static ecbuff* ecbb_new(const ecbb_opts* o)
+{
+    ecbuff* rb = NULL;
+#if defined(ECB_CACHE_PAD)
+    size_t align = ECB_CACHELINE;
+#else
+    size_t align = 64;
+#endif
+    size_t size = (sizeof(ecbuff) + o->buffer_size + align - 1) / align * align;
+    if(posix_memalign((void**)&rb, align, size))
+        return NULL;
+    ecbuff_init(rb, o->buffer_size, o->element_size);
+#if defined(ECB_TIMESTAMP)
+    /* Sampling attached, to measure its cost */
+    uint64_t* stamps = malloc(ECB_TIMESTAMP_SLOTS(o->buffer_size, o->element_size) * sizeof(uint64_t));
+    ehist* hist = malloc(sizeof(ehist));
+    if(!stamps || !hist)
+    {
+        free(stamps);
+        free(hist);
+        free(rb);
+        return NULL;
+    }
+    ehist_init(hist);
+    ecbuff_timestamp_init(rb, stamps, hist);
+#endif
+    return rb;
+}
+
+static void ecbb_delete(ecbuff* rb)
+{
+#if defined(ECB_TIMESTAMP)
+    free((void*)rb->timestamp.stamps);
+    free(rb->timestamp.hist);
+#endif
+    free(rb);
+}
+
+static int ecbb_cmp(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t ecbb_percentile(const uint64_t* sorted, uint64_t n, double q)
+{
+    return sorted[(uint64_t)(q * (double)(n - 1))];
+}
+
+static void ecbb_print_common(const ecbb_opts* o)
+{
+    if(o->json)
+        printf("{\"config\":\"%s\",\"mode\":\"%s\",\"api\":\"%s\",\"element_size\":%u,\"buffer_size\":%u,"
+               "\"count\":%llu,\"placement\":\"%s\",\"producer_cpu\":%d,\"consumer_cpu\":%d",
+               ECBB_CONFIG, ecbb_mode_names[o->mode], ecbb_api_names[o->api],
+               (unsigned int)o->element_size, (unsigned int)o->buffer_size, (unsigned long long)o->count,
+               o->placement, o->producer_cpu, o->consumer_cpu);
+    else
+        printf("%s,%s,%s,%u,%u,%llu,%s,%d,%d",
+               ECBB_CONFIG, ecbb_mode_names[o->mode], ecbb_api_names[o->api],
+               (unsigned int)o->element_size, (unsigned int)o->buffer_size, (unsigned long long)o->count,
+               o->placement, o->producer_cpu, o->consumer_cpu);
+}
+
+static void ecbb_report_throughput(const ecbb_opts* o, uint64_t ns)
+{
+    double ns_per_elem = (double)ns / (double)o->count;
+    double mops = 1e3 / ns_per_elem;
+    double mbps = mops * o->element_size;
+    ecbb_print_common(o);
+    if(o->json)
+        printf(",\"ns_per_elem\":%.3f,\"mops\":%.3f,\"mb_s\":%.1f}\n", ns_per_elem, mops, mbps);
+    else
+        printf(",%.3f,%.3f,%.1f,,,,,,\n", ns_per_elem, mops, mbps);
+}
+
+static void ecbb_report_latency(const ecbb_opts* o, uint64_t* samples)
+{
+    uint64_t n = o->count;
+    uint64_t hist[ECBB_HIST_BUCKETS] = {0};
+    double mean = 0;
+    for(uint64_t i = 0; i < n; i++)
+    {
+        unsigned int b = 0;
+        while(b < ECBB_HIST_BUCKETS - 1 && (samples[i] >> (b + 1)))
+            b++;
+        hist[b]++;
+        mean += (double)samples[i] / (double)n;
+    }
+    qsort(samples, n, sizeof(*samples), ecbb_cmp);
+
+    ecbb_print_common(o);
+    if(o->json)
+    {
+        printf(",\"rtt_min_ns\":%llu,\"rtt_mean_ns\":%.1f,\"rtt_p50_ns\":%llu,\"rtt_p99_ns\":%llu,"
+               "\"rtt_p999_ns\":%llu,\"rtt_max_ns\":%llu,\"rtt_log2_hist\":[",
+               (unsigned long long)samples[0], mean,
+               (unsigned long long)ecbb_percentile(samples, n, 0.5),
+               (unsigned long long)ecbb_percentile(samples, n, 0.99),
+               (unsigned long long)ecbb_percentile(samples, n, 0.999),
+               (unsigned long long)samples[n - 1]);
+        for(unsigned int b = 0; b < ECBB_HIST_BUCKETS; b++)
+            printf("%s%llu", b ? "," : "", (unsigned long long)hist[b]);
+        printf("]}\n");
+    }
+    else
+        printf(",,,,%llu,%.1f,%llu,%llu,%llu,%llu\n",
+               (unsigned long long)samples[0], mean,
+               (unsigned long long)ecbb_percentile(samples, n, 0.5),
+               (unsigned long long)ecbb_percentile(samples, n, 0.99),
+               (unsigned long long)ecbb_percentile(samples, n, 0.999),
+               (unsigned long long)samples[n - 1]);
+}
+
+static void ecbb_usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-m throughput|pingpong] [-a copy|bulk|direct] [-e element_size]\n"
+                    "       [-b buffer_size] [-n count] [-p producer_cpu] [-c consumer_cpu]\n"
+                    "       [-P placement] [-f csv|json] [-H]\n", name);
+    exit(EXIT_FAILURE);
+}
+
+static int ecbb_lookup(const char* const* names, int cnt, const char* arg, const char* name)
+{
+    for(int i = 0; i < cnt; i++)
+        if(!strcmp(names[i], arg))
+            return i;
+    ecbb_usage(name);
+    return -1;
+}
+
+int main(int argc, char *argv[])
+{
+    ecbb_opts o = {ECBB_THROUGHPUT, ECBB_COPY, 8, 4096, 1000000, -1, -1, "unpinned", false, false};
+    int opt;
+
+    while((opt = getopt(argc, argv, "m:a:e:b:n:p:c:P:f:H")) != -1)
+    {
+        switch(opt)
+        {
+        case 'm': o.mode = (ecbb_mode)ecbb_lookup(ecbb_mode_names, 2, optarg, argv[0]); break;
+        case 'a': o.api = (ecbb_api)ecbb_lookup(ecbb_api_names, 3, optarg, argv[0]); break;
+        case 'e': o.element_size = (ECB_UINT_T)strtoul(optarg, NULL, 0); break;
+        case 'b': o.buffer_size = (ECB_UINT_T)strtoul(optarg, NULL, 0); break;
+        case 'n': o.count = strtoull(optarg, NULL, 0); break;
+        case 'p': o.producer_cpu = atoi(optarg); break;
+        case 'c': o.consumer_cpu = atoi(optarg); break;
+        case 'P': o.placement = optarg; break;
+        case 'f': o.json = !strcmp(optarg, "json"); break;
+        case 'H': o.header = true; break;
+        default: ecbb_usage(argv[0]);
+        }
+    }
+#if !defined(ECB_DIRECT_ACCESS)
+    if(o.api == ECBB_DIRECT)
+    {
+        fprintf(stderr, "-a direct requires ECB_DIRECT_ACCESS!\n");
+        return EXIT_FAILURE;
+    }
+#endif
+    if(!o.count || !o.element_size || o.buffer_size % o.element_size || o.buffer_size < 2 * o.element_size)
+        ecbb_usage(argv[0]);
+
+    if(o.header && !o.json)
+        printf("config,mode,api,element_size,buffer_size,count,placement,producer_cpu,consumer_cpu,"
+               "ns_per_elem,mops,mb_s,rtt_min_ns,rtt_mean_ns,rtt_p50_ns,rtt_p99_ns,rtt_p999_ns,rtt_max_ns\n");
+
+    volatile bool start = false;
+    ecbb_thread t = {&o, {ecbb_new(&o), ecbb_new(&o)}, NULL, &start};
+    if(!t.rb[0] || !t.rb[1])
+        return EXIT_FAILURE;
+    if(o.mode == ECBB_PINGPONG && !(t.samples = malloc(o.count * sizeof(*t.samples))))
+        return EXIT_FAILURE;
+
+    pthread_t threads[2];
+    void* (*const funcs[2][2])(void*) = {{ecbb_producer, ecbb_consumer}, {ecbb_ping, ecbb_pong}};
+    for(int i = 0; i < 2; i++)
+    {
+        if(pthread_create(&threads[i], NULL, funcs[o.mode][i], &t))
+        {
+            fprintf(stderr, "Failed to spawn thread!\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Give both threads time to pin themselves before starting the clock
+    usleep(10000);
+    uint64_t t0 = ecbb_now_ns();
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    start = true;
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    uint64_t t1 = ecbb_now_ns();
+
+    if(o.mode == ECBB_THROUGHPUT)
+        ecbb_report_throughput(&o, t1 - t0);
+    else
+        ecbb_report_latency(&o, t.samples);
+
+    free(t.samples);
+    ecbb_delete(t.rb[0]);
+    ecbb_delete(t.rb[1]);
+    return EXIT_SUCCESS;
+}
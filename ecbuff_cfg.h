@@ -3,6 +3,8 @@
 
 /* Types used by ecbuff
  * ECB_ATOMIC_T has to be atomic.
+ * Buffers beyond 2 GiB need 64-bit indices, int64_t / INT64_MAX and
+ * uint64_t / UINT64_MAX, which are only atomic on 64-bit targets.
  */
 #include <signal.h>
 #include <stdint.h>
@@ -28,6 +30,15 @@
 //#define ECB_ELEM_ALIGN 4
 
 
+/* ECB_POW2
+ * Requires total_size and element_size to be powers of two. Indices are then
+ * wrapped by masking instead of an integer division and the full/empty state
+ * is told apart by an additional index bit, so every element of the buffer
+ * becomes usable. total_size is limited to (ECB_ATOMIC_MAX / 2 + 1).
+ */
+//#define ECB_POW2
+
+
 /* ECB_THREAD_SINGLE
  *
  * Disable multi-threading capabilities.
@@ -55,6 +66,106 @@
 #define ECB_THREAD_BARRIER
 
 
+/* ECB_THREAD_ATOMIC
+ *
+ * Declares wp and rp as C11 _Atomic and accesses them with acquire loads and
+ * release stores instead of surrounding each copy with standalone fences.
+ * On x86 this compiles to plain moves, on ARM the barriers are limited to
+ * the index accesses. Requires C11, alternative to ECB_THREAD_BARRIER.
+ */
+//#define ECB_THREAD_ATOMIC
+
+
+/* ECB_CACHE_PAD
+ *
+ * Places the producer's and the consumer's state on separate cache lines
+ * (ECB_CACHELINE bytes, defaulting to 64) to avoid false sharing between cores.
+ * Each side additionally keeps a private copy of the other side's index and only
+ * reloads the shared one once the buffer looks full or empty. Allocate ecbuff
+ * aligned to ECB_CACHELINE for full effect. Requires ECB_THREAD_MULTI.
+ */
+//#define ECB_CACHE_PAD
+//#define ECB_CACHELINE 64
+
+
+/* ECB_WAIT
+ *
+ * Adds blocking ecbuff_read_wait() and ecbuff_write_wait() with timeouts,
+ * implemented in ecbuff_wait.c. A waiting thread spins for ECB_WAIT_SPIN
+ * polls, then announces itself as parked and sleeps (futex on Linux, custom
+ * ECB_WAIT_PARK()/ECB_WAIT_WAKE()/ECB_WAIT_NOW_US() elsewhere). The peer only
+ * issues a wake-up after seeing that announcement, so reading and writing
+ * stay free of syscalls as long as nobody sleeps. This costs a full fence
+ * per publication. Requires ECB_THREAD_ATOMIC.
+ */
+//#define ECB_WAIT
+//#define ECB_WAIT_SPIN 256
+
+
+/* ECB_COPY
+ *
+ * Selects how elements are copied into and out of the buffer:
+ * ECB_COPY_MEMCPY  memcpy(), default unless ECB_THREAD_VOLATILE
+ * ECB_COPY_VBYTE   volatile, one byte at a time
+ * ECB_COPY_VWORD   volatile, word-wide where source and destination allow,
+ *                  default with ECB_THREAD_VOLATILE
+ * ECB_COPY_VLINE   as ECB_COPY_VWORD, but loads a cache line's worth of
+ *                  words ahead of storing them
+ * ECB_COPY_SIMD    SSE2/AVX2 picked at runtime on x86, NEON on ARM
+ * ECB_COPY_STREAM  as ECB_COPY_SIMD, but copies of ECB_COPY_STREAM_MIN bytes
+ *                  or more into the buffer use non-temporal stores. Suits
+ *                  large elements the producer won't touch again.
+ * The volatile engines keep the ordering ECB_THREAD_VOLATILE relies on and
+ * are the only ones permitted with it. ECB_COPY_SIMD and ECB_COPY_STREAM
+ * are implemented in ecbuff_copy.c.
+ */
+//#define ECB_COPY ECB_COPY_SIMD
+//#define ECB_COPY_STREAM_MIN 256
+
+
+/* ECB_MIRROR
+ *
+ * Adds ecbuff_new_mirror() (ecbuff_mirror.c, Linux) as an alternative to
+ * ecbuff_init(). It maps the element storage twice in a row using memfd, so
+ * data wrapping around the end of the buffer is still virtually contiguous.
+ * For such buffers ecbuff_write_n()/ecbuff_read_n() never split their copy
+ * and the span API hands out everything up to the used/unused amount rather
+ * than stopping at the wrap point. Buffers set up by ecbuff_init() keep
+ * working as before.
+ */
+//#define ECB_MIRROR
+
+
+/* ECB_STATS
+ *
+ * Counts writes, reads, drops, overwrites, writes finding the buffer full,
+ * reads finding it empty and the highest fill level. Producer counters live
+ * next to wp, consumer counters next to rp, so neither side dirties the
+ * other's cache line. ecbuff_stats_get() copies them from any thread.
+ * With ECB_CACHE_PAD the high-water mark is based on the producer's cached
+ * rp and may thus overestimate the actual peak. Costs nothing when undefined.
+ */
+//#define ECB_STATS
+
+
+/* ECB_TIMESTAMP
+ *
+ * Measures queueing latency. Once ecbuff_timestamp_init() attached a stamp
+ * array and an ehist (ehist.c), the producer stamps every
+ * ECB_TIMESTAMP_EVERY-th slot (a power of two) it publishes with
+ * ECB_TIMESTAMP_NOW(), and the consumer records the time each of those
+ * spent in the buffer into the histogram before releasing it. Defaults to
+ * CLOCK_MONOTONIC in nanoseconds, ECB_TIMESTAMP_TSC uses the x86 TSC in
+ * cycles instead. Costs a branch per operation while nothing is attached,
+ * and the clock is only read for operations covering a sampled slot.
+ * Nothing when undefined. The stamps and histogram are referenced by
+ * process-local pointers, so ecbuff_shm rejects this option. Requires C11.
+ */
+//#define ECB_TIMESTAMP
+//#define ECB_TIMESTAMP_EVERY 64
+//#define ECB_TIMESTAMP_TSC
+
+
 /* ECB_THREAD_VOLATILE ***WARNING: USE WITH CARE***
  *
  * Enabling ECB_THREAD_VOLATILE causes ecbuff to rely on the instruction re-ordering
@@ -113,6 +224,15 @@
  * ecbuff_read_dequeue() returns a pointer to the next elememt ready to be read.
  * ecbuff_read_free() frees the memory allocated by the element
  *
+ * Span variants ecbuff_write_alloc_span()/ecbuff_write_enqueue_n() and
+ * ecbuff_read_dequeue_span()/ecbuff_read_free_n() hand out and commit
+ * contiguous runs of elements up to the wrap point.
+ *
+ * Lookahead: ecbuff_peek() returns the i-th ready element and ecbuff_iter_*()
+ * walk all ready ones across the wrap point without consuming them. Decoders
+ * can thus inspect the next elements in place, then release a prefix with
+ * ecbuff_read_free_n().
+ *
  * This exposes the element's memory for direct access by peripherals or DMA,
  * enabling true zero-copy operation.
  */
@@ -0,0 +1,248 @@
+/* Copy engines for ecbuff, see ECB_COPY in ecbuff_cfg.h */
+
+#include "ecbuff.h"
+
+#if ECB_COPY == ECB_COPY_SIMD || ECB_COPY == ECB_COPY_STREAM
+
+#include <stdint.h>
+#include <string.h>
+
+/* ECB_COPY_STREAM_MIN
+ * Shortest copy written with non-temporal stores, anything below that is
+ * likely still cached by the time the consumer reads it.
+ */
+#if !defined(ECB_COPY_STREAM_MIN)
+#define ECB_COPY_STREAM_MIN 256
+#endif
+
+typedef void (*ecbuff_copy_fn)(void* const restrict dest, const void* const restrict src, const size_t len);
+
+#if (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))) && defined(__GNUC__)
+#include <immintrin.h>
+
+/* Copies 64 bytes per iteration, a remainder of 16 bytes or more is covered
+ * by a final overlapping 16 byte copy. */
+__attribute__((target("sse2")))
+static void ecbuff_copy_sse2(void* const restrict dest, const void* const restrict src, size_t len)
+{
+    char* d = dest;
+    const char* s = src;
+    if(len < 16)
+    {
+        memcpy(d, s, len);
+        return;
+    }
+    const char* end = s + len - 16;
+    char* dend = d + len - 16;
+    for(; len >= 64; len -= 64, d += 64, s += 64)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)s);
+        __m128i b = _mm_loadu_si128((const __m128i*)(s + 16));
+        __m128i c = _mm_loadu_si128((const __m128i*)(s + 32));
+        __m128i e = _mm_loadu_si128((const __m128i*)(s + 48));
+        _mm_storeu_si128((__m128i*)d, a);
+        _mm_storeu_si128((__m128i*)(d + 16), b);
+        _mm_storeu_si128((__m128i*)(d + 32), c);
+        _mm_storeu_si128((__m128i*)(d + 48), e);
+    }
+    for(; len >= 16; len -= 16, d += 16, s += 16)
+        _mm_storeu_si128((__m128i*)d, _mm_loadu_si128((const __m128i*)s));
+    if(len)
+        _mm_storeu_si128((__m128i*)dend, _mm_loadu_si128((const __m128i*)end));
+}
+
+__attribute__((target("avx2")))
+static void ecbuff_copy_avx2(void* const restrict dest, const void* const restrict src, size_t len)
+{
+    char* d = dest;
+    const char* s = src;
+    if(len < 32)
+    {
+        ecbuff_copy_sse2(d, s, len);
+        return;
+    }
+    const char* end = s + len - 32;
+    char* dend = d + len - 32;
+    for(; len >= 128; len -= 128, d += 128, s += 128)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i*)s);
+        __m256i b = _mm256_loadu_si256((const __m256i*)(s + 32));
+        __m256i c = _mm256_loadu_si256((const __m256i*)(s + 64));
+        __m256i e = _mm256_loadu_si256((const __m256i*)(s + 96));
+        _mm256_storeu_si256((__m256i*)d, a);
+        _mm256_storeu_si256((__m256i*)(d + 32), b);
+        _mm256_storeu_si256((__m256i*)(d + 64), c);
+        _mm256_storeu_si256((__m256i*)(d + 96), e);
+    }
+    for(; len >= 32; len -= 32, d += 32, s += 32)
+        _mm256_storeu_si256((__m256i*)d, _mm256_loadu_si256((const __m256i*)s));
+    if(len)
+        _mm256_storeu_si256((__m256i*)dend, _mm256_loadu_si256((const __m256i*)end));
+}
+
+/* Streams 16 byte aligned blocks, the unaligned head and the tail take
+ * regular stores. The fence orders the streaming stores before publication. */
+__attribute__((target("sse2")))
+static void ecbuff_copy_stream_simd(void* const restrict dest, const void* const restrict src, size_t len)
+{
+    char* d = dest;
+    const char* s = src;
+    size_t head = (16 - (uintptr_t)d % 16) % 16;
+    if(len < ECB_COPY_STREAM_MIN || len < head + 64)
+    {
+        ecbuff_copy(d, s, len);
+        return;
+    }
+    ecbuff_copy(d, s, head);
+    d += head;
+    s += head;
+    len -= head;
+    for(; len >= 64; len -= 64, d += 64, s += 64)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)s);
+        __m128i b = _mm_loadu_si128((const __m128i*)(s + 16));
+        __m128i c = _mm_loadu_si128((const __m128i*)(s + 32));
+        __m128i e = _mm_loadu_si128((const __m128i*)(s + 48));
+        _mm_stream_si128((__m128i*)d, a);
+        _mm_stream_si128((__m128i*)(d + 16), b);
+        _mm_stream_si128((__m128i*)(d + 32), c);
+        _mm_stream_si128((__m128i*)(d + 48), e);
+    }
+    for(; len >= 16; len -= 16, d += 16, s += 16)
+        _mm_stream_si128((__m128i*)d, _mm_loadu_si128((const __m128i*)s));
+    _mm_sfence();
+    ecbuff_copy(d, s, len);
+}
+
+static ecbuff_copy_fn ecbuff_copy_select(const char** const restrict name)
+{
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+    {
+        *name = "avx2";
+        return ecbuff_copy_avx2;
+    }
+    *name = "sse2";
+    return ecbuff_copy_sse2;
+}
+#define ECB_COPY_DISPATCH
+
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+
+static void ecbuff_copy_neon(void* const restrict dest, const void* const restrict src, size_t len)
+{
+    uint8_t* d = dest;
+    const uint8_t* s = src;
+    if(len < 16)
+    {
+        memcpy(d, s, len);
+        return;
+    }
+    const uint8_t* end = s + len - 16;
+    uint8_t* dend = d + len - 16;
+    for(; len >= 64; len -= 64, d += 64, s += 64)
+    {
+        uint8x16_t a = vld1q_u8(s);
+        uint8x16_t b = vld1q_u8(s + 16);
+        uint8x16_t c = vld1q_u8(s + 32);
+        uint8x16_t e = vld1q_u8(s + 48);
+        vst1q_u8(d, a);
+        vst1q_u8(d + 16, b);
+        vst1q_u8(d + 32, c);
+        vst1q_u8(d + 48, e);
+    }
+    for(; len >= 16; len -= 16, d += 16, s += 16)
+        vst1q_u8(d, vld1q_u8(s));
+    if(len)
+        vst1q_u8(dend, vld1q_u8(end));
+}
+
+void ecbuff_copy(void* const restrict dest, const void* const restrict src, const size_t len)
+{
+    ecbuff_copy_neon(dest, src, len);
+}
+
+const char* ecbuff_copy_name(void)
+{
+    return "neon";
+}
+
+#if defined(__aarch64__)
+/* STNP hints the stored pairs won't be reused, they're still ordered by
+ * the release (or barrier) publishing the index. */
+static void ecbuff_copy_stream_simd(void* const restrict dest, const void* const restrict src, size_t len)
+{
+    uint8_t* d = dest;
+    const uint8_t* s = src;
+    if(len < ECB_COPY_STREAM_MIN)
+    {
+        ecbuff_copy_neon(d, s, len);
+        return;
+    }
+    for(; len >= 64; len -= 64, d += 64, s += 64)
+    {
+        uint8x16_t a = vld1q_u8(s);
+        uint8x16_t b = vld1q_u8(s + 16);
+        uint8x16_t c = vld1q_u8(s + 32);
+        uint8x16_t e = vld1q_u8(s + 48);
+        __asm__ __volatile__("stnp %q0, %q1, [%2]" : : "w"(a), "w"(b), "r"(d) : "memory");
+        __asm__ __volatile__("stnp %q0, %q1, [%2, #32]" : : "w"(c), "w"(e), "r"(d) : "memory");
+    }
+    ecbuff_copy_neon(d, s, len);
+}
+#else
+#define ecbuff_copy_stream_simd ecbuff_copy_neon
+#endif
+
+#else
+/* No SIMD variant for this architecture */
+void ecbuff_copy(void* const restrict dest, const void* const restrict src, const size_t len)
+{
+    memcpy(dest, src, len);
+}
+
+const char* ecbuff_copy_name(void)
+{
+    return "memcpy";
+}
+
+#define ecbuff_copy_stream_simd ecbuff_copy
+#endif
+
+#if defined(ECB_COPY_DISPATCH)
+/* Resolved on first use, racing threads store the same result */
+static ecbuff_copy_fn ecbuff_copy_impl;
+static const char* ecbuff_copy_impl_name;
+
+static ecbuff_copy_fn ecbuff_copy_get(void)
+{
+    ecbuff_copy_fn fn = __atomic_load_n(&ecbuff_copy_impl, __ATOMIC_ACQUIRE);
+    if(!fn)
+    {
+        const char* name;
+        fn = ecbuff_copy_select(&name);
+        __atomic_store_n(&ecbuff_copy_impl_name, name, __ATOMIC_RELAXED);
+        __atomic_store_n(&ecbuff_copy_impl, fn, __ATOMIC_RELEASE);
+    }
+    return fn;
+}
+
+void ecbuff_copy(void* const restrict dest, const void* const restrict src, const size_t len)
+{
+    ecbuff_copy_get()(dest, src, len);
+}
+
+const char* ecbuff_copy_name(void)
+{
+    ecbuff_copy_get();
+    return __atomic_load_n(&ecbuff_copy_impl_name, __ATOMIC_RELAXED);
+}
+#endif
+
+void ecbuff_copy_stream(void* const restrict dest, const void* const restrict src, const size_t len)
+{
+    ecbuff_copy_stream_simd(dest, src, len);
+}
+
+#endif /* ECB_COPY_SIMD || ECB_COPY_STREAM */
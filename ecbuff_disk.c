@@ -0,0 +1,339 @@
+/* See ecbuff_disk.h for further information */
+
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // O_DIRECT
+#endif
+
+#include "ecbuff_disk.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(ECB_ASSERT)
+#include <assert.h>
+
+#if !defined(ASSERT)
+//use standard assert() if nothing custom was defined
+#define ASSERT(x) assert(x)
+#endif
+
+#else
+#define NDEBUG
+#undef ASSERT	//ignore earlier definition from ecbuff_cfg.h
+#define ASSERT(x)
+#endif
+
+#if !defined(ECB_THREAD_MULTI)
+#error ecbuff_disk requires ECB_THREAD_MULTI!
+#endif
+
+static inline size_t ecbuff_disk_align(const size_t len)
+{
+    return (len + ECB_DISK_ALIGN - 1) / ECB_DISK_ALIGN * ECB_DISK_ALIGN;
+}
+
+/* Returns 0 or an errno value */
+static int ecbuff_disk_pwrite(const int fd, const char* buf, size_t len, uint64_t offset)
+{
+    while(len)
+    {
+        ssize_t ret = pwrite(fd, buf, len, (off_t)offset);
+        if(ret < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            return errno;
+        }
+        buf += ret;
+        len -= (size_t)ret;
+        offset += (uint64_t)ret;
+    }
+    return 0;
+}
+
+/* Writes whatever buffer the drain thread hands over, until told to exit */
+static void* ecbuff_disk_writer(void* arg)
+{
+    ecbuff_disk_recorder* rec = arg;
+    pthread_mutex_lock(&rec->lock);
+    for(;;)
+    {
+        while(rec->pending < 0 && !rec->writer_exit)
+            pthread_cond_wait(&rec->cond, &rec->lock);
+        if(rec->pending < 0)
+            break;
+        const char* buf = rec->buf[rec->pending];
+        size_t len = rec->pending_len;
+        uint64_t offset = rec->offset;
+        bool failed = rec->error;
+        pthread_mutex_unlock(&rec->lock);
+
+        int error = failed ? 0 : ecbuff_disk_pwrite(rec->fd, buf, len, offset);
+
+        pthread_mutex_lock(&rec->lock);
+        if(error)
+            rec->error = error;
+        rec->offset += len;
+        rec->pending = -1;
+        pthread_cond_broadcast(&rec->cond);
+    }
+    pthread_mutex_unlock(&rec->lock);
+    return NULL;
+}
+
+/* Waits until the writer is idle, then hands it len bytes of buffer buf */
+static void ecbuff_disk_handoff(ecbuff_disk_recorder* const restrict rec, const int buf, const size_t len)
+{
+    pthread_mutex_lock(&rec->lock);
+    while(rec->pending >= 0)
+        pthread_cond_wait(&rec->cond, &rec->lock);
+    if(len)
+    {
+        rec->pending = buf;
+        rec->pending_len = len;
+        pthread_cond_broadcast(&rec->cond);
+    }
+    pthread_mutex_unlock(&rec->lock);
+}
+
+/* Consumer of the ring. Fills the current buffer up to chunk_size and past
+ * it by less than an element, that remainder starts the next buffer. */
+static void* ecbuff_disk_drain(void* arg)
+{
+    ecbuff_disk_recorder* rec = arg;
+    ecbuff* rb = rec->rb;
+    size_t element_size = rb->element_size;
+    size_t chunk = rec->chunk_size;
+    const struct timespec poll = {0, ECB_DISK_POLL_US * 1000L};
+    uint64_t recorded = 0;
+    size_t fill = 0;
+    int cur = 0;
+
+    for(;;)
+    {
+        /* Loaded before the ring, so nothing written ahead of stopping is missed */
+        bool stop = atomic_load_explicit(&rec->stop, memory_order_acquire);
+        ECB_UINT_T n = ecbuff_used(rb);
+        if(!n)
+        {
+            if(stop)
+                break;
+            nanosleep(&poll, NULL);
+            continue;
+        }
+        ECB_UINT_T room = (ECB_UINT_T)((chunk - fill + element_size - 1) / element_size);
+        if(n > room)
+            n = room;
+        ecbuff_read_n(rb, rec->buf[cur] + fill, n);
+        fill += n * element_size;
+
+        if(fill >= chunk)
+        {
+            /* Waits for the writer to finish the other buffer, which is then free */
+            ecbuff_disk_handoff(rec, cur, chunk);
+            fill -= chunk;
+            memcpy(rec->buf[cur ^ 1], rec->buf[cur] + chunk, fill);
+            recorded += chunk;
+            cur ^= 1;
+        }
+    }
+
+    /* O_DIRECT needs aligned sizes, the padding is truncated later on */
+    if(fill)
+    {
+        size_t len = rec->direct ? ecbuff_disk_align(fill) : fill;
+        memset(rec->buf[cur] + fill, 0, len - fill);
+        ecbuff_disk_handoff(rec, cur, len);
+        recorded += fill;
+    }
+    ecbuff_disk_handoff(rec, cur, 0);
+
+    pthread_mutex_lock(&rec->lock);
+    rec->recorded = recorded;
+    rec->writer_exit = true;
+    pthread_cond_broadcast(&rec->cond);
+    pthread_mutex_unlock(&rec->lock);
+    return NULL;
+}
+
+int ecbuff_disk_record_start(ecbuff_disk_recorder* const restrict rec, ecbuff* const restrict rb,
+                             const char* const restrict path, const size_t chunk_size)
+{
+    ASSERT(rec);
+    ASSERT(rb);
+    ASSERT(path);
+    int error;
+    rec->rb = rb;
+    rec->chunk_size = ecbuff_disk_align(chunk_size ? chunk_size : ECB_DISK_CHUNK);
+    rec->pending = -1;
+    rec->pending_len = 0;
+    rec->writer_exit = false;
+    rec->error = 0;
+    rec->offset = 0;
+    rec->recorded = 0;
+    atomic_init(&rec->stop, false);
+
+    rec->direct = false;
+#if defined(O_DIRECT)
+    rec->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    rec->direct = rec->fd >= 0;
+    /* Not every file system supports O_DIRECT */
+    if(rec->fd < 0 && errno == EINVAL)
+#endif
+        rec->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(rec->fd < 0)
+        return errno;
+
+    /* Room for the chunk plus the remainder of an element crossing its end */
+    size_t size = ecbuff_disk_align(rec->chunk_size + rb->element_size);
+    rec->buf[0] = rec->buf[1] = NULL;
+    if((error = posix_memalign((void**)&rec->buf[0], ECB_DISK_ALIGN, size)) ||
+       (error = posix_memalign((void**)&rec->buf[1], ECB_DISK_ALIGN, size)))
+        goto fail_buf;
+    if((error = pthread_mutex_init(&rec->lock, NULL)))
+        goto fail_buf;
+    if((error = pthread_cond_init(&rec->cond, NULL)))
+        goto fail_mutex;
+    if((error = pthread_create(&rec->write_thread, NULL, ecbuff_disk_writer, rec)))
+        goto fail_cond;
+    if((error = pthread_create(&rec->drain_thread, NULL, ecbuff_disk_drain, rec)))
+    {
+        pthread_mutex_lock(&rec->lock);
+        rec->writer_exit = true;
+        pthread_cond_broadcast(&rec->cond);
+        pthread_mutex_unlock(&rec->lock);
+        pthread_join(rec->write_thread, NULL);
+        goto fail_cond;
+    }
+    return 0;
+
+fail_cond:
+    pthread_cond_destroy(&rec->cond);
+fail_mutex:
+    pthread_mutex_destroy(&rec->lock);
+fail_buf:
+    free(rec->buf[0]);
+    free(rec->buf[1]);
+    close(rec->fd);
+    return error;
+}
+
+int ecbuff_disk_record_stop(ecbuff_disk_recorder* const restrict rec)
+{
+    ASSERT(rec);
+    atomic_store_explicit(&rec->stop, true, memory_order_release);
+    pthread_join(rec->drain_thread, NULL);
+    pthread_join(rec->write_thread, NULL);
+
+    int error = rec->error;
+    if(ftruncate(rec->fd, (off_t)rec->recorded) && !error)
+        error = errno;
+    if(close(rec->fd) && !error)
+        error = errno;
+    pthread_cond_destroy(&rec->cond);
+    pthread_mutex_destroy(&rec->lock);
+    free(rec->buf[0]);
+    free(rec->buf[1]);
+    return error;
+}
+
+/* Number of elements due after the time passed since start */
+static uint64_t ecbuff_disk_due(const struct timespec* const restrict start, const uint64_t rate)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t ns = (uint64_t)(now.tv_sec - start->tv_sec) * 1000000000u + (uint64_t)now.tv_nsec - (uint64_t)start->tv_nsec;
+    return ns / 1000000000u * rate + ns % 1000000000u * rate / 1000000000u;
+}
+
+/* Sleeps until element number seq is due */
+static void ecbuff_disk_sleep(const struct timespec* const restrict start, const uint64_t rate, const uint64_t seq)
+{
+    uint64_t ns = start->tv_nsec + seq % rate * 1000000000u / rate;
+    struct timespec until = {start->tv_sec + (time_t)(seq / rate + ns / 1000000000u), (long)(ns % 1000000000u)};
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) == EINTR)
+        ;
+}
+
+int64_t ecbuff_disk_replay(ecbuff* const restrict rb, const char* const restrict path, const uint64_t rate,
+                           const atomic_bool* const stop)
+{
+    ASSERT(rb);
+    ASSERT(path);
+    size_t element_size = rb->element_size;
+    size_t size = ECB_DISK_CHUNK > element_size ? ECB_DISK_CHUNK / element_size * element_size : element_size;
+    char* buf = malloc(size);
+    if(!buf)
+        return -1;
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        free(buf);
+        return -1;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint64_t written = 0;
+    size_t fill = 0;
+    int error = 0;
+    for(;;)
+    {
+        ssize_t ret = read(fd, buf + fill, size - fill);
+        if(ret < 0 && errno == EINTR)
+            continue;
+        if(ret <= 0)
+        {
+            if(ret < 0)
+                error = errno;
+            break;
+        }
+        fill += (size_t)ret;
+
+        const char* src = buf;
+        for(size_t n = fill / element_size; n;)
+        {
+            if(stop && atomic_load_explicit(stop, memory_order_relaxed))
+                goto done;
+            ECB_UINT_T batch = ecbuff_unused(rb);
+            if(batch > n)
+                batch = (ECB_UINT_T)n;
+            if(rate)
+            {
+                uint64_t due = ecbuff_disk_due(&start, rate);
+                if(due <= written)
+                {
+                    ecbuff_disk_sleep(&start, rate, written + 1);
+                    continue;
+                }
+                if(batch > due - written)
+                    batch = (ECB_UINT_T)(due - written);
+            }
+            if(!batch)
+            {
+                sched_yield();
+                continue;
+            }
+            ecbuff_write_n(rb, src, batch);
+            src += batch * element_size;
+            n -= batch;
+            written += batch;
+        }
+        fill -= (size_t)(src - buf);
+        memmove(buf, src, fill);
+    }
+
+done:
+    close(fd);
+    free(buf);
+    if(error)
+    {
+        errno = error;
+        return -1;
+    }
+    return (int64_t)written;
+}
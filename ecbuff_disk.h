@@ -0,0 +1,98 @@
+/*
+ * ecbuff_disk records the contents of an ecbuff to a file and replays such
+ * a file into an ecbuff, e.g. to capture raw sample streams and later feed
+ * them to decoders under test.
+ *
+ * The recorder takes the consumer side of the ring. Its drain thread copies
+ * elements into one of two page-aligned chunk buffers while a writer thread
+ * stores the other one with a single pwrite(). The file is opened with
+ * O_DIRECT where supported, bypassing the page cache. A disk stall thus only
+ * holds back the drain thread once both buffers are taken, from then on the
+ * ring's slack absorbs it. The producer never blocks on I/O.
+ *
+ * Replay takes the producer side instead and writes the file's elements at
+ * a given rate, or as fast as the consumer keeps up.
+ *
+ * Requires ECB_THREAD_MULTI, pthreads and POSIX.
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#ifndef ECBUFF_DISK_H
+#define ECBUFF_DISK_H
+
+#include "ecbuff.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* ECB_DISK_ALIGN
+ * Alignment of buffers, file offsets and write sizes, has to satisfy the
+ * file system's O_DIRECT requirements.
+ */
+#if !defined(ECB_DISK_ALIGN)
+#define ECB_DISK_ALIGN 4096
+#endif
+
+/* ECB_DISK_CHUNK
+ * Default number of bytes per write, and per read during replay.
+ */
+#if !defined(ECB_DISK_CHUNK)
+#define ECB_DISK_CHUNK (1024 * 1024)
+#endif
+
+/* ECB_DISK_POLL_US
+ * Time the drain thread sleeps whenever it finds the ring empty.
+ */
+#if !defined(ECB_DISK_POLL_US)
+#define ECB_DISK_POLL_US 100
+#endif
+
+typedef struct {
+    ecbuff* rb;
+    int fd;
+    bool direct;                                /* file was opened with O_DIRECT */
+    size_t chunk_size;
+    char* buf[2];                               /* chunk buffers, written alternately */
+    pthread_t drain_thread;
+    pthread_t write_thread;
+    pthread_mutex_t lock;                       /* guards the members below */
+    pthread_cond_t cond;
+    int pending;                                /* buffer handed to the writer, -1 if none */
+    size_t pending_len;
+    bool writer_exit;
+    int error;                                  /* first errno reported by the writer, 0 if none */
+    uint64_t offset;                            /* file offset of the next chunk */
+    uint64_t recorded;                          /* bytes recorded, set by the drain thread on exit */
+    atomic_bool stop;
+} ecbuff_disk_recorder;
+
+/* ecbuff_disk_record_start
+ * Creates (or truncates) the file at path and starts recording rb, whose
+ * consumer side belongs to the recorder until ecbuff_disk_record_stop().
+ * chunk_size is rounded up to a multiple of ECB_DISK_ALIGN, 0 selects
+ * ECB_DISK_CHUNK. Returns 0 or an errno value.
+ */
+int ecbuff_disk_record_start(ecbuff_disk_recorder* const restrict rec, ecbuff* const restrict rb,
+                             const char* const restrict path, const size_t chunk_size);
+
+/* ecbuff_disk_record_stop
+ * Records the elements still in the ring, writes the last partial chunk and
+ * closes the file, which then holds every recorded element back-to-back.
+ * Returns 0 or the errno value of the first failed write. Elements drained
+ * after a failure are discarded, so the producer keeps going.
+ */
+int ecbuff_disk_record_stop(ecbuff_disk_recorder* const restrict rec);
+
+/* ecbuff_disk_replay
+ * Writes the elements of the file at path into rb, at most rate elements
+ * per second or as fast as possible if rate is 0. Yields while the ring is
+ * full. Returns early once *stop (if given) becomes true. A trailing
+ * partial element is ignored. Returns the number of elements written or -1
+ * with errno set.
+ */
+int64_t ecbuff_disk_replay(ecbuff* const restrict rb, const char* const restrict path, const uint64_t rate,
+                           const atomic_bool* const stop);
+
+#endif // ECBUFF_DISK_H
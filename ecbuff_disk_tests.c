@@ -0,0 +1,195 @@
+/*
+ * Tests for ecbuff_disk
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#if !defined(_GNU_SOURCE) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "ecbuff_disk.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#if defined(ECB_POW2)
+#define ECBT_ELEM_CNT (ECBT_BUFF_SIZ / ECBT_ELEM_SIZ)
+#else
+#define ECBT_ELEM_CNT ((ECBT_BUFF_SIZ / ECBT_ELEM_SIZ) - 1)
+#endif
+
+/* Leaves a partial last chunk, limited to a few MiB of disk space */
+#define ECBDT_COUNT_MAX ((1 << 22) / ECBT_ELEM_SIZ + 7)
+#define ECBDT_COUNT (ECBT_ELEM_CNT * 1000 + 7 < ECBDT_COUNT_MAX ? ECBT_ELEM_CNT * 1000 + 7 : ECBDT_COUNT_MAX)
+#define ECBDT_CHUNK (2 * ECB_DISK_ALIGN)
+#define ECBDT_RATE 20000      /* elements per second, ECBDT_RATE / 20 <= ECBDT_COUNT */
+
+typedef struct {
+    ecbuff* rb;
+    uint32_t count;
+    atomic_bool* stop;
+} ecbdt_thread;
+
+static char ecbdt_path[64];
+
+ecbuff* ecbdt_new(void);
+void ecbdt_delete(ecbuff* rb);
+void ecbdt_value(uint8_t* value, uint32_t seq);
+void ecbdt_test_record(void);
+void ecbdt_test_replay(uint64_t rate, uint32_t count);
+void* ecbdt_sink(void* arg);
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    snprintf(ecbdt_path, sizeof(ecbdt_path), "/tmp/ecbuff_disk_test_%ld.bin", (long)getpid());
+    ecbdt_test_record();
+    ecbdt_test_replay(0, ECBDT_COUNT);
+    ecbdt_test_replay(ECBDT_RATE, ECBDT_RATE / 20);
+    unlink(ecbdt_path);
+    return 0;
+}
+
+ecbuff* ecbdt_new(void)
+{
+    ecbuff* rb = malloc(sizeof(ecbuff) + ECBT_BUFF_SIZ);
+    assert(rb);
+    ecbuff_init(rb, ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+    return rb;
+}
+
+void ecbdt_delete(ecbuff* rb)
+{
+    assert(rb);
+    free(rb);
+}
+
+void ecbdt_value(uint8_t* value, uint32_t seq)
+{
+    memset(value, (uint8_t)(seq * 7 + 1), ECBT_ELEM_SIZ);
+    memcpy(value, &seq, ECBT_ELEM_SIZ < sizeof(seq) ? ECBT_ELEM_SIZ : sizeof(seq));
+}
+
+/* Records ECBDT_COUNT elements and checks the file holds exactly those */
+void ecbdt_test_record(void)
+{
+    ecbuff* rb = ecbdt_new();
+    ecbuff_disk_recorder rec;
+    int ret = ecbuff_disk_record_start(&rec, rb, ecbdt_path, ECBDT_CHUNK - 1);
+    assert(!ret);
+    assert(rec.chunk_size == ECBDT_CHUNK);
+
+    uint8_t value[ECBT_ELEM_SIZ];
+    for(uint32_t seq = 0; seq < ECBDT_COUNT; seq++)
+    {
+        ecbdt_value(value, seq);
+        while(ecbuff_is_full(rb))
+            sched_yield();
+        ecbuff_write(rb, value);
+    }
+    ret = ecbuff_disk_record_stop(&rec);
+    assert(!ret);
+    assert(ecbuff_is_empty(rb));
+
+    struct stat st;
+    ret = stat(ecbdt_path, &st);
+    assert(!ret);
+    assert(st.st_size == (off_t)ECBDT_COUNT * ECBT_ELEM_SIZ);
+    FILE* file = fopen(ecbdt_path, "rb");
+    assert(file);
+    for(uint32_t seq = 0; seq < ECBDT_COUNT; seq++)
+    {
+        uint8_t expected[ECBT_ELEM_SIZ];
+        ecbdt_value(expected, seq);
+        if(fread(value, ECBT_ELEM_SIZ, 1, file) != 1 || memcmp(value, expected, ECBT_ELEM_SIZ))
+        {
+            printf("Recorded unexpected value! (element %u)\n", seq);
+            assert(false);
+        }
+    }
+    fclose(file);
+
+    /* Recording nothing leaves an empty file */
+    char empty[sizeof(ecbdt_path) + 6];
+    snprintf(empty, sizeof(empty), "%s.empty", ecbdt_path);
+    ret = ecbuff_disk_record_start(&rec, rb, empty, 0);
+    assert(!ret && rec.chunk_size == ECB_DISK_CHUNK);
+    assert(!ecbuff_disk_record_stop(&rec));
+    assert(!stat(empty, &st) && st.st_size == 0);
+    unlink(empty);
+    assert(ecbuff_disk_record_start(&rec, rb, "/nonexistent/ecbuff", 0) == ENOENT);
+    ecbdt_delete(rb);
+}
+
+/* Replays the recording, stopping after count elements, and checks them */
+void ecbdt_test_replay(uint64_t rate, uint32_t count)
+{
+    ecbuff* rb = ecbdt_new();
+    atomic_bool stop;
+    atomic_init(&stop, false);
+    ecbdt_thread sink = {rb, count, &stop};
+
+    pthread_t thread;
+    if(pthread_create(&thread, NULL, ecbdt_sink, &sink))
+    {
+        printf("Failed to spawn thread!\n");
+        assert(false);
+        return;
+    }
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int64_t ret = ecbuff_disk_replay(rb, ecbdt_path, rate, count < ECBDT_COUNT ? &stop : NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    pthread_join(thread, NULL);
+
+    if(count < ECBDT_COUNT)
+    {
+        /* Stopped by the sink, at most a ring's worth beyond count */
+        assert(ret >= count && ret <= (int64_t)count + ECBT_ELEM_CNT + 1);
+    }
+    else
+        assert(ret == ECBDT_COUNT);
+    if(rate)
+    {
+        double elapsed = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+        if(elapsed < (double)(count - 1) / (double)rate)
+        {
+            printf("Replay too fast! (%u elements in %f s)\n", count, elapsed);
+            assert(false);
+        }
+    }
+    assert(ecbuff_disk_replay(rb, "/nonexistent/ecbuff", 0, NULL) == -1 && errno == ENOENT);
+    ecbdt_delete(rb);
+}
+
+/* Checks count elements, then stops the replay */
+void* ecbdt_sink(void* arg)
+{
+    ecbdt_thread* t = arg;
+    uint8_t value[ECBT_ELEM_SIZ];
+    uint8_t expected[ECBT_ELEM_SIZ];
+    for(uint32_t seq = 0; seq < t->count; seq++)
+    {
+        while(ecbuff_is_empty(t->rb))
+            sched_yield();
+        ecbuff_read(t->rb, value);
+        ecbdt_value(expected, seq);
+        if(memcmp(value, expected, ECBT_ELEM_SIZ))
+        {
+            printf("Replayed unexpected value! (element %u)\n", seq);
+            assert(false);
+        }
+    }
+    atomic_store(t->stop, true);
+    pthread_exit((void*)true);
+}
@@ -0,0 +1,105 @@
+/* See ecbuff_event.h for further information */
+
+#include "ecbuff_event.h"
+#include <errno.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#if defined(ECB_ASSERT)
+#include <assert.h>
+
+#if !defined(ASSERT)
+//use standard assert() if nothing custom was defined
+#define ASSERT(x) assert(x)
+#endif
+
+#else
+#define NDEBUG
+#undef ASSERT	//ignore earlier definition from ecbuff_cfg.h
+#define ASSERT(x)
+#endif
+
+#if !defined(ECB_THREAD_MULTI)
+#error ecbuff_event requires ECB_THREAD_MULTI!
+#endif
+
+int ecbuff_event_init(ecbuff_event* const restrict ev, ecbuff* const restrict rb)
+{
+    ASSERT(ev);
+    ASSERT(rb);
+    ev->rb = rb;
+    ev->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(ev->fd < 0)
+        return errno;
+    atomic_init(&ev->armed, 1);
+    return 0;
+}
+
+void ecbuff_event_close(ecbuff_event* const restrict ev)
+{
+    ASSERT(ev);
+    close(ev->fd);
+    ev->fd = -1;
+}
+
+void ecbuff_event_notify(ecbuff_event* const restrict ev)
+{
+    ASSERT(ev);
+    /* Orders publishing the ring before checking armed, pairs with the
+     * fence in ecbuff_event_drained() */
+    atomic_thread_fence(memory_order_seq_cst);
+    if(!atomic_load_explicit(&ev->armed, memory_order_relaxed) ||
+       !atomic_exchange_explicit(&ev->armed, 0, memory_order_relaxed))
+        return;
+    uint64_t one = 1;
+    /* Fails only if the counter would overflow, it's reset long before */
+    while(write(ev->fd, &one, sizeof(one)) < 0 && errno == EINTR)
+        ;
+}
+
+ECB_VOID_BOOL_T ecbuff_event_write(ecbuff_event* const restrict ev, const void* const restrict element)
+{
+    ASSERT(ev);
+#if defined(ECB_EXTRA_CHECKS)
+    bool ret = ecbuff_write(ev->rb, element);
+    ecbuff_event_notify(ev);
+    return ret;
+#else
+    ecbuff_write(ev->rb, element);
+    ecbuff_event_notify(ev);
+#endif
+}
+
+ECB_UINT_T ecbuff_event_write_n(ecbuff_event* const restrict ev, const void* const restrict elements, const ECB_UINT_T n)
+{
+    ASSERT(ev);
+    ECB_UINT_T ret = ecbuff_write_n(ev->rb, elements, n);
+    if(ret)
+        ecbuff_event_notify(ev);
+    return ret;
+}
+
+bool ecbuff_event_drained(ecbuff_event* const restrict ev)
+{
+    ASSERT(ev);
+    if(!ecbuff_is_empty(ev->rb))
+        return false;
+    /* Disarmed means the producer signalled, reset the eventfd */
+    if(!atomic_load_explicit(&ev->armed, memory_order_relaxed))
+    {
+        uint64_t count;
+        while(read(ev->fd, &count, sizeof(count)) < 0 && errno == EINTR)
+            ;
+        atomic_store_explicit(&ev->armed, 1, memory_order_relaxed);
+    }
+    /* Pairs with the fence in ecbuff_event_notify(), either the producer
+     * sees the notifier armed or its elements are seen here */
+    atomic_thread_fence(memory_order_seq_cst);
+    if(ecbuff_is_empty(ev->rb))
+        return true;
+    /* Elements arrived meanwhile. If the producer didn't disarm yet, do
+     * so to save it the syscall, otherwise the eventfd is readable again. */
+    atomic_exchange_explicit(&ev->armed, 0, memory_order_relaxed);
+    return false;
+}
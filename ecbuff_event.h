@@ -0,0 +1,59 @@
+/*
+ * ecbuff_event pairs an ecbuff with an eventfd, so its consumer can live in
+ * an epoll (poll, select) event loop next to sockets and timers. The
+ * producer signals the eventfd only while the consumer has armed it, which
+ * it does once it has drained the ring. A burst thus costs one syscall on
+ * either side rather than one per element, and none at all while the
+ * consumer is busy anyway.
+ *
+ * Consumer loop: wait for the eventfd to become readable, read elements
+ * until the ring is empty, then call ecbuff_event_drained(). It re-arms the
+ * notifier and returns true, or false if elements arrived meanwhile, which
+ * are to be read before calling it again. The eventfd is reset inside
+ * ecbuff_event_drained(), there's no need to read it.
+ *
+ * Arming and publishing are each followed by a full fence before checking
+ * the other side, so either the producer sees the notifier armed or the
+ * consumer sees the new elements. At most a single spurious wake-up results.
+ *
+ * Requires ECB_THREAD_MULTI, C11 atomics and Linux.
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#ifndef ECBUFF_EVENT_H
+#define ECBUFF_EVENT_H
+
+#include "ecbuff.h"
+#include <stdatomic.h>
+
+typedef struct {
+    ecbuff* rb;
+    int fd;                                     /* eventfd, non-blocking */
+    atomic_uint armed;                          /* set by the consumer, cleared by the producer signalling */
+} ecbuff_event;
+
+/* ecbuff_event_init / ecbuff_event_close
+ * Creates the eventfd for rb, returns 0 or an errno value. The notifier
+ * starts out armed. Add ev->fd to the event loop for reading.
+ */
+int ecbuff_event_init(ecbuff_event* const restrict ev, ecbuff* const restrict rb);
+void ecbuff_event_close(ecbuff_event* const restrict ev);
+
+/* ecbuff_event_notify
+ * Called by the producer after it published one or more elements through
+ * any of the ecbuff write functions. ecbuff_event_write() and
+ * ecbuff_event_write_n() combine both.
+ */
+void ecbuff_event_notify(ecbuff_event* const restrict ev);
+ECB_VOID_BOOL_T ecbuff_event_write(ecbuff_event* const restrict ev, const void* const restrict element);
+ECB_UINT_T ecbuff_event_write_n(ecbuff_event* const restrict ev, const void* const restrict elements, const ECB_UINT_T n);
+
+/* ecbuff_event_drained
+ * Called by the consumer once it found the ring empty. Returns true after
+ * re-arming, the consumer then goes back to waiting for the eventfd.
+ * Returns false if the ring holds elements, which are to be read first.
+ */
+bool ecbuff_event_drained(ecbuff_event* const restrict ev);
+
+#endif // ECBUFF_EVENT_H
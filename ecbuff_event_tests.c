@@ -0,0 +1,179 @@
+/*
+ * Tests for ecbuff_event
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#include "ecbuff_event.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+#if defined(ECB_POW2)
+#define ECBT_ELEM_CNT (ECBT_BUFF_SIZ / ECBT_ELEM_SIZ)
+#else
+#define ECBT_ELEM_CNT ((ECBT_BUFF_SIZ / ECBT_ELEM_SIZ) - 1)
+#endif
+
+#define ECBET_COUNT 200000
+#define ECBET_TIMEOUT_MS 5000
+
+ecbuff* ecbet_new(void);
+void ecbet_value(uint8_t* value, uint32_t seq);
+void ecbet_check(ecbuff* rb, uint32_t seq);
+bool ecbet_readable(int fd);
+void ecbet_test_st(void);
+void ecbet_test_mt(void);
+void* ecbet_mt_source(void* arg);
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    ecbet_test_st();
+    ecbet_test_mt();
+    return 0;
+}
+
+ecbuff* ecbet_new(void)
+{
+    ecbuff* rb = malloc(sizeof(ecbuff) + ECBT_BUFF_SIZ);
+    assert(rb);
+    ecbuff_init(rb, ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+    return rb;
+}
+
+void ecbet_value(uint8_t* value, uint32_t seq)
+{
+    memset(value, (uint8_t)(seq * 7 + 1), ECBT_ELEM_SIZ);
+    memcpy(value, &seq, ECBT_ELEM_SIZ < sizeof(seq) ? ECBT_ELEM_SIZ : sizeof(seq));
+}
+
+void ecbet_check(ecbuff* rb, uint32_t seq)
+{
+    uint8_t value[ECBT_ELEM_SIZ];
+    uint8_t expected[ECBT_ELEM_SIZ];
+    ecbuff_read(rb, value);
+    ecbet_value(expected, seq);
+    if(memcmp(value, expected, ECBT_ELEM_SIZ))
+    {
+        printf("Read unexpected value! (element %u)\n", seq);
+        assert(false);
+    }
+}
+
+bool ecbet_readable(int fd)
+{
+    struct pollfd pfd = {fd, POLLIN, 0};
+    return poll(&pfd, 1, 0) == 1;
+}
+
+void ecbet_test_st(void)
+{
+    ecbuff* rb = ecbet_new();
+    ecbuff_event ev;
+    uint8_t value[ECBT_ELEM_SIZ];
+    assert(!ecbuff_event_init(&ev, rb));
+    assert(!ecbet_readable(ev.fd));
+    assert(ecbuff_event_drained(&ev));
+
+    /* A burst signals once */
+    uint32_t seq = 0;
+    for(ECB_UINT_T i = 0; i < ECBT_ELEM_CNT; i++)
+    {
+        ecbet_value(value, seq++);
+        ecbuff_event_write(&ev, value);
+    }
+    assert(ecbet_readable(ev.fd));
+    uint64_t count;
+    assert(read(ev.fd, &count, sizeof(count)) == sizeof(count) && count == 1);
+
+    /* Not drained yet, further writes stay silent */
+    assert(!ecbuff_event_drained(&ev));
+    ecbet_check(rb, 0);
+    ecbet_value(value, seq++);
+    assert(ecbuff_event_write_n(&ev, value, 1) == 1);
+    assert(!ecbet_readable(ev.fd));
+    for(uint32_t i = 1; i < seq; i++)
+        ecbet_check(rb, i);
+    assert(ecbuff_event_drained(&ev));
+    assert(!ecbet_readable(ev.fd));
+
+    /* Re-armed, the next write signals again and drained() resets it */
+    ecbet_value(value, seq);
+    ecbuff_event_write(&ev, value);
+    assert(ecbet_readable(ev.fd));
+    ecbet_check(rb, seq);
+    assert(ecbuff_event_drained(&ev));
+    assert(!ecbet_readable(ev.fd));
+
+    ecbuff_event_close(&ev);
+    free(rb);
+}
+
+/* Consumer in an epoll loop, checks sequence and that bursts coalesce */
+void ecbet_test_mt(void)
+{
+    ecbuff* rb = ecbet_new();
+    ecbuff_event ev;
+    assert(!ecbuff_event_init(&ev, rb));
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    assert(ep >= 0);
+    struct epoll_event event = {.events = EPOLLIN, .data.fd = ev.fd};
+    assert(!epoll_ctl(ep, EPOLL_CTL_ADD, ev.fd, &event));
+
+    pthread_t thread;
+    if(pthread_create(&thread, NULL, ecbet_mt_source, &ev))
+    {
+        printf("Failed to spawn thread!\n");
+        assert(false);
+        return;
+    }
+    uint32_t seq = 0;
+    uint32_t wakeups = 0;
+    while(seq < ECBET_COUNT)
+    {
+        int ret = epoll_wait(ep, &event, 1, ECBET_TIMEOUT_MS);
+        if(!ret)
+        {
+            printf("Lost wake-up! (element %u)\n", seq);
+            assert(false);
+        }
+        if(ret < 0)
+            continue;
+        wakeups++;
+        do
+        {
+            while(!ecbuff_is_empty(rb))
+                ecbet_check(rb, seq++);
+        } while(!ecbuff_event_drained(&ev));
+    }
+    pthread_join(thread, NULL);
+    assert(wakeups <= ECBET_COUNT);
+    assert(ecbuff_is_empty(rb));
+    close(ep);
+    ecbuff_event_close(&ev);
+    free(rb);
+}
+
+void* ecbet_mt_source(void* arg)
+{
+    ecbuff_event* ev = arg;
+    uint8_t value[ECBT_ELEM_SIZ];
+    for(uint32_t seq = 0; seq < ECBET_COUNT; seq++)
+    {
+        while(ecbuff_is_full(ev->rb))
+            sched_yield();
+        ecbet_value(value, seq);
+        ecbuff_event_write(ev, value);
+    }
+    pthread_exit((void*)true);
+}
@@ -0,0 +1,92 @@
+/* See ecbuff_io.h for further information */
+
+#if !defined(_GNU_SOURCE) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L     // readv(), writev()
+#endif
+
+#include "ecbuff_io.h"
+#include <errno.h>
+#include <sys/uio.h>
+
+#if defined(ECB_ASSERT)
+#include <assert.h>
+
+#if !defined(ASSERT)
+//use standard assert() if nothing custom was defined
+#define ASSERT(x) assert(x)
+#endif
+
+#else
+#define NDEBUG
+#undef ASSERT	//ignore earlier definition from ecbuff_cfg.h
+#define ASSERT(x)
+#endif
+
+/* ecbuff_io_iov
+ * Describes span (count elements at ptr) minus the carried bytes, followed
+ * by the elements at the start of the buffer if the span ended at the wrap
+ * point. avail is the total number of free (or ready) elements. Returns the
+ * number of iovec entries used.
+ */
+static int ecbuff_io_iov(const ecbuff* const restrict rb, struct iovec iov[2], ECB_VOLATILE_T char* const ptr,
+                         const ECB_UINT_T count, const ECB_UINT_T avail, const ECB_UINT_T carry)
+{
+    ECB_UINT_T element_size = rb->element_size;
+    ASSERT(carry < element_size);
+    iov[0].iov_base = (void*)(ptr + carry);
+    iov[0].iov_len = count * element_size - carry;
+    if(avail <= count || ptr + count * element_size != &rb->elems[rb->total_size])
+        return 1;
+    iov[1].iov_base = (void*)&rb->elems[0];
+    iov[1].iov_len = (avail - count) * element_size;
+    return 2;
+}
+
+ssize_t ecbuff_fill_from_fd(ecbuff* const restrict rb, const int fd, ECB_UINT_T* const restrict carry)
+{
+    ASSERT(rb);
+    ASSERT(carry);
+    struct iovec iov[2];
+    ECB_UINT_T count;
+    ECB_VOLATILE_T char* ptr = ecbuff_write_alloc_span(rb, &count);
+    if(!ptr)
+    {
+        errno = ENOBUFS;
+        return -1;
+    }
+    /* Free elements never shrink for the producer, the second segment stays valid */
+    int iovcnt = ecbuff_io_iov(rb, iov, ptr, count, ecbuff_unused(rb), *carry);
+    ssize_t ret = readv(fd, iov, iovcnt);
+    if(ret <= 0)
+        return ret;
+
+    ECB_UINT_T element_size = rb->element_size;
+    size_t done = *carry + (size_t)ret;
+    if(done >= element_size)
+        ecbuff_write_enqueue_n(rb, (ECB_UINT_T)(done / element_size));
+    *carry = (ECB_UINT_T)(done % element_size);
+    return ret;
+}
+
+ssize_t ecbuff_drain_to_fd(ecbuff* const restrict rb, const int fd, ECB_UINT_T* const restrict carry)
+{
+    ASSERT(rb);
+    ASSERT(carry);
+    struct iovec iov[2];
+    ECB_UINT_T count;
+    ECB_VOLATILE_T char* ptr = ecbuff_read_dequeue_span(rb, &count);
+    if(!ptr)
+        return 0;
+    /* Ready elements never shrink for the consumer, likewise */
+    int iovcnt = ecbuff_io_iov(rb, iov, ptr, count, ecbuff_used(rb), *carry);
+    ssize_t ret = writev(fd, iov, iovcnt);
+    if(ret <= 0)
+        return ret;
+
+    ECB_UINT_T element_size = rb->element_size;
+    size_t done = *carry + (size_t)ret;
+    if(done >= element_size)
+        ecbuff_read_free_n(rb, (ECB_UINT_T)(done / element_size));
+    *carry = (ECB_UINT_T)(done % element_size);
+    return ret;
+}
@@ -0,0 +1,45 @@
+/*
+ * ecbuff_io moves data between an ecbuff and a file descriptor (pipe, file,
+ * socket) without a bounce buffer. Each call builds an iovec covering the
+ * free (or ready) region of the ring, two segments if it wraps around, and
+ * issues a single readv() (or writev()). The ring then serves as the I/O
+ * buffer itself.
+ *
+ * Only whole elements are committed. The bytes of an element that arrived
+ * (or went out) partially stay in its slot and are counted in *carry, which
+ * the caller keeps per side and zeroes together with ecbuff_init(). The next
+ * call resumes within that element. File descriptors may be blocking or
+ * non-blocking, errors are reported like readv() and writev() do.
+ *
+ * Built on the span functions of ECB_DIRECT_ACCESS, so each helper has to be
+ * called from the thread owning that side of the ring. Requires POSIX.
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#ifndef ECBUFF_IO_H
+#define ECBUFF_IO_H
+
+#include "ecbuff.h"
+#include <sys/types.h>
+
+#if !defined(ECB_DIRECT_ACCESS)
+#error ecbuff_io requires ECB_DIRECT_ACCESS!
+#endif
+
+/* ecbuff_fill_from_fd
+ * Producer only. Reads as many bytes as fit into the free elements and
+ * commits the completed ones. Returns the number of bytes read, 0 on end of
+ * file, or -1 with errno set. If no element is free, nothing is read and -1
+ * is returned with errno set to ENOBUFS.
+ */
+ssize_t ecbuff_fill_from_fd(ecbuff* const restrict rb, const int fd, ECB_UINT_T* const restrict carry);
+
+/* ecbuff_drain_to_fd
+ * Consumer only. Writes the ready elements and frees the ones written
+ * completely. Returns the number of bytes written, 0 if there is nothing to
+ * write, or -1 with errno set.
+ */
+ssize_t ecbuff_drain_to_fd(ecbuff* const restrict rb, const int fd, ECB_UINT_T* const restrict carry);
+
+#endif // ECBUFF_IO_H
@@ -0,0 +1,286 @@
+/*
+ * Tests for ecbuff_io
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#if !defined(_GNU_SOURCE) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "ecbuff_io.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(ECB_THREAD_MULTI)
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#endif
+
+#if defined(ECB_POW2)
+#define ECBT_ELEM_CNT (ECBT_BUFF_SIZ / ECBT_ELEM_SIZ)
+#else
+#define ECBT_ELEM_CNT ((ECBT_BUFF_SIZ / ECBT_ELEM_SIZ) - 1)
+#endif
+
+/* Not a multiple of any element size, leaves a trailing partial element */
+#define ECBIT_STREAM_LEN (1000003)
+#define ECBIT_CHUNK 4096
+
+typedef struct {
+    ecbuff* rb;
+    int fd;
+} ecbit_thread;
+
+ecbuff* ecbit_new(void);
+void ecbit_delete(ecbuff* rb);
+uint8_t ecbit_byte(size_t pos);
+size_t ecbit_send(int fd, size_t pos, size_t len);
+size_t ecbit_receive(int fd, size_t pos, size_t len);
+void ecbit_pipe(int fds[2], bool nonblock);
+void ecbit_test_st(void);
+#if defined(ECB_THREAD_MULTI)
+void ecbit_test_mt(void);
+void* ecbit_mt_source(void* arg);
+void* ecbit_mt_fill(void* arg);
+void* ecbit_mt_drain(void* arg);
+static atomic_int ecbit_filled;
+#endif
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    ecbit_test_st();
+#if defined(ECB_THREAD_MULTI)
+    ecbit_test_mt();
+#endif
+    return 0;
+}
+
+ecbuff* ecbit_new(void)
+{
+    ecbuff* rb = malloc(sizeof(ecbuff) + ECBT_BUFF_SIZ);
+    assert(rb);
+    ecbuff_init(rb, ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+    return rb;
+}
+
+void ecbit_delete(ecbuff* rb)
+{
+    assert(rb);
+    free(rb);
+}
+
+/* Byte at position pos of the test stream */
+uint8_t ecbit_byte(size_t pos)
+{
+    return (uint8_t)(pos ^ (pos >> 8) ^ (pos >> 16));
+}
+
+/* Writes up to len stream bytes starting at pos, returns how many were */
+size_t ecbit_send(int fd, size_t pos, size_t len)
+{
+    uint8_t buf[ECBIT_CHUNK];
+    if(len > sizeof(buf))
+        len = sizeof(buf);
+    for(size_t i = 0; i < len; i++)
+        buf[i] = ecbit_byte(pos + i);
+    ssize_t ret = write(fd, buf, len);
+    if(ret < 0)
+    {
+        assert(errno == EAGAIN || errno == EWOULDBLOCK);
+        return 0;
+    }
+    return (size_t)ret;
+}
+
+/* Reads up to len bytes and checks them against the stream from pos on */
+size_t ecbit_receive(int fd, size_t pos, size_t len)
+{
+    uint8_t buf[ECBIT_CHUNK];
+    if(len > sizeof(buf))
+        len = sizeof(buf);
+    ssize_t ret = read(fd, buf, len);
+    if(ret < 0)
+    {
+        assert(errno == EAGAIN || errno == EWOULDBLOCK);
+        return 0;
+    }
+    for(ssize_t i = 0; i < ret; i++)
+    {
+        if(buf[i] != ecbit_byte(pos + i))
+        {
+            printf("Read unexpected byte at %zu! (%hhu instead of %hhu)\n", pos + i, buf[i], ecbit_byte(pos + i));
+            assert(false);
+        }
+    }
+    return (size_t)ret;
+}
+
+void ecbit_pipe(int fds[2], bool nonblock)
+{
+    int ret = pipe(fds);
+    assert(!ret);
+    (void)ret;
+    if(nonblock)
+    {
+        fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+        fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+    }
+}
+
+/* Stream source -> pipe -> ecbuff -> pipe -> checker, in odd-sized steps */
+void ecbit_test_st(void)
+{
+    ecbuff* rb = ecbit_new();
+    int in[2], out[2];
+    ecbit_pipe(in, true);
+    ecbit_pipe(out, true);
+    size_t sent = 0, filled = 0, drained = 0, received = 0;
+    ECB_UINT_T fill_carry = 0, drain_carry = 0;
+
+    /* Nothing to do on either side */
+    assert(ecbuff_fill_from_fd(rb, in[0], &fill_carry) == -1 && errno == EAGAIN);
+    assert(ecbuff_drain_to_fd(rb, out[1], &drain_carry) == 0);
+
+    while(received < ECBIT_STREAM_LEN / ECBT_ELEM_SIZ * ECBT_ELEM_SIZ || filled < ECBIT_STREAM_LEN)
+    {
+        size_t len = 1 + rand() % (ECBT_ELEM_SIZ * 3 + 13);
+        if(sent < ECBIT_STREAM_LEN)
+            sent += ecbit_send(in[1], sent, len < ECBIT_STREAM_LEN - sent ? len : ECBIT_STREAM_LEN - sent);
+        else if(in[1] >= 0)
+        {
+            close(in[1]);
+            in[1] = -1;
+        }
+
+        bool full = ecbuff_used(rb) == ECBT_ELEM_CNT;
+        ssize_t ret = ecbuff_fill_from_fd(rb, in[0], &fill_carry);
+        if(full)
+            assert(ret == -1 && errno == ENOBUFS);
+        else if(ret > 0)
+            filled += (size_t)ret;
+        else if(ret == 0)
+            assert(in[1] < 0 && filled == ECBIT_STREAM_LEN);
+        else
+            assert(errno == EAGAIN);
+        assert(fill_carry == filled % ECBT_ELEM_SIZ);
+        assert(ecbuff_used(rb) == filled / ECBT_ELEM_SIZ - drained / ECBT_ELEM_SIZ);
+
+        if(rand() % 3)
+        {
+            ret = ecbuff_drain_to_fd(rb, out[1], &drain_carry);
+            if(ret > 0)
+                drained += (size_t)ret;
+            else
+                assert(!ret || errno == EAGAIN);
+            assert(drain_carry == drained % ECBT_ELEM_SIZ);
+            assert(ecbuff_used(rb) == filled / ECBT_ELEM_SIZ - drained / ECBT_ELEM_SIZ);
+        }
+        /* Keep the output pipe from filling up now and then, so writev gets cut short */
+        if(rand() % 4)
+            received += ecbit_receive(out[0], received, 1 + rand() % ECBIT_CHUNK);
+    }
+
+    /* Only whole elements got through, the partial one is still being carried */
+    assert(filled == ECBIT_STREAM_LEN && ecbuff_is_empty(rb));
+    assert(fill_carry == ECBIT_STREAM_LEN % ECBT_ELEM_SIZ && !drain_carry);
+    if(in[1] >= 0)
+        close(in[1]);
+    assert(ecbuff_fill_from_fd(rb, in[0], &fill_carry) == 0);
+    assert(ecbit_receive(out[0], received, 1) == 0);
+    close(in[0]);
+    close(out[0]);
+    close(out[1]);
+    ecbit_delete(rb);
+}
+
+#if defined(ECB_THREAD_MULTI)
+/* Blocking pipes, source and fill, drain and checker run concurrently */
+void ecbit_test_mt(void)
+{
+    ecbuff* rb = ecbit_new();
+    int in[2], out[2];
+    ecbit_pipe(in, false);
+    ecbit_pipe(out, false);
+    atomic_store(&ecbit_filled, 0);
+    pthread_t threads[3];
+    ecbit_thread source = {rb, in[1]}, fill = {rb, in[0]}, drain = {rb, out[1]};
+    if(pthread_create(&threads[0], NULL, ecbit_mt_source, &source) ||
+       pthread_create(&threads[1], NULL, ecbit_mt_fill, &fill) ||
+       pthread_create(&threads[2], NULL, ecbit_mt_drain, &drain))
+    {
+        printf("Failed to spawn thread!\n");
+        assert(false);
+        return;
+    }
+
+    size_t received = 0;
+    for(size_t ret; (ret = ecbit_receive(out[0], received, ECBIT_CHUNK));)
+        received += ret;
+    assert(received == ECBIT_STREAM_LEN / ECBT_ELEM_SIZ * ECBT_ELEM_SIZ);
+
+    for(int t = 0; t < 3; t++)
+        pthread_join(threads[t], NULL);
+    close(in[0]);
+    close(out[0]);
+    ecbit_delete(rb);
+}
+
+void* ecbit_mt_source(void* arg)
+{
+    ecbit_thread* t = arg;
+    for(size_t sent = 0; sent < ECBIT_STREAM_LEN;)
+    {
+        size_t len = 1 + rand() % ECBIT_CHUNK;
+        sent += ecbit_send(t->fd, sent, len < ECBIT_STREAM_LEN - sent ? len : ECBIT_STREAM_LEN - sent);
+    }
+    close(t->fd);
+    pthread_exit((void*)true);
+}
+
+void* ecbit_mt_fill(void* arg)
+{
+    ecbit_thread* t = arg;
+    ECB_UINT_T carry = 0;
+    for(ssize_t ret; (ret = ecbuff_fill_from_fd(t->rb, t->fd, &carry));)
+    {
+        if(ret < 0)
+        {
+            assert(errno == ENOBUFS);
+            sched_yield();
+        }
+    }
+    assert(carry == ECBIT_STREAM_LEN % ECBT_ELEM_SIZ);
+    atomic_store(&ecbit_filled, 1);
+    pthread_exit((void*)true);
+}
+
+void* ecbit_mt_drain(void* arg)
+{
+    ecbit_thread* t = arg;
+    ECB_UINT_T carry = 0;
+    for(;;)
+    {
+        /* Checked before draining, so nothing filled in between gets lost */
+        int done = atomic_load(&ecbit_filled);
+        ssize_t ret = ecbuff_drain_to_fd(t->rb, t->fd, &carry);
+        assert(ret >= 0);
+        if(!ret && done)
+            break;
+        if(!ret)
+            sched_yield();
+    }
+    assert(!carry);
+    close(t->fd);
+    pthread_exit((void*)true);
+}
+#endif
@@ -0,0 +1,179 @@
+/* See ecbuff_large.h for further information */
+
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // MAP_HUGETLB, MADV_HUGEPAGE, syscall()
+#endif
+
+#include "ecbuff_large.h"
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(ECB_ASSERT)
+#include <assert.h>
+
+#if !defined(ASSERT)
+//use standard assert() if nothing custom was defined
+#define ASSERT(x) assert(x)
+#endif
+
+#else
+#define NDEBUG
+#undef ASSERT	//ignore earlier definition from ecbuff_cfg.h
+#define ASSERT(x)
+#endif
+
+/* From <numaif.h>, which would add a libnuma dependency */
+#define ECB_MPOL_PREFERRED 1
+#define ECB_MPOL_F_NODE (1 << 0)
+#define ECB_MPOL_F_ADDR (1 << 1)
+#define ECB_NODE_WORDS 16                       /* nodemask covers 1024 nodes */
+
+/* Layout of the mapping, H being the header size:
+ * [0, H)           header, ecbuff_large_hdr directly precedes ecbuff,
+ *                  which ends exactly where the header ends
+ * [H, H + S)       element storage, huge page aligned unless ECB_PAGES_DEFAULT
+ */
+typedef struct {
+    char* base;
+    size_t len;
+} ecbuff_large_hdr;
+
+static inline size_t ecbuff_large_round(const size_t len, const size_t unit)
+{
+    return (len + unit - 1) / unit * unit;
+}
+
+static inline ecbuff_large_hdr* ecbuff_large_get_hdr(const ecbuff* const restrict rb)
+{
+    return (ecbuff_large_hdr*)rb - 1;
+}
+
+/* Prefers node for the range, ENOSYS on kernels without NUMA is ignored */
+static int ecbuff_large_bind(char* const base, const size_t len, int node)
+{
+#if defined(SYS_mbind) && defined(SYS_getcpu)
+    if(node == ECB_NODE_ANY)
+        return 0;
+    if(node == ECB_NODE_LOCAL)
+    {
+        unsigned int cpu, local;
+        if(syscall(SYS_getcpu, &cpu, &local, NULL))
+            return 0;
+        node = (int)local;
+    }
+    const size_t bits = 8 * sizeof(unsigned long);
+    unsigned long mask[ECB_NODE_WORDS] = {0};
+    if(node < 0 || (size_t)node >= ECB_NODE_WORDS * bits)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    mask[node / bits] = 1ul << (node % bits);
+    if(syscall(SYS_mbind, base, len, ECB_MPOL_PREFERRED, mask, ECB_NODE_WORDS * bits + 1, 0) && errno != ENOSYS)
+        return -1;
+#else
+    (void)base;
+    (void)len;
+    (void)node;
+#endif
+    return 0;
+}
+
+ecbuff* ecbuff_new_large(const ECB_UINT_T total_size, const ECB_UINT_T element_size,
+                         const ecbuff_large_opts* const restrict opts)
+{
+    static const ecbuff_large_opts defaults = {ECB_PAGES_HUGE_TRANSPARENT, ECB_NODE_LOCAL, true};
+    const ecbuff_large_opts* o = opts ? opts : &defaults;
+    ASSERT(element_size);
+    ASSERT(o->pages == ECB_PAGES_DEFAULT || o->pages == ECB_PAGES_HUGE_TRANSPARENT ||
+           o->pages == ECB_PAGES_HUGE_EXPLICIT);
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t huge = ECB_HUGE_PAGE_SIZE;
+    size_t hdr = o->pages == ECB_PAGES_HUGE_EXPLICIT ? huge : page;
+    size_t size = ecbuff_large_round(total_size ? total_size : 1, o->pages == ECB_PAGES_DEFAULT ? page : huge);
+    size_t len = hdr + size;
+    ASSERT(offsetof(ecbuff, elems) + sizeof(ecbuff_large_hdr) <= hdr);
+    if((uintmax_t)total_size > (uintmax_t)ECB_ATOMIC_MAX || size < total_size)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if(!o->prefault && o->pages != ECB_PAGES_HUGE_EXPLICIT)
+        flags |= MAP_NORESERVE;
+    char* base;
+    if(o->pages == ECB_PAGES_HUGE_EXPLICIT)
+    {
+        base = mmap(NULL, len, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+        if(base == MAP_FAILED)
+            return NULL;
+    }
+    else if(o->pages == ECB_PAGES_HUGE_TRANSPARENT)
+    {
+        /* Over-allocate, then trim so the element storage starts huge page aligned */
+        char* raw = mmap(NULL, len + huge, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if(raw == MAP_FAILED)
+            return NULL;
+        base = (char*)ecbuff_large_round((uintptr_t)raw + hdr, huge) - hdr;
+        if(base > raw)
+            munmap(raw, (size_t)(base - raw));
+        if(raw + len + huge > base + len)
+            munmap(base + len, (size_t)(raw + len + huge - (base + len)));
+#if defined(MADV_HUGEPAGE)
+        madvise(base + hdr, size, MADV_HUGEPAGE);
+#endif
+    }
+    else
+    {
+        base = mmap(NULL, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if(base == MAP_FAILED)
+            return NULL;
+    }
+
+    /* Policy has to be in place before the first touch */
+    if(ecbuff_large_bind(base, len, o->node))
+    {
+        int err = errno;
+        munmap(base, len);
+        errno = err;
+        return NULL;
+    }
+    if(o->prefault)
+    {
+        for(size_t i = hdr; i < len; i += page)
+            *(volatile char*)&base[i] = 0;
+    }
+
+    ecbuff* rb = (ecbuff*)(base + hdr - offsetof(ecbuff, elems));
+    ecbuff_large_hdr* h = ecbuff_large_get_hdr(rb);
+    h->base = base;
+    h->len = len;
+    ecbuff_init(rb, total_size, element_size);
+    return rb;
+}
+
+void ecbuff_delete_large(ecbuff* const restrict rb)
+{
+    ASSERT(rb);
+    ecbuff_large_hdr* h = ecbuff_large_get_hdr(rb);
+    munmap(h->base, h->len);
+}
+
+int ecbuff_large_node(const ecbuff* const restrict rb)
+{
+    ASSERT(rb);
+#if defined(SYS_get_mempolicy)
+    int node;
+    if(syscall(SYS_get_mempolicy, &node, NULL, 0, (void*)&rb->elems[0], ECB_MPOL_F_NODE | ECB_MPOL_F_ADDR))
+        return -1;
+    return node;
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
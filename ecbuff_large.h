@@ -0,0 +1,55 @@
+/*
+ * ecbuff_large allocates ecbuff instances for large (multi-GB) buffers on
+ * Linux. The element storage can be backed by transparent or explicit huge
+ * pages to cut TLB misses, bound to a NUMA node and pre-faulted, so the
+ * first pass over the buffer doesn't take page faults on the hot path.
+ *
+ * Buffers beyond 2 GiB need 64-bit indices, i.e. ECB_ATOMIC_T int64_t and
+ * ECB_UINT_T uint64_t (see ecbuff_cfg.h).
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#ifndef ECBUFF_LARGE_H
+#define ECBUFF_LARGE_H
+
+#include "ecbuff.h"
+
+/* ECB_HUGE_PAGE_SIZE
+ * Huge page size assumed for alignment and explicit huge page mappings.
+ */
+#if !defined(ECB_HUGE_PAGE_SIZE)
+#define ECB_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#endif
+
+#define ECB_NODE_LOCAL (-1)                     /* node of the CPU calling ecbuff_new_large() */
+#define ECB_NODE_ANY (-2)                       /* leave placement to the kernel */
+
+typedef enum {
+    ECB_PAGES_DEFAULT = 0,                      /* regular pages */
+    ECB_PAGES_HUGE_TRANSPARENT,                 /* huge page aligned, advised for transparent huge pages */
+    ECB_PAGES_HUGE_EXPLICIT                     /* MAP_HUGETLB, requires reserved huge pages */
+} ecbuff_pages;
+
+typedef struct {
+    ecbuff_pages pages;
+    int node;                                   /* NUMA node, ECB_NODE_LOCAL or ECB_NODE_ANY */
+    bool prefault;                              /* touch every page before returning */
+} ecbuff_large_opts;
+
+/* ecbuff_new_large / ecbuff_delete_large
+ * Alternative to allocating memory and calling ecbuff_init(). opts may be
+ * NULL for transparent huge pages on the local node, pre-faulted. With
+ * ECB_NODE_LOCAL, call it from the consumer's thread so the buffer ends up
+ * close to it. Without prefault memory is committed as it's first touched.
+ * Returns NULL and sets errno on failure, e.g. ENOMEM if no explicit huge
+ * pages are reserved.
+ */
+ecbuff* ecbuff_new_large(const ECB_UINT_T total_size, const ECB_UINT_T element_size,
+                         const ecbuff_large_opts* const restrict opts);
+void ecbuff_delete_large(ecbuff* const restrict rb);
+
+/* NUMA node the first element resides on, -1 with errno set if unknown */
+int ecbuff_large_node(const ecbuff* const restrict rb);
+
+#endif // ECBUFF_LARGE_H
@@ -0,0 +1,141 @@
+/*
+ * Tests for ecbuff_large
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#include "ecbuff_large.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+
+#if defined(ECB_POW2)
+#define ECBT_ELEM_CNT (ECBT_BUFF_SIZ / ECBT_ELEM_SIZ)
+#else
+#define ECBT_ELEM_CNT ((ECBT_BUFF_SIZ / ECBT_ELEM_SIZ) - 1)
+#endif
+
+void ecblt_value(uint8_t* value, uint32_t seq);
+void ecblt_pass(ecbuff* rb, ECB_UINT_T count, uint32_t seq);
+void ecblt_test_pages(ecbuff_pages pages);
+void ecblt_test_node(void);
+#if ECB_UINT_MAX > UINT32_MAX && defined(ECB_DIRECT_ACCESS)
+void ecblt_test_idx64(void);
+#endif
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    ecblt_test_pages(ECB_PAGES_DEFAULT);
+    ecblt_test_pages(ECB_PAGES_HUGE_TRANSPARENT);
+    ecblt_test_pages(ECB_PAGES_HUGE_EXPLICIT);
+    ecblt_test_node();
+#if ECB_UINT_MAX > UINT32_MAX && defined(ECB_DIRECT_ACCESS)
+    ecblt_test_idx64();
+#endif
+    return 0;
+}
+
+void ecblt_value(uint8_t* value, uint32_t seq)
+{
+    memset(value, (uint8_t)(seq * 7 + 1), ECBT_ELEM_SIZ);
+    memcpy(value, &seq, ECBT_ELEM_SIZ < sizeof(seq) ? ECBT_ELEM_SIZ : sizeof(seq));
+}
+
+/* Fills the buffer with count elements starting at seq and reads them back */
+void ecblt_pass(ecbuff* rb, ECB_UINT_T count, uint32_t seq)
+{
+    uint8_t value[ECBT_ELEM_SIZ];
+    uint8_t expected[ECBT_ELEM_SIZ];
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        ecblt_value(value, seq + (uint32_t)i);
+        ecbuff_write(rb, value);
+    }
+    assert(ecbuff_used(rb) == count);
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        ecbuff_read(rb, value);
+        ecblt_value(expected, seq + (uint32_t)i);
+        if(memcmp(value, expected, ECBT_ELEM_SIZ))
+        {
+            printf("Read unexpected value! (element %u)\n", (unsigned int)i);
+            assert(false);
+        }
+    }
+    assert(ecbuff_is_empty(rb));
+}
+
+void ecblt_test_pages(ecbuff_pages pages)
+{
+    ecbuff_large_opts opts = {pages, ECB_NODE_LOCAL, true};
+    ecbuff* rb = ecbuff_new_large(ECBT_BUFF_SIZ, ECBT_ELEM_SIZ, &opts);
+    if(!rb)
+    {
+        /* Explicit huge pages have to be reserved by the administrator */
+        assert(pages == ECB_PAGES_HUGE_EXPLICIT && errno == ENOMEM);
+        return;
+    }
+    assert(rb->total_size == ECBT_BUFF_SIZ && rb->element_size == ECBT_ELEM_SIZ);
+    if(pages != ECB_PAGES_DEFAULT)
+        assert(!((uintptr_t)&rb->elems[0] % ECB_HUGE_PAGE_SIZE));
+    ecblt_pass(rb, ECBT_ELEM_CNT, 0);
+    ecblt_pass(rb, ECBT_ELEM_CNT / 2 + 1, 42);
+    ecbuff_delete_large(rb);
+}
+
+void ecblt_test_node(void)
+{
+    /* Defaults, then node 0 which always exists */
+    ecbuff* rb = ecbuff_new_large(ECBT_BUFF_SIZ, ECBT_ELEM_SIZ, NULL);
+    assert(rb);
+    int node = ecbuff_large_node(rb);
+    assert(node >= 0 || errno == ENOSYS);
+    ecblt_pass(rb, ECBT_ELEM_CNT, 0);
+    ecbuff_delete_large(rb);
+
+    ecbuff_large_opts opts = {ECB_PAGES_DEFAULT, 0, true};
+    rb = ecbuff_new_large(ECBT_BUFF_SIZ, ECBT_ELEM_SIZ, &opts);
+    assert(rb);
+    node = ecbuff_large_node(rb);
+    assert(node == 0 || errno == ENOSYS);
+    ecbuff_delete_large(rb);
+
+    opts.node = 1 << 20;
+    assert(!ecbuff_new_large(ECBT_BUFF_SIZ, ECBT_ELEM_SIZ, &opts) && errno == EINVAL);
+}
+
+#if ECB_UINT_MAX > UINT32_MAX && defined(ECB_DIRECT_ACCESS)
+/* Buffer beyond 4 GiB, committed lazily. Indices are advanced across it
+ * without touching the memory, then elements wrap around its end. */
+void ecblt_test_idx64(void)
+{
+#if defined(ECB_POW2)
+    ECB_UINT_T total_size = (ECB_UINT_T)1 << 33;
+    ECB_UINT_T capacity = total_size / ECBT_ELEM_SIZ;
+#else
+    ECB_UINT_T total_size = ((ECB_UINT_T)1 << 32) + 8 * ECBT_ELEM_SIZ;
+    ECB_UINT_T capacity = total_size / ECBT_ELEM_SIZ - 1;
+#endif
+    ecbuff_large_opts opts = {ECB_PAGES_HUGE_TRANSPARENT, ECB_NODE_LOCAL, false};
+    ecbuff* rb = ecbuff_new_large(total_size, ECBT_ELEM_SIZ, &opts);
+    assert(rb);
+    assert(ecbuff_unused(rb) == capacity);
+
+    ECB_UINT_T count;
+    assert(ecbuff_write_alloc_span(rb, &count) && count == capacity);
+    ecbuff_write_enqueue_n(rb, capacity - 2);
+    assert(ecbuff_used(rb) == capacity - 2);
+    assert(ecbuff_read_dequeue_span(rb, &count) && count == capacity - 2);
+    ecbuff_read_free_n(rb, count);
+    assert(ecbuff_is_empty(rb));
+
+    ecblt_pass(rb, 5, 1337);
+    ecbuff_delete_large(rb);
+}
+#endif
@@ -0,0 +1,165 @@
+/* See ecbuff_lossy.h for further information */
+
+#include "ecbuff_lossy.h"
+#include <string.h>
+
+#if defined(ECB_ASSERT)
+#include <assert.h>
+
+#if !defined(ASSERT)
+//use standard assert() if nothing custom was defined
+#define ASSERT(x) assert(x)
+#endif
+
+#else
+#define NDEBUG
+#undef ASSERT	//ignore earlier definition from ecbuff_cfg.h
+#define ASSERT(x)
+#endif
+
+/* Sequence numbers of a slot:
+ * 0                never written
+ * 2 * pos + 1      being written with position pos
+ * 2 * pos + 2      holds position pos
+ */
+#define ECB_LOSSY_BUSY(pos) (2 * (pos) + 1)
+#define ECB_LOSSY_DONE(pos) (2 * (pos) + 2)
+
+static inline atomic_size_t* ecbuff_lossy_slot(const ecbuff_lossy* const restrict rb, const size_t pos)
+{
+    return (atomic_size_t*)&rb->slots[(pos & rb->mask) * rb->stride];
+}
+
+void ecbuff_lossy_init(ecbuff_lossy* const restrict rb, const ECB_UINT_T count, const ECB_UINT_T element_size)
+{
+    ASSERT(rb);
+    ASSERT(count >= 2);
+    ASSERT(!(count & (count - 1)));
+    ASSERT(element_size);
+    rb->mask = count - 1;
+    rb->element_size = element_size;
+    rb->stride = ECBUFF_LOSSY_STRIDE(element_size);
+    for(size_t i = 0; i < count; i++)
+        atomic_init(ecbuff_lossy_slot(rb, i), 0);
+    atomic_init(&rb->tail, 0);
+    atomic_init(&rb->head, 0);
+    atomic_init(&rb->lost, 0);
+}
+
+/* Mark the slot at tail as being written. The fence keeps the following
+ * element stores from becoming visible before the odd sequence number.
+ */
+static inline atomic_size_t* ecbuff_lossy_begin(ecbuff_lossy* const restrict rb, const size_t tail)
+{
+    atomic_size_t* slot = ecbuff_lossy_slot(rb, tail);
+    atomic_store_explicit(slot, ECB_LOSSY_BUSY(tail), memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    return slot;
+}
+
+static inline void ecbuff_lossy_end(ecbuff_lossy* const restrict rb, atomic_size_t* const restrict slot, const size_t tail)
+{
+    atomic_store_explicit(slot, ECB_LOSSY_DONE(tail), memory_order_release);
+    atomic_store_explicit(&rb->tail, tail + 1, memory_order_release);
+}
+
+void ecbuff_lossy_write(ecbuff_lossy* const restrict rb, const void* const restrict element)
+{
+    ASSERT(rb);
+    ASSERT(element);
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    atomic_size_t* slot = ecbuff_lossy_begin(rb, tail);
+    memcpy((char*)slot + ECBUFF_LOSSY_HDR, element, rb->element_size);
+    ecbuff_lossy_end(rb, slot, tail);
+}
+
+bool ecbuff_lossy_read(ecbuff_lossy* const restrict rb, void* const restrict element, ECB_UINT_T* const restrict lost)
+{
+    ASSERT(rb);
+    ASSERT(element);
+    size_t count = rb->mask + 1;
+    size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    size_t skipped = 0;
+    bool ret = false;
+
+    for(;;)
+    {
+        size_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+        if(head == tail)
+            break;
+        if(tail - head > count)
+        {   /* Lapped, everything older than one buffer is gone */
+            skipped += tail - count - head;
+            head = tail - count;
+        }
+
+        atomic_size_t* slot = ecbuff_lossy_slot(rb, head);
+        size_t seq = atomic_load_explicit(slot, memory_order_acquire);
+        if(seq == ECB_LOSSY_DONE(head))
+        {
+            memcpy(element, (char*)slot + ECBUFF_LOSSY_HDR, rb->element_size);
+            /* Orders the copy before checking the sequence number again */
+            atomic_thread_fence(memory_order_acquire);
+            if(atomic_load_explicit(slot, memory_order_relaxed) == seq)
+            {
+                head++;
+                ret = true;
+                break;
+            }
+        }
+        /* Overwritten before or while being copied */
+        skipped++;
+        head++;
+    }
+
+    atomic_store_explicit(&rb->head, head, memory_order_release);
+    if(skipped)
+        atomic_store_explicit(&rb->lost, atomic_load_explicit(&rb->lost, memory_order_relaxed) + skipped,
+                              memory_order_relaxed);
+    if(lost)
+        *lost = (ECB_UINT_T)skipped;
+    return ret;
+}
+
+bool ecbuff_lossy_is_empty(const ecbuff_lossy* const restrict rb)
+{
+    ASSERT(rb);
+    size_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+    return atomic_load_explicit(&rb->tail, memory_order_acquire) == head;
+}
+
+ECB_UINT_T ecbuff_lossy_used(const ecbuff_lossy* const restrict rb)
+{
+    ASSERT(rb);
+    size_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+    size_t used = tail - head;
+    /* The producer may be any number of laps ahead */
+    if(used > rb->mask + 1)
+        return rb->mask + 1;
+    return used;
+}
+
+size_t ecbuff_lossy_lost(const ecbuff_lossy* const restrict rb)
+{
+    ASSERT(rb);
+    return atomic_load_explicit(&rb->lost, memory_order_relaxed);
+}
+
+#ifdef ECB_DIRECT_ACCESS
+void* ecbuff_lossy_write_alloc(ecbuff_lossy* const restrict rb)
+{
+    ASSERT(rb);
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    return (char*)ecbuff_lossy_begin(rb, tail) + ECBUFF_LOSSY_HDR;
+}
+
+void ecbuff_lossy_write_enqueue(ecbuff_lossy* const restrict rb)
+{
+    ASSERT(rb);
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    atomic_size_t* slot = ecbuff_lossy_slot(rb, tail);
+    ASSERT(atomic_load_explicit(slot, memory_order_relaxed) == ECB_LOSSY_BUSY(tail));
+    ecbuff_lossy_end(rb, slot, tail);
+}
+#endif
@@ -0,0 +1,79 @@
+/*
+ * ecbuff_lossy is a single-producer/single-consumer ring with "latest wins"
+ * semantics that, unlike ECB_WRITE_OVERWRITE, is safe across threads. The
+ * producer never blocks and never fails, once the buffer is full it simply
+ * overwrites the oldest element. It doesn't even read the consumer's index.
+ *
+ * Each slot carries a sequence number acting as a seqlock: it is odd while
+ * the slot is written and otherwise tells which position the slot holds. The
+ * consumer checks it before and after copying an element, thus detecting
+ * slots that were overwritten or torn while being read and skipping ahead.
+ * ecbuff_lossy_read() reports how many elements were skipped that way and
+ * ecbuff_lossy_lost() keeps a running total.
+ *
+ * Since elements may change while being copied out, there is no zero-copy
+ * read API. It requires C11 atomics and a power of two element count.
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#ifndef ECBUFF_LOSSY_H
+#define ECBUFF_LOSSY_H
+
+#include "ecbuff.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+#if !defined(ECB_CACHELINE)
+#define ECB_CACHELINE 64
+#endif
+
+typedef struct {
+    size_t mask;                                /* element count - 1 */
+    size_t element_size;
+    size_t stride;                              /* bytes per slot, sequence number included */
+    char pad_config[ECB_CACHELINE - 3 * sizeof(size_t)];
+    atomic_size_t tail;                         /* next position to be written, producer only */
+    char pad_tail[ECB_CACHELINE - sizeof(atomic_size_t)];
+    atomic_size_t head;                         /* next position to be read, consumer only */
+    atomic_size_t lost;                         /* elements skipped by the consumer */
+    char pad_head[ECB_CACHELINE - 2 * sizeof(atomic_size_t)];
+    char slots[];                               /* count * stride bytes */
+} ecbuff_lossy;
+
+/* Per slot header, the element follows it directly */
+#define ECBUFF_LOSSY_HDR sizeof(atomic_size_t)
+#define ECBUFF_LOSSY_STRIDE(element_size) \
+    ((ECBUFF_LOSSY_HDR + (element_size) + ECBUFF_LOSSY_HDR - 1) / ECBUFF_LOSSY_HDR * ECBUFF_LOSSY_HDR)
+/* Number of bytes to allocate for an instance holding count elements */
+#define ECBUFF_LOSSY_SIZE(count, element_size) \
+    (sizeof(ecbuff_lossy) + (size_t)(count) * ECBUFF_LOSSY_STRIDE(element_size))
+
+/* ecbuff_lossy_init
+ * count has to be a power of two and at least 2.
+ * rb has to provide ECBUFF_LOSSY_SIZE(count, element_size) bytes.
+ */
+void ecbuff_lossy_init(ecbuff_lossy* const restrict rb, const ECB_UINT_T count, const ECB_UINT_T element_size);
+/* Producer only, overwrites the oldest element if the buffer is full */
+void ecbuff_lossy_write(ecbuff_lossy* const restrict rb, const void* const restrict element);
+/* ecbuff_lossy_read
+ * Consumer only. Copies the oldest element that is still intact and stores
+ * the number of elements skipped to reach it to *lost (may be NULL).
+ * Returns false if the buffer is empty, element is undefined in that case.
+ */
+bool ecbuff_lossy_read(ecbuff_lossy* const restrict rb, void* const restrict element, ECB_UINT_T* const restrict lost);
+bool ecbuff_lossy_is_empty(const ecbuff_lossy* const restrict rb);
+/* Snapshots, may be outdated as soon as they return */
+ECB_UINT_T ecbuff_lossy_used(const ecbuff_lossy* const restrict rb);
+/* Total number of elements skipped by the consumer, wraps at SIZE_MAX */
+size_t ecbuff_lossy_lost(const ecbuff_lossy* const restrict rb);
+
+#ifdef ECB_DIRECT_ACCESS
+/* Producer: ecbuff_lossy_write_alloc() returns the next slot, marking it as
+ * being written, ecbuff_lossy_write_enqueue() publishes it.
+ */
+void* ecbuff_lossy_write_alloc(ecbuff_lossy* const restrict rb);
+void ecbuff_lossy_write_enqueue(ecbuff_lossy* const restrict rb);
+#endif // ECB_DIRECT_ACCESS
+
+#endif // ECBUFF_LOSSY_H
@@ -0,0 +1,209 @@
+/*
+ * Tests for ecbuff_lossy
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#include "ecbuff_lossy.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define ECBLT_PER_RUN 200000
+
+static atomic_uint ecblt_done;
+
+ecbuff_lossy* ecblt_new(ECB_UINT_T count, ECB_UINT_T element_size);
+void ecblt_delete(ecbuff_lossy* buff);
+void ecblt_test_st_basic(ECB_UINT_T count);
+void ecblt_test_mt_stress(ECB_UINT_T count);
+void* ecblt_mt_source(void* buff);
+void ecblt_put(ecbuff_lossy* buff, uint32_t seq, bool direct);
+bool ecblt_get(ecbuff_lossy* buff, uint32_t* seq, ECB_UINT_T* lost);
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    ecblt_test_st_basic(1337);
+    ecblt_test_mt_stress(5);
+    return 0;
+}
+
+ecbuff_lossy* ecblt_new(ECB_UINT_T count, ECB_UINT_T element_size)
+{
+    ecbuff_lossy* buff = malloc(ECBUFF_LOSSY_SIZE(count, element_size));
+    assert(buff);
+    ecbuff_lossy_init(buff, count, element_size);
+    assert(ecbuff_lossy_is_empty(buff));
+    return buff;
+}
+
+void ecblt_delete(ecbuff_lossy* buff)
+{
+    assert(buff);
+    free(buff);
+}
+
+/* Every byte of an element is derived from seq, so torn copies stand out */
+void ecblt_put(ecbuff_lossy* buff, uint32_t seq, bool direct)
+{
+    uint8_t value[ECBT_ELEM_SIZ];
+    memset(value, (uint8_t)(seq * 7 + 1), ECBT_ELEM_SIZ);
+    memcpy(value, &seq, sizeof(seq));
+#if defined(ECB_DIRECT_ACCESS)
+    if(direct)
+    {
+        void* ptr = ecbuff_lossy_write_alloc(buff);
+        assert(ptr);
+        memcpy(ptr, value, ECBT_ELEM_SIZ);
+        ecbuff_lossy_write_enqueue(buff);
+        return;
+    }
+#else
+    (void)direct;
+#endif
+    ecbuff_lossy_write(buff, value);
+}
+
+bool ecblt_get(ecbuff_lossy* buff, uint32_t* seq, ECB_UINT_T* lost)
+{
+    uint8_t value[ECBT_ELEM_SIZ];
+    if(!ecbuff_lossy_read(buff, value, lost))
+        return false;
+    memcpy(seq, value, sizeof(*seq));
+    for(size_t i = sizeof(*seq); i < ECBT_ELEM_SIZ; i++)
+    {
+        if(value[i] != (uint8_t)(*seq * 7 + 1))
+        {
+            printf("Read torn element! (seq %u)\n", *seq);
+            assert(false);
+        }
+    }
+    return true;
+}
+
+void ecblt_test_st_basic(ECB_UINT_T count)
+{
+    ecbuff_lossy* buff = ecblt_new(ECBT_ELEM_CNT, ECBT_ELEM_SIZ);
+    uint32_t wseq = 0;
+    uint32_t rseq = 0;
+    size_t total_lost = 0;
+
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        /* Writing never fails, up to twice the buffer's size is written */
+        ECB_UINT_T num = rand() % (ECBT_ELEM_CNT * 2 + 1);
+        for(ECB_UINT_T j = 0; j < num; j++, wseq++)
+            ecblt_put(buff, wseq, wseq & 1);
+        ECB_UINT_T used = wseq - rseq > ECBT_ELEM_CNT ? ECBT_ELEM_CNT : wseq - rseq;
+        assert(ecbuff_lossy_used(buff) == used);
+
+        num = rand() % (used + 1);
+        for(ECB_UINT_T j = 0; j < num; j++)
+        {
+            uint32_t seq;
+            ECB_UINT_T lost;
+            assert(ecblt_get(buff, &seq, &lost));
+            /* Only the newest ECBT_ELEM_CNT elements survive */
+            uint32_t expected = wseq - rseq > ECBT_ELEM_CNT ? wseq - ECBT_ELEM_CNT : rseq;
+            if(seq != expected || lost != expected - rseq)
+            {
+                printf("Read unexpected value! (%u instead of %u, %u lost)\n", seq, expected, (unsigned int)lost);
+                assert(false);
+                return;
+            }
+            total_lost += lost;
+            rseq = seq + 1;
+        }
+        assert(ecbuff_lossy_lost(buff) == total_lost);
+    }
+
+    uint32_t seq;
+    ECB_UINT_T lost;
+    while(!ecbuff_lossy_is_empty(buff))
+    {
+        assert(ecblt_get(buff, &seq, &lost));
+        total_lost += lost;
+        rseq = seq + 1;
+    }
+    assert(rseq == wseq);
+    assert(ecbuff_lossy_used(buff) == 0);
+    assert(!ecblt_get(buff, &seq, &lost) && lost == 0);
+    assert(!ecblt_get(buff, &seq, NULL));
+    assert(ecbuff_lossy_lost(buff) == total_lost);
+    ecblt_delete(buff);
+}
+
+void ecblt_test_mt_stress(ECB_UINT_T count)
+{
+    ecbuff_lossy* buff = ecblt_new(ECBT_ELEM_CNT, ECBT_ELEM_SIZ);
+
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        pthread_t thread;
+        uint64_t received = 0;
+        uint64_t lost_sum = 0;
+        int64_t last = -1;
+        atomic_store(&ecblt_done, 0);
+        ecbuff_lossy_init(buff, ECBT_ELEM_CNT, ECBT_ELEM_SIZ);
+
+        if(pthread_create(&thread, NULL, ecblt_mt_source, buff))
+        {
+            printf("Failed to spawn thread!\n");
+            assert(false);
+            return;
+        }
+
+        /* The main thread consumes, occasionally falling behind */
+        for(uint32_t n = 0;; n++)
+        {
+            uint32_t seq;
+            ECB_UINT_T lost;
+            if(!(rand() % 64))
+                sched_yield();
+            if(!ecblt_get(buff, &seq, &lost))
+            {
+                /* Skipped elements without finding an intact one */
+                last += lost;
+                lost_sum += lost;
+                if(atomic_load(&ecblt_done) && ecbuff_lossy_is_empty(buff))
+                    break;
+                sched_yield();
+                continue;
+            }
+            /* Elements arrive in order, every gap is accounted for */
+            if((int64_t)seq != last + 1 + (int64_t)lost)
+            {
+                printf("Read unexpected value! (seq %u after %lld, %u lost)\n", seq, (long long)last,
+                       (unsigned int)lost);
+                assert(false);
+                return;
+            }
+            last = seq;
+            received++;
+            lost_sum += lost;
+        }
+
+        pthread_join(thread, NULL);
+        assert(last == ECBLT_PER_RUN - 1);
+        assert(received + lost_sum == ECBLT_PER_RUN);
+        assert(ecbuff_lossy_lost(buff) == lost_sum);
+    }
+
+    ecblt_delete(buff);
+}
+
+void* ecblt_mt_source(void* buff)
+{
+    for(uint32_t seq = 0; seq < ECBLT_PER_RUN; seq++)
+        ecblt_put(buff, seq, seq & 1);
+    atomic_store(&ecblt_done, 1);
+
+    pthread_exit((void*)true);
+}
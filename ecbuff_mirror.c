@@ -0,0 +1,101 @@
+/* Mirrored allocation for ecbuff, see ECB_MIRROR in ecbuff_cfg.h */
+
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // memfd_create()
+#endif
+
+#include "ecbuff.h"
+
+#if defined(ECB_MIRROR)
+#include <errno.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(ECB_ASSERT)
+#include <assert.h>
+
+#if !defined(ASSERT)
+//use standard assert() if nothing custom was defined
+#define ASSERT(x) assert(x)
+#endif
+
+#else
+#define NDEBUG
+#undef ASSERT	//ignore earlier definition from ecbuff_cfg.h
+#define ASSERT(x)
+#endif
+
+/* Layout of the reserved address range, P being the page size:
+ * [0, P)           header page, ecbuff ends exactly where it ends
+ * [P, P + T)       element storage, memfd offset P
+ * [P + T, P + 2T)  second mapping of memfd offset P
+ */
+
+static size_t ecbuff_mirror_size(const size_t total_size, const size_t element_size, const size_t page)
+{
+#if defined(ECB_POW2)
+    // Pages are a power of two, doubling one keeps it a page multiple
+    size_t size = page;
+    while((size < total_size || size % element_size) && size <= SIZE_MAX / 2)
+        size *= 2;
+#else
+    size_t size = (total_size + page - 1) / page * page;
+    if(!size)
+        size = page;
+    while(size % element_size)
+        size += page;
+#endif
+    return size;
+}
+
+ecbuff* ecbuff_new_mirror(const ECB_UINT_T total_size, const ECB_UINT_T element_size)
+{
+    ASSERT(element_size);
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t hdr = page;
+    size_t size = ecbuff_mirror_size(total_size, element_size, page);
+    ASSERT(offsetof(ecbuff, elems) <= hdr);
+    if(size > (size_t)ECB_ATOMIC_MAX)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    int fd = memfd_create("ecbuff", MFD_CLOEXEC);
+    if(fd < 0)
+        return NULL;
+    char* base = MAP_FAILED;
+    if(ftruncate(fd, (off_t)(hdr + size)) == 0)
+        base = mmap(NULL, hdr + 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(base == MAP_FAILED ||
+       mmap(base, hdr + size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+       mmap(base + hdr + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, (off_t)hdr) == MAP_FAILED)
+    {
+        int err = errno;
+        if(base != MAP_FAILED)
+            munmap(base, hdr + 2 * size);
+        close(fd);
+        errno = err;
+        return NULL;
+    }
+    // The mappings keep the memory alive
+    close(fd);
+
+    ecbuff* rb = (ecbuff*)(base + hdr - offsetof(ecbuff, elems));
+    ecbuff_init(rb, (ECB_UINT_T)size, element_size);
+    rb->mirrored = 1;
+    return rb;
+}
+
+void ecbuff_delete_mirror(ecbuff* const restrict rb)
+{
+    ASSERT(rb);
+    ASSERT(rb->mirrored);
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t size = (size_t)rb->total_size;
+    char* base = (char*)&rb->elems[0] - page;
+    munmap(base, page + 2 * size);
+}
+
+#endif /* ECB_MIRROR */
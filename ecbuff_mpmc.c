@@ -0,0 +1,188 @@
+/* See ecbuff_mpmc.h for further information */
+
+#include "ecbuff_mpmc.h"
+#include <string.h>
+#include <stdint.h>
+
+#if defined(ECB_ASSERT)
+#include <assert.h>
+
+#if !defined(ASSERT)
+//use standard assert() if nothing custom was defined
+#define ASSERT(x) assert(x)
+#endif
+
+#else
+#define NDEBUG
+#undef ASSERT	//ignore earlier definition from ecbuff_cfg.h
+#define ASSERT(x)
+#endif
+
+/* Sequence numbers of slot i:
+ * i + n * count        free, may be claimed by the producer of position i + n * count
+ * i + n * count + 1    ready, may be claimed by the consumer of position i + n * count
+ * Producers and consumers compare the sequence number with the position they
+ * try to claim. A smaller sequence number means the buffer is full (empty).
+ */
+
+static inline atomic_size_t* ecbuff_mpmc_slot(ecbuff_mpmc* const restrict rb, const size_t pos)
+{
+    return (atomic_size_t*)&rb->slots[(pos & rb->mask) * rb->stride];
+}
+
+static inline atomic_size_t* ecbuff_mpmc_slot_of(void* const restrict element)
+{
+    return (atomic_size_t*)((char*)element - ECBUFF_MPMC_HDR);
+}
+
+void ecbuff_mpmc_init(ecbuff_mpmc* const restrict rb, const ECB_UINT_T count, const ECB_UINT_T element_size)
+{
+    ASSERT(rb);
+    ASSERT(count >= 2);
+    ASSERT(!(count & (count - 1)));
+    ASSERT(element_size);
+    rb->mask = count - 1;
+    rb->element_size = element_size;
+    rb->stride = ECBUFF_MPMC_STRIDE(element_size);
+    for(size_t i = 0; i < count; i++)
+        atomic_init(ecbuff_mpmc_slot(rb, i), i);
+    atomic_init(&rb->tail, 0);
+    atomic_init(&rb->head, 0);
+}
+
+/* Claim the slot for the next write position, NULL if full */
+static inline atomic_size_t* ecbuff_mpmc_claim_write(ecbuff_mpmc* const restrict rb)
+{
+    size_t pos = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    for(;;)
+    {
+        atomic_size_t* slot = ecbuff_mpmc_slot(rb, pos);
+        size_t seq = atomic_load_explicit(slot, memory_order_acquire);
+        intptr_t diff = (intptr_t)(seq - pos);
+        if(diff == 0)
+        {
+            if(atomic_compare_exchange_weak_explicit(&rb->tail, &pos, pos + 1,
+                                                     memory_order_relaxed, memory_order_relaxed))
+                return slot;
+            /* pos has been updated by the failed exchange */
+        }
+        else if(diff < 0)
+            return NULL;
+        else
+            pos = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    }
+}
+
+/* Claim the slot for the next read position, NULL if empty */
+static inline atomic_size_t* ecbuff_mpmc_claim_read(ecbuff_mpmc* const restrict rb)
+{
+    size_t pos = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    for(;;)
+    {
+        atomic_size_t* slot = ecbuff_mpmc_slot(rb, pos);
+        size_t seq = atomic_load_explicit(slot, memory_order_acquire);
+        intptr_t diff = (intptr_t)(seq - (pos + 1));
+        if(diff == 0)
+        {
+            if(atomic_compare_exchange_weak_explicit(&rb->head, &pos, pos + 1,
+                                                     memory_order_relaxed, memory_order_relaxed))
+                return slot;
+        }
+        else if(diff < 0)
+            return NULL;
+        else
+            pos = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    }
+}
+
+/* A claimed write slot holds its position as sequence number, publish it as ready */
+static inline void ecbuff_mpmc_publish(atomic_size_t* const restrict slot)
+{
+    size_t pos = atomic_load_explicit(slot, memory_order_relaxed);
+    atomic_store_explicit(slot, pos + 1, memory_order_release);
+}
+
+/* A claimed read slot holds its position + 1, release it for the next lap */
+static inline void ecbuff_mpmc_release(ecbuff_mpmc* const restrict rb, atomic_size_t* const restrict slot)
+{
+    size_t seq = atomic_load_explicit(slot, memory_order_relaxed);
+    atomic_store_explicit(slot, seq + rb->mask, memory_order_release);
+}
+
+bool ecbuff_mpmc_write(ecbuff_mpmc* const restrict rb, const void* const restrict element)
+{
+    ASSERT(rb);
+    ASSERT(element);
+    atomic_size_t* slot = ecbuff_mpmc_claim_write(rb);
+    if(!slot)
+        return false;
+    memcpy((char*)slot + ECBUFF_MPMC_HDR, element, rb->element_size);
+    ecbuff_mpmc_publish(slot);
+    return true;
+}
+
+bool ecbuff_mpmc_read(ecbuff_mpmc* const restrict rb, void* const restrict element)
+{
+    ASSERT(rb);
+    ASSERT(element);
+    atomic_size_t* slot = ecbuff_mpmc_claim_read(rb);
+    if(!slot)
+        return false;
+    memcpy(element, (char*)slot + ECBUFF_MPMC_HDR, rb->element_size);
+    ecbuff_mpmc_release(rb, slot);
+    return true;
+}
+
+ECB_UINT_T ecbuff_mpmc_used(const ecbuff_mpmc* const restrict rb)
+{
+    ASSERT(rb);
+    size_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+    size_t used = tail - head;
+    /* Positions are read one after another, clamp transient values */
+    if((intptr_t)used < 0)
+        return 0;
+    if(used > rb->mask + 1)
+        return rb->mask + 1;
+    return used;
+}
+
+bool ecbuff_mpmc_is_empty(const ecbuff_mpmc* const restrict rb)
+{
+    return ecbuff_mpmc_used(rb) == 0;
+}
+
+#ifdef ECB_DIRECT_ACCESS
+void* ecbuff_mpmc_write_alloc(ecbuff_mpmc* const restrict rb)
+{
+    ASSERT(rb);
+    atomic_size_t* slot = ecbuff_mpmc_claim_write(rb);
+    if(!slot)
+        return NULL;
+    return (char*)slot + ECBUFF_MPMC_HDR;
+}
+
+void ecbuff_mpmc_write_enqueue(ecbuff_mpmc* const restrict rb, void* const restrict element)
+{
+    ASSERT(rb);
+    ASSERT(element);
+    (void)rb;
+    ecbuff_mpmc_publish(ecbuff_mpmc_slot_of(element));
+}
+
+void* ecbuff_mpmc_read_dequeue(ecbuff_mpmc* const restrict rb)
+{
+    ASSERT(rb);
+    atomic_size_t* slot = ecbuff_mpmc_claim_read(rb);
+    if(!slot)
+        return NULL;
+    return (char*)slot + ECBUFF_MPMC_HDR;
+}
+
+void ecbuff_mpmc_read_free(ecbuff_mpmc* const restrict rb, void* const restrict element)
+{
+    ASSERT(rb);
+    ASSERT(element);
+    ecbuff_mpmc_release(rb, ecbuff_mpmc_slot_of(element));
+}
+#endif
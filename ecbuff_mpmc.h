@@ -0,0 +1,72 @@
+/*
+ * ecbuff_mpmc is a bounded lock-free multi-producer/multi-consumer variant
+ * of ecbuff. Any number of threads may write and read concurrently. Every
+ * slot carries a sequence number that tells producers whether it is free
+ * and consumers whether it is ready, so only the shared head and tail
+ * positions are subject to compare-and-swap. Contention is thus limited to
+ * claiming a position, copying happens in parallel.
+ *
+ * Like ecbuff it works on fixed size elements in caller-provided storage
+ * and offers a copying as well as a two staged direct access API. Other than
+ * ecbuff it requires C11 atomics and a power of two element count.
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#ifndef ECBUFF_MPMC_H
+#define ECBUFF_MPMC_H
+
+#include "ecbuff.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+#if !defined(ECB_CACHELINE)
+#define ECB_CACHELINE 64
+#endif
+
+typedef struct {
+    size_t mask;                                /* element count - 1 */
+    size_t element_size;
+    size_t stride;                              /* bytes per slot, sequence number included */
+    char pad_config[ECB_CACHELINE - 3 * sizeof(size_t)];
+    atomic_size_t tail;                         /* next position to be claimed by a producer */
+    char pad_tail[ECB_CACHELINE - sizeof(atomic_size_t)];
+    atomic_size_t head;                         /* next position to be claimed by a consumer */
+    char pad_head[ECB_CACHELINE - sizeof(atomic_size_t)];
+    char slots[];                               /* count * stride bytes */
+} ecbuff_mpmc;
+
+/* Per slot header, the element follows it directly */
+#define ECBUFF_MPMC_HDR sizeof(atomic_size_t)
+#define ECBUFF_MPMC_STRIDE(element_size) \
+    ((ECBUFF_MPMC_HDR + (element_size) + ECBUFF_MPMC_HDR - 1) / ECBUFF_MPMC_HDR * ECBUFF_MPMC_HDR)
+/* Number of bytes to allocate for an instance holding count elements */
+#define ECBUFF_MPMC_SIZE(count, element_size) \
+    (sizeof(ecbuff_mpmc) + (size_t)(count) * ECBUFF_MPMC_STRIDE(element_size))
+
+/* ecbuff_mpmc_init
+ * count has to be a power of two and at least 2.
+ * rb has to provide ECBUFF_MPMC_SIZE(count, element_size) bytes.
+ */
+void ecbuff_mpmc_init(ecbuff_mpmc* const restrict rb, const ECB_UINT_T count, const ECB_UINT_T element_size);
+/* Return false if the buffer was full (write) or empty (read) */
+bool ecbuff_mpmc_write(ecbuff_mpmc* const restrict rb, const void* const restrict element);
+bool ecbuff_mpmc_read(ecbuff_mpmc* const restrict rb, void* const restrict element);
+/* Snapshots, may be outdated as soon as they return */
+ECB_UINT_T ecbuff_mpmc_used(const ecbuff_mpmc* const restrict rb);
+bool ecbuff_mpmc_is_empty(const ecbuff_mpmc* const restrict rb);
+
+#ifdef ECB_DIRECT_ACCESS
+/* ecbuff_mpmc_write_alloc() returns NULL if full, otherwise the claimed
+ * element is passed to ecbuff_mpmc_write_enqueue() once written.
+ * ecbuff_mpmc_read_dequeue() returns NULL if empty, otherwise the claimed
+ * element is passed to ecbuff_mpmc_read_free() once read.
+ * Claimed elements may be committed in any order and from any thread.
+ */
+void* ecbuff_mpmc_write_alloc(ecbuff_mpmc* const restrict rb);
+void ecbuff_mpmc_write_enqueue(ecbuff_mpmc* const restrict rb, void* const restrict element);
+void* ecbuff_mpmc_read_dequeue(ecbuff_mpmc* const restrict rb);
+void ecbuff_mpmc_read_free(ecbuff_mpmc* const restrict rb, void* const restrict element);
+#endif // ECB_DIRECT_ACCESS
+
+#endif // ECBUFF_MPMC_H
@@ -0,0 +1,269 @@
+/*
+ * Tests for ecbuff_mpmc
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#include "ecbuff_mpmc.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define ECBMT_PRODUCERS 4
+#define ECBMT_CONSUMERS 4
+#define ECBMT_PER_PRODUCER 20000
+
+typedef struct {
+    uint32_t producer;
+    uint32_t seq;
+} ecbmt_tag;
+
+typedef struct {
+    ecbuff_mpmc* buff;
+    uint32_t id;
+    uint64_t count[ECBMT_PRODUCERS];
+    uint64_t sum[ECBMT_PRODUCERS];
+} ecbmt_thread;
+
+static atomic_uint ecbmt_done;
+
+ecbuff_mpmc* ecbmt_new(ECB_UINT_T count, ECB_UINT_T element_size);
+void ecbmt_delete(ecbuff_mpmc* buff);
+void ecbmt_test_st_basic(ECB_UINT_T count);
+void ecbmt_test_mt_stress(ECB_UINT_T count);
+void* ecbmt_mt_source(void* arg);
+void* ecbmt_mt_sink(void* arg);
+bool ecbmt_put(ecbuff_mpmc* buff, const ecbmt_tag* tag, bool direct);
+bool ecbmt_get(ecbuff_mpmc* buff, ecbmt_tag* tag, bool direct);
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    ecbmt_test_st_basic(1337);
+    ecbmt_test_mt_stress(5);
+    return 0;
+}
+
+ecbuff_mpmc* ecbmt_new(ECB_UINT_T count, ECB_UINT_T element_size)
+{
+    ecbuff_mpmc* buff = malloc(ECBUFF_MPMC_SIZE(count, element_size));
+    assert(buff);
+    ecbuff_mpmc_init(buff, count, element_size);
+    assert(ecbuff_mpmc_is_empty(buff));
+    return buff;
+}
+
+void ecbmt_delete(ecbuff_mpmc* buff)
+{
+    assert(buff);
+    free(buff);
+}
+
+bool ecbmt_put(ecbuff_mpmc* buff, const ecbmt_tag* tag, bool direct)
+{
+    uint8_t value[ECBT_ELEM_SIZ];
+    memset(value, 0, ECBT_ELEM_SIZ);
+    memcpy(value, tag, sizeof(*tag));
+#if defined(ECB_DIRECT_ACCESS)
+    if(direct)
+    {
+        void* ptr = ecbuff_mpmc_write_alloc(buff);
+        if(!ptr)
+            return false;
+        memcpy(ptr, value, ECBT_ELEM_SIZ);
+        ecbuff_mpmc_write_enqueue(buff, ptr);
+        return true;
+    }
+#else
+    (void)direct;
+#endif
+    return ecbuff_mpmc_write(buff, value);
+}
+
+bool ecbmt_get(ecbuff_mpmc* buff, ecbmt_tag* tag, bool direct)
+{
+    uint8_t value[ECBT_ELEM_SIZ];
+#if defined(ECB_DIRECT_ACCESS)
+    if(direct)
+    {
+        void* ptr = ecbuff_mpmc_read_dequeue(buff);
+        if(!ptr)
+            return false;
+        memcpy(value, ptr, ECBT_ELEM_SIZ);
+        ecbuff_mpmc_read_free(buff, ptr);
+        memcpy(tag, value, sizeof(*tag));
+        return true;
+    }
+#else
+    (void)direct;
+#endif
+    if(!ecbuff_mpmc_read(buff, value))
+        return false;
+    memcpy(tag, value, sizeof(*tag));
+    return true;
+}
+
+void ecbmt_test_st_basic(ECB_UINT_T count)
+{
+    ecbuff_mpmc* buff = ecbmt_new(ECBT_ELEM_CNT, ECBT_ELEM_SIZ);
+    ecbmt_tag wtag = {0, 0};
+    ecbmt_tag rtag = {0, 0};
+
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        ECB_UINT_T num = rand() % (ECBT_ELEM_CNT - ecbuff_mpmc_used(buff) + 1);
+        for(ECB_UINT_T j = 0; j < num; j++, wtag.seq++)
+            assert(ecbmt_put(buff, &wtag, wtag.seq & 1));
+        if(ecbuff_mpmc_used(buff) == ECBT_ELEM_CNT)
+        {
+            assert(!ecbmt_put(buff, &wtag, false));
+            assert(!ecbmt_put(buff, &wtag, true));
+        }
+
+        num = rand() % (ecbuff_mpmc_used(buff) + 1);
+        for(ECB_UINT_T j = 0; j < num; j++)
+        {
+            ecbmt_tag tag;
+            assert(ecbmt_get(buff, &tag, j & 1));
+            if(tag.seq != rtag.seq)
+            {
+                printf("Read unexpected value! (%u instead of %u)\n", tag.seq, rtag.seq);
+                assert(false);
+                return;
+            }
+            rtag.seq++;
+        }
+        assert(ecbuff_mpmc_used(buff) == wtag.seq - rtag.seq);
+    }
+
+    while(!ecbuff_mpmc_is_empty(buff))
+    {
+        ecbmt_tag tag;
+        assert(ecbmt_get(buff, &tag, false));
+        assert(tag.seq == rtag.seq++);
+    }
+    ecbmt_tag tag;
+    assert(!ecbmt_get(buff, &tag, false));
+    assert(!ecbmt_get(buff, &tag, true));
+    ecbmt_delete(buff);
+}
+
+void ecbmt_test_mt_stress(ECB_UINT_T count)
+{
+    ecbuff_mpmc* buff = ecbmt_new(ECBT_ELEM_CNT, ECBT_ELEM_SIZ);
+
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        pthread_t threads[ECBMT_PRODUCERS + ECBMT_CONSUMERS];
+        ecbmt_thread args[ECBMT_PRODUCERS + ECBMT_CONSUMERS];
+        int ret[ECBMT_PRODUCERS + ECBMT_CONSUMERS];
+        memset(args, 0, sizeof(args));
+        atomic_store(&ecbmt_done, 0);
+        ecbuff_mpmc_init(buff, ECBT_ELEM_CNT, ECBT_ELEM_SIZ);
+
+        for(uint32_t t = 0; t < ECBMT_PRODUCERS + ECBMT_CONSUMERS; t++)
+        {
+            args[t].buff = buff;
+            args[t].id = t < ECBMT_PRODUCERS ? t : t - ECBMT_PRODUCERS;
+            if(pthread_create(&threads[t], NULL, t < ECBMT_PRODUCERS ? ecbmt_mt_source : ecbmt_mt_sink, &args[t]))
+            {
+                printf("Failed to spawn thread!\n");
+                assert(false);
+                return;
+            }
+        }
+
+        for(uint32_t t = 0; t < ECBMT_PRODUCERS + ECBMT_CONSUMERS; t++)
+        {
+            void* r;
+            pthread_join(threads[t], &r);
+            ret[t] = r != NULL;
+            if(!ret[t])
+            {
+                assert(false);
+                return;
+            }
+        }
+
+        /* Every element has been received exactly once */
+        for(uint32_t p = 0; p < ECBMT_PRODUCERS; p++)
+        {
+            uint64_t cnt = 0;
+            uint64_t sum = 0;
+            for(uint32_t c = 0; c < ECBMT_CONSUMERS; c++)
+            {
+                cnt += args[ECBMT_PRODUCERS + c].count[p];
+                sum += args[ECBMT_PRODUCERS + c].sum[p];
+            }
+            if(cnt != ECBMT_PER_PRODUCER || sum != (uint64_t)ECBMT_PER_PRODUCER * (ECBMT_PER_PRODUCER - 1) / 2)
+            {
+                printf("Producer %u: received %llu elements (sum %llu)!\n", p,
+                       (unsigned long long)cnt, (unsigned long long)sum);
+                assert(false);
+                return;
+            }
+        }
+        assert(ecbuff_mpmc_is_empty(buff));
+    }
+
+    ecbmt_delete(buff);
+}
+
+void* ecbmt_mt_source(void* arg)
+{
+    ecbmt_thread* t = arg;
+    ecbmt_tag tag = {t->id, 0};
+
+    while(tag.seq < ECBMT_PER_PRODUCER)
+    {
+        if(!ecbmt_put(t->buff, &tag, (tag.seq + t->id) & 1))
+        {
+            sched_yield();
+            continue;
+        }
+        tag.seq++;
+    }
+    atomic_fetch_add(&ecbmt_done, 1);
+
+    pthread_exit((void*)true);
+}
+
+void* ecbmt_mt_sink(void* arg)
+{
+    ecbmt_thread* t = arg;
+    int64_t last[ECBMT_PRODUCERS];
+    for(uint32_t p = 0; p < ECBMT_PRODUCERS; p++)
+        last[p] = -1;
+
+    for(uint32_t i = 0;; i++)
+    {
+        ecbmt_tag tag;
+        if(!ecbmt_get(t->buff, &tag, (i + t->id) & 1))
+        {
+            /* Only stop once all producers finished and nothing is left */
+            if(atomic_load(&ecbmt_done) == ECBMT_PRODUCERS && ecbuff_mpmc_is_empty(t->buff))
+                break;
+            sched_yield();
+            continue;
+        }
+        if(tag.producer >= ECBMT_PRODUCERS || (int64_t)tag.seq <= last[tag.producer])
+        {
+            /* Each consumer has to observe every producer's elements in order */
+            printf("Read unexpected value! (producer %u seq %u after %lld)\n", tag.producer, tag.seq,
+                   tag.producer < ECBMT_PRODUCERS ? (long long)last[tag.producer] : -1LL);
+            assert(false);
+            pthread_exit((void*)false);
+        }
+        last[tag.producer] = tag.seq;
+        t->count[tag.producer]++;
+        t->sum[tag.producer] += tag.seq;
+    }
+
+    pthread_exit((void*)true);
+}
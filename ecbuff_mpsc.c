@@ -0,0 +1,170 @@
+/* See ecbuff_mpsc.h for further information */
+
+#include "ecbuff_mpsc.h"
+#include <string.h>
+
+#if defined(ECB_ASSERT)
+#include <assert.h>
+
+#if !defined(ASSERT)
+//use standard assert() if nothing custom was defined
+#define ASSERT(x) assert(x)
+#endif
+
+#else
+#define NDEBUG
+#undef ASSERT	//ignore earlier definition from ecbuff_cfg.h
+#define ASSERT(x)
+#endif
+
+/* ECB_MPSC_YIELD()
+ * Called while a producer waits for its slot to be freed.
+ * Defaults to thrd_yield() where C11 threads are available.
+ */
+#if !defined(ECB_MPSC_YIELD)
+#if !defined(__STDC_NO_THREADS__)
+#include <threads.h>
+#define ECB_MPSC_YIELD() thrd_yield()
+#else
+#define ECB_MPSC_YIELD()
+#endif
+#endif
+
+/* Sequence numbers of slot i:
+ * i + n * count        free, to be written by the producer of position i + n * count
+ * i + n * count + 1    ready, to be read by the consumer at position i + n * count
+ */
+
+static inline atomic_size_t* ecbuff_mpsc_slot(const ecbuff_mpsc* const restrict rb, const size_t pos)
+{
+    return (atomic_size_t*)&rb->slots[(pos & rb->mask) * rb->stride];
+}
+
+void ecbuff_mpsc_init(ecbuff_mpsc* const restrict rb, const ECB_UINT_T count, const ECB_UINT_T element_size)
+{
+    ASSERT(rb);
+    ASSERT(count >= 2);
+    ASSERT(!(count & (count - 1)));
+    ASSERT(element_size);
+    rb->mask = count - 1;
+    rb->element_size = element_size;
+    rb->stride = ECBUFF_MPSC_STRIDE(element_size);
+    for(size_t i = 0; i < count; i++)
+        atomic_init(ecbuff_mpsc_slot(rb, i), i);
+    atomic_init(&rb->tail, 0);
+    atomic_init(&rb->head, 0);
+}
+
+/* Claim the next position and wait until its slot has been freed */
+static inline atomic_size_t* ecbuff_mpsc_claim(ecbuff_mpsc* const restrict rb)
+{
+    size_t pos = atomic_fetch_add_explicit(&rb->tail, 1, memory_order_relaxed);
+    atomic_size_t* slot = ecbuff_mpsc_slot(rb, pos);
+    while(atomic_load_explicit(slot, memory_order_acquire) != pos)
+        ECB_MPSC_YIELD();
+    return slot;
+}
+
+/* A claimed slot holds its position as sequence number, publish it as ready */
+static inline void ecbuff_mpsc_publish(atomic_size_t* const restrict slot)
+{
+    size_t pos = atomic_load_explicit(slot, memory_order_relaxed);
+    atomic_store_explicit(slot, pos + 1, memory_order_release);
+}
+
+/* Returns the slot at head if it is ready, NULL otherwise */
+static inline atomic_size_t* ecbuff_mpsc_ready(const ecbuff_mpsc* const restrict rb, const size_t head)
+{
+    atomic_size_t* slot = ecbuff_mpsc_slot(rb, head);
+    if(atomic_load_explicit(slot, memory_order_acquire) != head + 1)
+        return NULL;
+    return slot;
+}
+
+/* Free the slot at head for the next lap and advance */
+static inline void ecbuff_mpsc_advance(ecbuff_mpsc* const restrict rb, atomic_size_t* const restrict slot, const size_t head)
+{
+    atomic_store_explicit(slot, head + rb->mask + 1, memory_order_release);
+    atomic_store_explicit(&rb->head, head + 1, memory_order_release);
+}
+
+void ecbuff_mpsc_write(ecbuff_mpsc* const restrict rb, const void* const restrict element)
+{
+    ASSERT(rb);
+    ASSERT(element);
+    atomic_size_t* slot = ecbuff_mpsc_claim(rb);
+    memcpy((char*)slot + ECBUFF_MPSC_HDR, element, rb->element_size);
+    ecbuff_mpsc_publish(slot);
+}
+
+bool ecbuff_mpsc_read(ecbuff_mpsc* const restrict rb, void* const restrict element)
+{
+    ASSERT(rb);
+    ASSERT(element);
+    size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    atomic_size_t* slot = ecbuff_mpsc_ready(rb, head);
+    if(!slot)
+        return false;
+    memcpy(element, (char*)slot + ECBUFF_MPSC_HDR, rb->element_size);
+    ecbuff_mpsc_advance(rb, slot, head);
+    return true;
+}
+
+bool ecbuff_mpsc_is_empty(const ecbuff_mpsc* const restrict rb)
+{
+    ASSERT(rb);
+    size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    return !ecbuff_mpsc_ready(rb, head);
+}
+
+ECB_UINT_T ecbuff_mpsc_used(const ecbuff_mpsc* const restrict rb)
+{
+    ASSERT(rb);
+    size_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+    size_t used = tail - head;
+    /* Waiting producers may have claimed positions beyond the buffer's size */
+    if(used > rb->mask + 1)
+        return rb->mask + 1;
+    return used;
+}
+
+ECB_UINT_T ecbuff_mpsc_unused(const ecbuff_mpsc* const restrict rb)
+{
+    return rb->mask + 1 - ecbuff_mpsc_used(rb);
+}
+
+#ifdef ECB_DIRECT_ACCESS
+void* ecbuff_mpsc_write_alloc(ecbuff_mpsc* const restrict rb)
+{
+    ASSERT(rb);
+    return (char*)ecbuff_mpsc_claim(rb) + ECBUFF_MPSC_HDR;
+}
+
+void ecbuff_mpsc_write_enqueue(ecbuff_mpsc* const restrict rb, void* const restrict element)
+{
+    ASSERT(rb);
+    ASSERT(element);
+    (void)rb;
+    ecbuff_mpsc_publish((atomic_size_t*)((char*)element - ECBUFF_MPSC_HDR));
+}
+
+void* ecbuff_mpsc_read_dequeue(ecbuff_mpsc* const restrict rb)
+{
+    ASSERT(rb);
+    size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    atomic_size_t* slot = ecbuff_mpsc_ready(rb, head);
+    if(!slot)
+        return NULL;
+    return (char*)slot + ECBUFF_MPSC_HDR;
+}
+
+void ecbuff_mpsc_read_free(ecbuff_mpsc* const restrict rb)
+{
+    ASSERT(rb);
+    size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    atomic_size_t* slot = ecbuff_mpsc_slot(rb, head);
+    ASSERT(atomic_load_explicit(slot, memory_order_relaxed) == head + 1);
+    ecbuff_mpsc_advance(rb, slot, head);
+}
+#endif
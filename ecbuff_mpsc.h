@@ -0,0 +1,78 @@
+/*
+ * ecbuff_mpsc is a bounded multi-producer/single-consumer variant of ecbuff,
+ * meant for many worker threads feeding a single I/O thread (logging,
+ * telemetry). Producers claim a slot with a single atomic fetch-add and
+ * publish it through the slot's sequence number. The consumer reads in
+ * order without any read-modify-write operation, at about the cost of
+ * ecbuff_read().
+ *
+ * Since a position claimed by fetch-add can't be given back, writing to a
+ * full buffer waits (ECB_MPSC_YIELD) until the consumer frees the slot.
+ * Use ecbuff_mpsc_unused() to avoid waiting where this matters.
+ *
+ * Like ecbuff it works on fixed size elements in caller-provided storage
+ * and offers a copying as well as a two staged direct access API, the
+ * latter allowing producers to format records in place. It requires C11
+ * atomics and a power of two element count.
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#ifndef ECBUFF_MPSC_H
+#define ECBUFF_MPSC_H
+
+#include "ecbuff.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+#if !defined(ECB_CACHELINE)
+#define ECB_CACHELINE 64
+#endif
+
+typedef struct {
+    size_t mask;                                /* element count - 1 */
+    size_t element_size;
+    size_t stride;                              /* bytes per slot, sequence number included */
+    char pad_config[ECB_CACHELINE - 3 * sizeof(size_t)];
+    atomic_size_t tail;                         /* next position to be claimed by a producer */
+    char pad_tail[ECB_CACHELINE - sizeof(atomic_size_t)];
+    atomic_size_t head;                         /* next position to be read, written by the consumer only */
+    char pad_head[ECB_CACHELINE - sizeof(atomic_size_t)];
+    char slots[];                               /* count * stride bytes */
+} ecbuff_mpsc;
+
+/* Per slot header, the element follows it directly */
+#define ECBUFF_MPSC_HDR sizeof(atomic_size_t)
+#define ECBUFF_MPSC_STRIDE(element_size) \
+    ((ECBUFF_MPSC_HDR + (element_size) + ECBUFF_MPSC_HDR - 1) / ECBUFF_MPSC_HDR * ECBUFF_MPSC_HDR)
+/* Number of bytes to allocate for an instance holding count elements */
+#define ECBUFF_MPSC_SIZE(count, element_size) \
+    (sizeof(ecbuff_mpsc) + (size_t)(count) * ECBUFF_MPSC_STRIDE(element_size))
+
+/* ecbuff_mpsc_init
+ * count has to be a power of two and at least 2.
+ * rb has to provide ECBUFF_MPSC_SIZE(count, element_size) bytes.
+ */
+void ecbuff_mpsc_init(ecbuff_mpsc* const restrict rb, const ECB_UINT_T count, const ECB_UINT_T element_size);
+/* Any thread, waits while the claimed slot is still occupied */
+void ecbuff_mpsc_write(ecbuff_mpsc* const restrict rb, const void* const restrict element);
+/* Consumer only, returns false if the next element isn't ready yet */
+bool ecbuff_mpsc_read(ecbuff_mpsc* const restrict rb, void* const restrict element);
+bool ecbuff_mpsc_is_empty(const ecbuff_mpsc* const restrict rb);
+/* Snapshots, may be outdated as soon as they return */
+ECB_UINT_T ecbuff_mpsc_used(const ecbuff_mpsc* const restrict rb);
+ECB_UINT_T ecbuff_mpsc_unused(const ecbuff_mpsc* const restrict rb);
+
+#ifdef ECB_DIRECT_ACCESS
+/* Producers: ecbuff_mpsc_write_alloc() claims the next slot (waiting like
+ * ecbuff_mpsc_write() if occupied), ecbuff_mpsc_write_enqueue() publishes it.
+ * Consumer: ecbuff_mpsc_read_dequeue() returns the next ready element or NULL,
+ * ecbuff_mpsc_read_free() releases it.
+ */
+void* ecbuff_mpsc_write_alloc(ecbuff_mpsc* const restrict rb);
+void ecbuff_mpsc_write_enqueue(ecbuff_mpsc* const restrict rb, void* const restrict element);
+void* ecbuff_mpsc_read_dequeue(ecbuff_mpsc* const restrict rb);
+void ecbuff_mpsc_read_free(ecbuff_mpsc* const restrict rb);
+#endif // ECB_DIRECT_ACCESS
+
+#endif // ECBUFF_MPSC_H
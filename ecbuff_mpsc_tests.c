@@ -0,0 +1,231 @@
+/*
+ * Tests for ecbuff_mpsc
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#include "ecbuff_mpsc.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define ECBST_PRODUCERS 4
+#define ECBST_PER_PRODUCER 20000
+
+typedef struct {
+    uint32_t producer;
+    uint32_t seq;
+} ecbst_tag;
+
+typedef struct {
+    ecbuff_mpsc* buff;
+    uint32_t id;
+} ecbst_thread;
+
+static atomic_uint ecbst_done;
+
+ecbuff_mpsc* ecbst_new(ECB_UINT_T count, ECB_UINT_T element_size);
+void ecbst_delete(ecbuff_mpsc* buff);
+void ecbst_test_st_basic(ECB_UINT_T count);
+void ecbst_test_mt_stress(ECB_UINT_T count);
+void* ecbst_mt_source(void* arg);
+void ecbst_put(ecbuff_mpsc* buff, const ecbst_tag* tag, bool direct);
+bool ecbst_get(ecbuff_mpsc* buff, ecbst_tag* tag, bool direct);
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    ecbst_test_st_basic(1337);
+    ecbst_test_mt_stress(5);
+    return 0;
+}
+
+ecbuff_mpsc* ecbst_new(ECB_UINT_T count, ECB_UINT_T element_size)
+{
+    ecbuff_mpsc* buff = malloc(ECBUFF_MPSC_SIZE(count, element_size));
+    assert(buff);
+    ecbuff_mpsc_init(buff, count, element_size);
+    assert(ecbuff_mpsc_is_empty(buff));
+    return buff;
+}
+
+void ecbst_delete(ecbuff_mpsc* buff)
+{
+    assert(buff);
+    free(buff);
+}
+
+void ecbst_put(ecbuff_mpsc* buff, const ecbst_tag* tag, bool direct)
+{
+    uint8_t value[ECBT_ELEM_SIZ];
+    memset(value, 0, ECBT_ELEM_SIZ);
+    memcpy(value, tag, sizeof(*tag));
+#if defined(ECB_DIRECT_ACCESS)
+    if(direct)
+    {
+        void* ptr = ecbuff_mpsc_write_alloc(buff);
+        assert(ptr);
+        memcpy(ptr, value, ECBT_ELEM_SIZ);
+        ecbuff_mpsc_write_enqueue(buff, ptr);
+        return;
+    }
+#else
+    (void)direct;
+#endif
+    ecbuff_mpsc_write(buff, value);
+}
+
+bool ecbst_get(ecbuff_mpsc* buff, ecbst_tag* tag, bool direct)
+{
+    uint8_t value[ECBT_ELEM_SIZ];
+#if defined(ECB_DIRECT_ACCESS)
+    if(direct)
+    {
+        void* ptr = ecbuff_mpsc_read_dequeue(buff);
+        if(!ptr)
+            return false;
+        memcpy(value, ptr, ECBT_ELEM_SIZ);
+        ecbuff_mpsc_read_free(buff);
+        memcpy(tag, value, sizeof(*tag));
+        return true;
+    }
+#else
+    (void)direct;
+#endif
+    if(!ecbuff_mpsc_read(buff, value))
+        return false;
+    memcpy(tag, value, sizeof(*tag));
+    return true;
+}
+
+void ecbst_test_st_basic(ECB_UINT_T count)
+{
+    ecbuff_mpsc* buff = ecbst_new(ECBT_ELEM_CNT, ECBT_ELEM_SIZ);
+    ecbst_tag wtag = {0, 0};
+    ecbst_tag rtag = {0, 0};
+
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        /* Writing to a full buffer would wait forever without a consumer */
+        ECB_UINT_T num = rand() % (ecbuff_mpsc_unused(buff) + 1);
+        for(ECB_UINT_T j = 0; j < num; j++, wtag.seq++)
+            ecbst_put(buff, &wtag, wtag.seq & 1);
+        assert(ecbuff_mpsc_used(buff) + ecbuff_mpsc_unused(buff) == ECBT_ELEM_CNT);
+
+        num = rand() % (ecbuff_mpsc_used(buff) + 1);
+        for(ECB_UINT_T j = 0; j < num; j++)
+        {
+            ecbst_tag tag;
+            assert(ecbst_get(buff, &tag, j & 1));
+            if(tag.seq != rtag.seq)
+            {
+                printf("Read unexpected value! (%u instead of %u)\n", tag.seq, rtag.seq);
+                assert(false);
+                return;
+            }
+            rtag.seq++;
+        }
+        assert(ecbuff_mpsc_used(buff) == wtag.seq - rtag.seq);
+    }
+
+    while(!ecbuff_mpsc_is_empty(buff))
+    {
+        ecbst_tag tag;
+        assert(ecbst_get(buff, &tag, false));
+        assert(tag.seq == rtag.seq++);
+    }
+    assert(ecbuff_mpsc_used(buff) == 0);
+    ecbst_tag tag;
+    assert(!ecbst_get(buff, &tag, false));
+    assert(!ecbst_get(buff, &tag, true));
+    ecbst_delete(buff);
+}
+
+void ecbst_test_mt_stress(ECB_UINT_T count)
+{
+    ecbuff_mpsc* buff = ecbst_new(ECBT_ELEM_CNT, ECBT_ELEM_SIZ);
+
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        pthread_t threads[ECBST_PRODUCERS];
+        ecbst_thread args[ECBST_PRODUCERS];
+        int64_t last[ECBST_PRODUCERS];
+        uint64_t cnt[ECBST_PRODUCERS];
+        uint64_t sum[ECBST_PRODUCERS];
+        memset(cnt, 0, sizeof(cnt));
+        memset(sum, 0, sizeof(sum));
+        atomic_store(&ecbst_done, 0);
+        ecbuff_mpsc_init(buff, ECBT_ELEM_CNT, ECBT_ELEM_SIZ);
+
+        for(uint32_t t = 0; t < ECBST_PRODUCERS; t++)
+        {
+            last[t] = -1;
+            args[t].buff = buff;
+            args[t].id = t;
+            if(pthread_create(&threads[t], NULL, ecbst_mt_source, &args[t]))
+            {
+                printf("Failed to spawn thread!\n");
+                assert(false);
+                return;
+            }
+        }
+
+        /* The main thread acts as the single consumer */
+        for(uint32_t n = 0;; n++)
+        {
+            ecbst_tag tag;
+            if(!ecbst_get(buff, &tag, n & 1))
+            {
+                /* Only stop once all producers finished and nothing is left */
+                if(atomic_load(&ecbst_done) == ECBST_PRODUCERS && ecbuff_mpsc_is_empty(buff))
+                    break;
+                sched_yield();
+                continue;
+            }
+            if(tag.producer >= ECBST_PRODUCERS || (int64_t)tag.seq != last[tag.producer] + 1)
+            {
+                /* Every producer's elements have to arrive in order and without gaps */
+                printf("Read unexpected value! (producer %u seq %u after %lld)\n", tag.producer, tag.seq,
+                       tag.producer < ECBST_PRODUCERS ? (long long)last[tag.producer] : -1LL);
+                assert(false);
+                return;
+            }
+            last[tag.producer] = tag.seq;
+            cnt[tag.producer]++;
+            sum[tag.producer] += tag.seq;
+        }
+
+        for(uint32_t t = 0; t < ECBST_PRODUCERS; t++)
+        {
+            pthread_join(threads[t], NULL);
+            if(cnt[t] != ECBST_PER_PRODUCER || sum[t] != (uint64_t)ECBST_PER_PRODUCER * (ECBST_PER_PRODUCER - 1) / 2)
+            {
+                printf("Producer %u: received %llu elements (sum %llu)!\n", t,
+                       (unsigned long long)cnt[t], (unsigned long long)sum[t]);
+                assert(false);
+                return;
+            }
+        }
+        assert(ecbuff_mpsc_used(buff) == 0);
+    }
+
+    ecbst_delete(buff);
+}
+
+void* ecbst_mt_source(void* arg)
+{
+    ecbst_thread* t = arg;
+    ecbst_tag tag = {t->id, 0};
+
+    for(; tag.seq < ECBST_PER_PRODUCER; tag.seq++)
+        ecbst_put(t->buff, &tag, (tag.seq + t->id) & 1);
+    atomic_fetch_add(&ecbst_done, 1);
+
+    pthread_exit((void*)true);
+}
@@ -0,0 +1,110 @@
+/* See ecbuff_ooo.h for further information */
+
+#include "ecbuff_ooo.h"
+#include <stddef.h>
+
+#if defined(ECB_ASSERT)
+#include <assert.h>
+
+#if !defined(ASSERT)
+//use standard assert() if nothing custom was defined
+#define ASSERT(x) assert(x)
+#endif
+
+#else
+#define NDEBUG
+#undef ASSERT	//ignore earlier definition from ecbuff_cfg.h
+#define ASSERT(x)
+#endif
+
+#if !defined(ECB_THREAD_MULTI)
+#error ecbuff_ooo requires ECB_THREAD_MULTI!
+#endif
+
+#if !defined(ECB_DIRECT_ACCESS)
+#error ecbuff_ooo requires ECB_DIRECT_ACCESS!
+#endif
+
+#define ECB_OOO_BIT(slot) ((uint64_t)1 << ((slot) % 64))
+
+void ecbuff_ooo_init(ecbuff_ooo* const restrict ooo, ecbuff* const restrict rb, _Atomic uint64_t* const restrict done)
+{
+    ASSERT(ooo);
+    ASSERT(rb);
+    ASSERT(done);
+    ASSERT(ecbuff_is_empty(rb));
+    ooo->rb = rb;
+    ooo->done = done;
+    ooo->slots = (ECB_UINT_T)(rb->total_size / rb->element_size);
+    for(ECB_UINT_T i = 0; i < ECB_OOO_WORDS(ooo->slots, 1); i++)
+        atomic_init(&done[i], 0);
+    /* A ring used before is empty at any rp, handing out and releasing
+     * start at the slot it points to */
+    ECB_UINT_T rp = (ECB_UINT_T)rb->rp;
+    ooo->next = (ECB_UINT_T)(rp % (ECB_UINT_T)rb->total_size / (ECB_UINT_T)rb->element_size);
+    ooo->taken = 0;
+    atomic_flag_clear(&ooo->lock);
+    ooo->head = ooo->next;
+    atomic_init(&ooo->freed, 0);
+}
+
+ECB_VOLATILE_T void* ecbuff_ooo_dequeue(ecbuff_ooo* const restrict ooo)
+{
+    ASSERT(ooo);
+    /* freed is stored after rp, loading it first can only underestimate
+     * what is ready beyond the outstanding elements */
+    ECB_UINT_T outstanding = ooo->taken - atomic_load_explicit(&ooo->freed, memory_order_acquire);
+    if(ecbuff_used(ooo->rb) <= outstanding)
+        return NULL;
+    atomic_thread_fence(memory_order_acquire);
+    ECB_VOLATILE_T void* element = &ooo->rb->elems[ooo->next * (ECB_UINT_T)ooo->rb->element_size];
+    if(++ooo->next == ooo->slots)
+        ooo->next = 0;
+    ooo->taken++;
+    return element;
+}
+
+ECB_UINT_T ecbuff_ooo_release(ecbuff_ooo* const restrict ooo, ECB_VOLATILE_T const void* const element)
+{
+    ASSERT(ooo);
+    ASSERT(element);
+    ECB_UINT_T slot = (ECB_UINT_T)(((ECB_VOLATILE_T const char*)element - ooo->rb->elems) / ooo->rb->element_size);
+    ASSERT(slot < ooo->slots);
+    uint64_t old = atomic_fetch_or(&ooo->done[slot / 64], ECB_OOO_BIT(slot));
+    ASSERT(!(old & ECB_OOO_BIT(slot)));
+    (void)old;
+
+    ECB_UINT_T count = 0;
+    while(!atomic_flag_test_and_set(&ooo->lock))
+    {
+        ECB_UINT_T head = ooo->head;
+        ECB_UINT_T n = 0;
+        while(atomic_load(&ooo->done[head / 64]) & ECB_OOO_BIT(head))
+        {
+            atomic_fetch_and_explicit(&ooo->done[head / 64], ~ECB_OOO_BIT(head), memory_order_relaxed);
+            if(++head == ooo->slots)
+                head = 0;
+            n++;
+        }
+        if(n)
+        {
+            ooo->head = head;
+            ecbuff_read_free_n(ooo->rb, n);
+            atomic_store_explicit(&ooo->freed, atomic_load_explicit(&ooo->freed, memory_order_relaxed) + n,
+                                  memory_order_release);
+            count += n;
+        }
+        atomic_flag_clear(&ooo->lock);
+        /* A releaser that found the lock held set its bit before, either it
+         * was seen above or it is seen here */
+        if(!(atomic_load(&ooo->done[head / 64]) & ECB_OOO_BIT(head)))
+            break;
+    }
+    return count;
+}
+
+ECB_UINT_T ecbuff_ooo_pending(ecbuff_ooo* const restrict ooo)
+{
+    ASSERT(ooo);
+    return ooo->taken - atomic_load_explicit(&ooo->freed, memory_order_relaxed);
+}
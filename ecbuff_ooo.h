@@ -0,0 +1,73 @@
+/*
+ * ecbuff_ooo lets the consumer of an ecbuff hand dequeued elements to
+ * asynchronous workers (threads, DMA) and have them released in any order,
+ * while they stay in place. A completion bitmap holds a bit per slot.
+ * Releasing an element sets its bit, then rp is advanced over the longest
+ * prefix of released slots with a single ecbuff_read_free_n(). Elements
+ * dequeued later but completed early thus wait for the oldest one before
+ * their slots return to the producer.
+ *
+ * ecbuff_ooo_dequeue() is called by the consumer thread only, while
+ * ecbuff_ooo_release() may be called from any thread. Advancing rp is
+ * serialised by a try-lock. A releaser finding it held leaves the work to
+ * the holder, which rechecks the bitmap after unlocking, so no release is
+ * left stranded.
+ *
+ * Requires ECB_THREAD_MULTI, ECB_DIRECT_ACCESS and C11 atomics.
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#ifndef ECBUFF_OOO_H
+#define ECBUFF_OOO_H
+
+#include "ecbuff.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+#if !defined(ECB_CACHELINE)
+#define ECB_CACHELINE 64
+#endif
+
+/* Number of bitmap words to allocate for a buffer */
+#define ECB_OOO_WORDS(total_size, element_size) (((total_size) / (element_size) + 63) / 64)
+
+typedef struct {
+    ecbuff* rb;
+    _Atomic uint64_t* done;                     /* bit per slot, set once released */
+    ECB_UINT_T slots;
+    /* Consumer */
+    _Alignas(ECB_CACHELINE) ECB_UINT_T next;    /* slot handed out next */
+    ECB_UINT_T taken;                           /* elements dequeued, wraps */
+    /* Releasers */
+    _Alignas(ECB_CACHELINE) atomic_flag lock;   /* held while advancing rp */
+    ECB_UINT_T head;                            /* slot at rp */
+    _Atomic ECB_UINT_T freed;                   /* elements freed, wraps */
+} ecbuff_ooo;
+
+/* ecbuff_ooo_init
+ * Attaches done, an array of ECB_OOO_WORDS(total_size, element_size)
+ * words, to rb while it is empty, either right after ecbuff_init() or once
+ * drained. The consumer then uses ecbuff_ooo_dequeue() instead of the
+ * other read functions.
+ */
+void ecbuff_ooo_init(ecbuff_ooo* const restrict ooo, ecbuff* const restrict rb, _Atomic uint64_t* const restrict done);
+
+/* ecbuff_ooo_dequeue
+ * Returns the oldest ready element not handed out yet, or NULL.
+ */
+ECB_VOLATILE_T void* ecbuff_ooo_dequeue(ecbuff_ooo* const restrict ooo);
+
+/* ecbuff_ooo_release
+ * Marks a dequeued element as completed, from any thread. Returns the
+ * number of elements freed for the producer by this call, 0 while an older
+ * element is still outstanding.
+ */
+ECB_UINT_T ecbuff_ooo_release(ecbuff_ooo* const restrict ooo, ECB_VOLATILE_T const void* const element);
+
+/* ecbuff_ooo_pending
+ * Number of elements dequeued but not yet freed, consumer side.
+ */
+ECB_UINT_T ecbuff_ooo_pending(ecbuff_ooo* const restrict ooo);
+
+#endif // ECBUFF_OOO_H
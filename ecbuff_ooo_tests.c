@@ -0,0 +1,297 @@
+/*
+ * Tests for ecbuff_ooo
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#if !defined(_GNU_SOURCE) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "ecbuff_ooo.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(ECB_POW2)
+#define ECBT_ELEM_CNT (ECBT_BUFF_SIZ / ECBT_ELEM_SIZ)
+#else
+#define ECBT_ELEM_CNT ((ECBT_BUFF_SIZ / ECBT_ELEM_SIZ) - 1)
+#endif
+
+#define ECBOOO_COUNT 100000
+#define ECBOOO_WORKERS 3
+
+/* Elements handed from the consumer to the workers */
+typedef struct {
+    pthread_mutex_t mutex;
+    ECB_VOLATILE_T uint8_t* elements[ECBT_ELEM_CNT];
+    uint32_t seqs[ECBT_ELEM_CNT];
+    uint32_t count;
+    bool done;
+} ecbooo_queue;
+
+typedef struct {
+    ecbuff_ooo* ooo;
+    ecbooo_queue* queue;
+    unsigned int seed;
+} ecbooo_worker;
+
+ecbuff* ecbooo_new(ecbuff_ooo* ooo);
+void ecbooo_delete(ecbuff_ooo* ooo);
+void ecbooo_value(uint8_t* value, uint32_t seq);
+void ecbooo_check(ECB_VOLATILE_T uint8_t* element, uint32_t seq);
+void ecbooo_test_st(void);
+void ecbooo_test_drained(void);
+void ecbooo_test_mt(void);
+void* ecbooo_mt_source(void* arg);
+void* ecbooo_mt_worker(void* arg);
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    ecbooo_test_st();
+    ecbooo_test_drained();
+    ecbooo_test_mt();
+    return 0;
+}
+
+ecbuff* ecbooo_new(ecbuff_ooo* ooo)
+{
+    ecbuff* rb = malloc(sizeof(ecbuff) + ECBT_BUFF_SIZ);
+    _Atomic uint64_t* done = malloc(ECB_OOO_WORDS(ECBT_BUFF_SIZ, ECBT_ELEM_SIZ) * sizeof(*done));
+    assert(rb && done);
+    ecbuff_init(rb, ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+    ecbuff_ooo_init(ooo, rb, done);
+    return rb;
+}
+
+void ecbooo_delete(ecbuff_ooo* ooo)
+{
+    free((void*)ooo->done);
+    free(ooo->rb);
+}
+
+void ecbooo_value(uint8_t* value, uint32_t seq)
+{
+    memset(value, (uint8_t)(seq * 7 + 1), ECBT_ELEM_SIZ);
+    memcpy(value, &seq, ECBT_ELEM_SIZ < sizeof(seq) ? ECBT_ELEM_SIZ : sizeof(seq));
+}
+
+void ecbooo_check(ECB_VOLATILE_T uint8_t* element, uint32_t seq)
+{
+    uint8_t expected[ECBT_ELEM_SIZ];
+    ecbooo_value(expected, seq);
+    for(size_t i = 0; i < ECBT_ELEM_SIZ; i++)
+    {
+        if(element[i] != expected[i])
+        {
+            printf("Read unexpected value! (element %u)\n", seq);
+            assert(false);
+        }
+    }
+}
+
+/* Fills the ring, dequeues everything and releases newest first, then in a
+ * random order over many rounds, which also crosses the wrap point */
+void ecbooo_test_st(void)
+{
+    ecbuff_ooo ooo;
+    ecbuff* rb = ecbooo_new(&ooo);
+    ECB_VOLATILE_T uint8_t* held[ECBT_ELEM_CNT];
+    uint8_t value[ECBT_ELEM_SIZ];
+    uint32_t seq = 0, first = 0;
+    assert(!ecbuff_ooo_dequeue(&ooo));
+
+    for(int round = 0; round < 100; round++)
+    {
+        ECB_UINT_T n = round ? (ECB_UINT_T)(rand() % ECBT_ELEM_CNT) + 1 : ECBT_ELEM_CNT;
+        for(ECB_UINT_T i = 0; i < n; i++)
+        {
+            ecbooo_value(value, seq++);
+            ecbuff_write(rb, value);
+        }
+        for(ECB_UINT_T i = 0; i < n; i++)
+        {
+            held[i] = ecbuff_ooo_dequeue(&ooo);
+            assert(held[i]);
+            ecbooo_check(held[i], first + (uint32_t)i);
+        }
+        assert(!ecbuff_ooo_dequeue(&ooo));
+        assert(ecbuff_ooo_pending(&ooo) == n);
+
+        if(!round)
+        {
+            /* Nothing is freed before the oldest element */
+            for(ECB_UINT_T i = n - 1; i > 0; i--)
+                assert(ecbuff_ooo_release(&ooo, held[i]) == 0);
+            assert(ecbuff_used(rb) == n);
+            assert(ecbuff_ooo_release(&ooo, held[0]) == n);
+        }
+        else
+        {
+            ECB_UINT_T freed = 0;
+            for(ECB_UINT_T i = n; i > 0; i--)
+            {
+                ECB_UINT_T pick = (ECB_UINT_T)rand() % i;
+                ECB_VOLATILE_T uint8_t* element = held[pick];
+                held[pick] = held[i - 1];
+                freed += ecbuff_ooo_release(&ooo, element);
+                assert(ecbuff_used(rb) == n - freed);
+            }
+            assert(freed == n);
+        }
+        assert(ecbuff_is_empty(rb));
+        assert(ecbuff_ooo_pending(&ooo) == 0);
+        first = seq;
+    }
+    ecbooo_delete(&ooo);
+}
+
+/* Attaching to a drained ring, rp no longer points to slot 0 */
+void ecbooo_test_drained(void)
+{
+    ecbuff* rb = malloc(sizeof(ecbuff) + ECBT_BUFF_SIZ);
+    _Atomic uint64_t* done = malloc(ECB_OOO_WORDS(ECBT_BUFF_SIZ, ECBT_ELEM_SIZ) * sizeof(*done));
+    assert(rb && done);
+    ecbuff_init(rb, ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+    uint8_t value[ECBT_ELEM_SIZ];
+    ECB_UINT_T skip = (ECBT_ELEM_CNT + 1) / 2;
+    for(ECB_UINT_T i = 0; i < skip; i++)
+    {
+        ecbooo_value(value, UINT32_MAX);
+        ecbuff_write(rb, value);
+        ecbuff_read(rb, value);
+    }
+
+    ecbuff_ooo ooo;
+    ecbuff_ooo_init(&ooo, rb, done);
+    ECB_VOLATILE_T uint8_t* held[ECBT_ELEM_CNT];
+    for(uint32_t seq = 0; seq < ECBT_ELEM_CNT; seq++)
+    {
+        ecbooo_value(value, seq);
+        ecbuff_write(rb, value);
+    }
+    for(uint32_t seq = 0; seq < ECBT_ELEM_CNT; seq++)
+    {
+        held[seq] = ecbuff_ooo_dequeue(&ooo);
+        assert(held[seq]);
+        ecbooo_check(held[seq], seq);
+    }
+    assert(!ecbuff_ooo_dequeue(&ooo));
+    for(ECB_UINT_T i = ECBT_ELEM_CNT - 1; i > 0; i--)
+        assert(ecbuff_ooo_release(&ooo, held[i]) == 0);
+    assert(ecbuff_ooo_release(&ooo, held[0]) == ECBT_ELEM_CNT);
+    assert(ecbuff_is_empty(rb));
+    ecbooo_delete(&ooo);
+}
+
+/* The consumer hands elements to workers releasing them in random order,
+ * they check the contents before, so a slot freed early gets noticed */
+void ecbooo_test_mt(void)
+{
+    ecbuff_ooo ooo;
+    ecbuff* rb = ecbooo_new(&ooo);
+    static ecbooo_queue queue;
+    pthread_mutex_init(&queue.mutex, NULL);
+    queue.count = 0;
+    queue.done = false;
+
+    pthread_t source, workers[ECBOOO_WORKERS];
+    ecbooo_worker args[ECBOOO_WORKERS];
+    if(pthread_create(&source, NULL, ecbooo_mt_source, rb))
+    {
+        printf("Failed to spawn thread!\n");
+        assert(false);
+        return;
+    }
+    for(int i = 0; i < ECBOOO_WORKERS; i++)
+    {
+        args[i].ooo = &ooo;
+        args[i].queue = &queue;
+        args[i].seed = (unsigned int)i + 1;
+        if(pthread_create(&workers[i], NULL, ecbooo_mt_worker, &args[i]))
+        {
+            printf("Failed to spawn thread!\n");
+            assert(false);
+            return;
+        }
+    }
+
+    for(uint32_t seq = 0; seq < ECBOOO_COUNT;)
+    {
+        ECB_VOLATILE_T uint8_t* element = ecbuff_ooo_dequeue(&ooo);
+        if(!element)
+        {
+            sched_yield();
+            continue;
+        }
+        ecbooo_check(element, seq);
+        pthread_mutex_lock(&queue.mutex);
+        assert(queue.count < ECBT_ELEM_CNT);
+        queue.elements[queue.count] = element;
+        queue.seqs[queue.count++] = seq++;
+        pthread_mutex_unlock(&queue.mutex);
+    }
+    pthread_mutex_lock(&queue.mutex);
+    queue.done = true;
+    pthread_mutex_unlock(&queue.mutex);
+
+    pthread_join(source, NULL);
+    for(int i = 0; i < ECBOOO_WORKERS; i++)
+        pthread_join(workers[i], NULL);
+    assert(ecbuff_is_empty(rb));
+    assert(ecbuff_ooo_pending(&ooo) == 0);
+    pthread_mutex_destroy(&queue.mutex);
+    ecbooo_delete(&ooo);
+}
+
+void* ecbooo_mt_source(void* arg)
+{
+    ecbuff* rb = arg;
+    uint8_t value[ECBT_ELEM_SIZ];
+    for(uint32_t seq = 0; seq < ECBOOO_COUNT; seq++)
+    {
+        while(ecbuff_is_full(rb))
+            sched_yield();
+        ecbooo_value(value, seq);
+        ecbuff_write(rb, value);
+    }
+    pthread_exit((void*)true);
+}
+
+void* ecbooo_mt_worker(void* arg)
+{
+    ecbooo_worker* w = arg;
+    ecbooo_queue* queue = w->queue;
+    for(;;)
+    {
+        pthread_mutex_lock(&queue->mutex);
+        if(!queue->count)
+        {
+            bool done = queue->done;
+            pthread_mutex_unlock(&queue->mutex);
+            if(done)
+                break;
+            sched_yield();
+            continue;
+        }
+        uint32_t pick = (uint32_t)rand_r(&w->seed) % queue->count;
+        ECB_VOLATILE_T uint8_t* element = queue->elements[pick];
+        uint32_t seq = queue->seqs[pick];
+        queue->count--;
+        queue->elements[pick] = queue->elements[queue->count];
+        queue->seqs[pick] = queue->seqs[queue->count];
+        pthread_mutex_unlock(&queue->mutex);
+
+        ecbooo_check(element, seq);
+        ecbuff_ooo_release(w->ooo, element);
+    }
+    pthread_exit((void*)true);
+}
@@ -0,0 +1,93 @@
+#!/usr/bin/env bash
+# Benchmarks for ecbuff
+# Builds ecbuff_bench for each configuration and runs it for each CPU
+# placement, element size and API. Results go to stdout as CSV (default)
+# or JSON lines, progress to stderr. Environment overrides:
+# CC, FORMAT (csv|json), COUNT, PING_COUNT, ELEM_SIZES, BUFF_SIZE
+# Written and placed into the public domain by
+# Elias Oenal <ecbuff@eliasoenal.com>
+
+set -e
+
+BUILD="ecb_build_bench"
+rm -rf "./${BUILD}"
+mkdir -p "./${BUILD}"
+
+CC=${CC:-cc}
+COMMON="-O2 -Wall -Wextra -DECB_NO_CFG -pthread -DECB_THREAD_MULTI -DECB_DIRECT_ACCESS"
+FILES="ecbuff.c ecbuff_copy.c ehist.c ecbuff_bench.c"
+ATOMIC="-DECB_ATOMIC_T=sig_atomic_t -DECB_ATOMIC_MAX=SIG_ATOMIC_MAX"
+UINT="-DECB_UINT_T=unsigned int"
+UINT_MAX="-DECB_UINT_MAX=UINT_MAX"
+
+FORMAT=${FORMAT:-csv}
+COUNT=${COUNT:-2000000}
+PING_COUNT=${PING_COUNT:-100000}
+ELEM_SIZES=${ELEM_SIZES:-"1 8 64 512"}
+BUFF_SIZE=${BUFF_SIZE:-65536}
+
+CONFIGS[1]="-DECB_THREAD_BARRIER"
+CONFIGS[2]="-DECB_THREAD_VOLATILE"
+CONFIGS[3]="-DECB_THREAD_ATOMIC"
+CONFIGS[4]="-DECB_THREAD_BARRIER -DECB_CACHE_PAD -DECB_POW2"
+CONFIGS[5]="-DECB_THREAD_ATOMIC -DECB_CACHE_PAD"
+CONFIGS[6]="-DECB_THREAD_ATOMIC -DECB_CACHE_PAD -DECB_POW2"
+CONFIGS[7]="-DECB_THREAD_VOLATILE -DECB_COPY=ECB_COPY_VBYTE"
+CONFIGS[8]="-DECB_THREAD_VOLATILE -DECB_COPY=ECB_COPY_VLINE"
+CONFIGS[9]="-DECB_THREAD_ATOMIC -DECB_CACHE_PAD -DECB_COPY=ECB_COPY_SIMD"
+CONFIGS[10]="-DECB_THREAD_ATOMIC -DECB_CACHE_PAD -DECB_COPY=ECB_COPY_STREAM"
+# Same as 6 with every 64th element timestamped
+CONFIGS[11]="-DECB_THREAD_ATOMIC -DECB_CACHE_PAD -DECB_POW2 -DECB_TIMESTAMP"
+
+# Pick CPU pairs from the topology: SMT siblings (or a single CPU) for
+# same_core, the first CPUs on different cores of one package for
+# cross_core, and the first CPUs of two packages for cross_socket.
+declare -A PAIRS
+CPUS=()
+for dir in /sys/devices/system/cpu/cpu[0-9]*; do
+    [ -r "${dir}/topology/core_id" ] || continue
+    CPUS+=("${dir##*cpu} $(cat ${dir}/topology/physical_package_id) $(cat ${dir}/topology/core_id)")
+done
+for a in "${CPUS[@]}"; do
+    read -r ca pa ka <<< "${a}"
+    for b in "${CPUS[@]}"; do
+        read -r cb pb kb <<< "${b}"
+        [ "${ca}" -lt "${cb}" ] || continue
+        if [ "${pa}" = "${pb}" ] && [ "${ka}" = "${kb}" ]; then
+            : ${PAIRS[same_core]:="${ca} ${cb}"}
+        elif [ "${pa}" = "${pb}" ]; then
+            : ${PAIRS[cross_core]:="${ca} ${cb}"}
+        else
+            : ${PAIRS[cross_socket]:="${ca} ${cb}"}
+        fi
+    done
+done
+# Without SMT both threads share a single CPU
+: ${PAIRS[same_core]:="0 0"}
+
+for placement in same_core cross_core cross_socket; do
+    if [ -z "${PAIRS[${placement}]}" ]; then
+        echo "Skipping ${placement}, not available on this machine" >&2
+    fi
+done
+
+HEADER="-H"
+for i in {1..11}; do
+BENCH="./${BUILD}/bench_${i}"
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${CONFIGS[$i]} ${FILES} -o ${BENCH}
+for placement in same_core cross_core cross_socket; do
+    [ -n "${PAIRS[${placement}]}" ] || continue
+    read -r pcpu ccpu <<< "${PAIRS[${placement}]}"
+    PIN="-p ${pcpu} -c ${ccpu} -P ${placement} -f ${FORMAT}"
+    for elem in ${ELEM_SIZES}; do
+        echo "${CONFIGS[$i]} ${placement} ${elem}b" >&2
+        for api in copy bulk direct; do
+            ${BENCH} ${HEADER} ${PIN} -m throughput -a ${api} -e ${elem} -b ${BUFF_SIZE} -n ${COUNT}
+            HEADER=""
+        done
+        for api in copy direct; do
+            ${BENCH} ${PIN} -m pingpong -a ${api} -e ${elem} -b ${BUFF_SIZE} -n ${PING_COUNT}
+        done
+    done
+done
+done
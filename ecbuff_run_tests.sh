@@ -12,9 +12,15 @@ mkdir -p "./${BUILD}"
 CC=cc
 COMMON="-Wall -Wextra -DECB_NO_CFG -DECB_ASSERT"
 FILES="ecbuff.c ecbuff_tests.c"
+WAIT_FILES="ecbuff_wait.c"
+COPY_FILES="ecbuff_copy.c"
+MIRROR_FILES="ecbuff_mirror.c"
 ATOMIC="-DECB_ATOMIC_T=sig_atomic_t -DECB_ATOMIC_MAX=SIG_ATOMIC_MAX"
 UINT="-DECB_UINT_T=unsigned int"
 UINT_MAX="-DECB_UINT_MAX=UINT_MAX"
+ATOMIC64="-DECB_ATOMIC_T=int64_t -DECB_ATOMIC_MAX=INT64_MAX"
+UINT64="-DECB_UINT_T=uint64_t"
+UINT64_MAX="-DECB_UINT_MAX=UINT64_MAX"
 SINGLE="-DECB_THREAD_SINGLE"
 MULTI="-pthread -DECB_THREAD_MULTI"
 
@@ -83,6 +89,10 @@ TESTNAME="multi_threaded_barrier_drop_extra"${SUFFIX[$i]}
 ${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_BARRIER -DECB_EXTRA_CHECKS -DECB_WRITE_DROP ${FILES} -o ./${BUILD}/${TESTNAME}
 if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
 
+TESTNAME="multi_threaded_barrier_basic_da"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_BARRIER ${DACCESS[2]} ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
 TESTNAME="multi_threaded_volatile_basic"${SUFFIX[$i]}
 ${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_VOLATILE ${FILES} -o ./${BUILD}/${TESTNAME}
 if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
@@ -96,4 +106,325 @@ ${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DEC
 if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
 done
 
+for i in {1..6}; do
+TESTNAME="single_threaded_pow2_drop_extra"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${SINGLE} -DECB_POW2 ${FILES} -DECB_EXTRA_CHECKS -DECB_WRITE_DROP -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="single_threaded_pow2_overwrite_extra"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${SINGLE} -DECB_POW2 ${DACCESS[2]} ${FILES} -DECB_EXTRA_CHECKS -DECB_WRITE_OVERWRITE -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_barrier_pow2_basic"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_BARRIER -DECB_POW2 ${DACCESS[2]} ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_barrier_pow2_drop_extra"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_BARRIER -DECB_POW2 -DECB_EXTRA_CHECKS -DECB_WRITE_DROP ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+
+for i in {1..6}; do
+TESTNAME="multi_threaded_barrier_pad_basic"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_BARRIER -DECB_CACHE_PAD ${DACCESS[2]} ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_barrier_pad_pow2_drop_extra"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_BARRIER -DECB_CACHE_PAD -DECB_POW2 -DECB_EXTRA_CHECKS -DECB_WRITE_DROP ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_volatile_pad_drop_extra"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_VOLATILE -DECB_CACHE_PAD -DECB_EXTRA_CHECKS -DECB_WRITE_DROP ${DACCESS[2]} ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+
+for i in {1..6}; do
+TESTNAME="multi_threaded_atomic_basic"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_atomic_drop"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC -DECB_WRITE_DROP ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_atomic_drop_extra"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC -DECB_EXTRA_CHECKS -DECB_WRITE_DROP ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_atomic_pad_pow2_basic"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC -DECB_CACHE_PAD -DECB_POW2 ${DACCESS[2]} ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_atomic_wait_drop_extra"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC -DECB_WAIT -DECB_EXTRA_CHECKS -DECB_WRITE_DROP ${FILES} ${WAIT_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_atomic_pad_wait_basic"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC -DECB_CACHE_PAD -DECB_WAIT ${DACCESS[2]} ${FILES} ${WAIT_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+
+for i in {1..6}; do
+TESTNAME="single_threaded_mirror_drop_extra"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${SINGLE} -DECB_MIRROR -DECB_EXTRA_CHECKS -DECB_WRITE_DROP ${DACCESS[2]} ${FILES} ${MIRROR_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="single_threaded_pow2_mirror_overwrite"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${SINGLE} -DECB_POW2 -DECB_MIRROR -DECB_WRITE_OVERWRITE ${FILES} ${MIRROR_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+# Requests a size that is not a power of two
+TESTNAME="single_threaded_pow2_mirror_uneven_overwrite"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${SINGLE} -DECB_POW2 -DECB_MIRROR -DECB_WRITE_OVERWRITE -DECBT_MIRROR_SIZ=9000 ${FILES} ${MIRROR_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_atomic_pad_mirror_basic"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC -DECB_CACHE_PAD -DECB_MIRROR ${DACCESS[2]} ${FILES} ${MIRROR_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+
+for i in {1..6}; do
+TESTNAME="single_threaded_stats_drop_extra"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${SINGLE} -DECB_STATS -DECB_EXTRA_CHECKS -DECB_WRITE_DROP ${DACCESS[2]} ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="single_threaded_pow2_stats_overwrite_extra"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${SINGLE} -DECB_POW2 -DECB_STATS -DECB_EXTRA_CHECKS -DECB_WRITE_OVERWRITE ${DACCESS[2]} ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_barrier_stats_basic"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_BARRIER -DECB_STATS ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_atomic_pad_stats_drop_extra"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC -DECB_CACHE_PAD -DECB_STATS -DECB_EXTRA_CHECKS -DECB_WRITE_DROP ${DACCESS[2]} ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+
+MPMC_FILES="ecbuff_mpmc.c ecbuff_mpmc_tests.c"
+MPMC_PARAMS[1]="-DECBT_ELEM_CNT=2    -DECBT_ELEM_SIZ=8"
+MPMC_PARAMS[2]="-DECBT_ELEM_CNT=64   -DECBT_ELEM_SIZ=8"
+MPMC_PARAMS[3]="-DECBT_ELEM_CNT=1024 -DECBT_ELEM_SIZ=64"
+MPMC_PARAMS[4]="-DECBT_ELEM_CNT=128  -DECBT_ELEM_SIZ=512"
+MPMC_SUFFIX[1]="_2x8b"
+MPMC_SUFFIX[2]="_64x8b"
+MPMC_SUFFIX[3]="_1024x64b"
+MPMC_SUFFIX[4]="_128x512b"
+
+for a in {1..2}; do
+for i in {1..4}; do
+TESTNAME="mpmc"${DACCESS_SUFFIX[$a]}${MPMC_SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${MPMC_PARAMS[$i]} -pthread ${DACCESS[a]} ${MPMC_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+done
+
+MPSC_FILES="ecbuff_mpsc.c ecbuff_mpsc_tests.c"
+
+for a in {1..2}; do
+for i in {1..4}; do
+TESTNAME="mpsc"${DACCESS_SUFFIX[$a]}${MPMC_SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${MPMC_PARAMS[$i]} -pthread ${DACCESS[a]} ${MPSC_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+done
+
+LOSSY_FILES="ecbuff_lossy.c ecbuff_lossy_tests.c"
+
+for a in {1..2}; do
+for i in {1..4}; do
+TESTNAME="lossy"${DACCESS_SUFFIX[$a]}${MPMC_SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${MPMC_PARAMS[$i]} -pthread ${DACCESS[a]} ${LOSSY_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+done
+
+BCAST_FILES="ecbuff_bcast.c ecbuff_bcast_tests.c"
+
+for a in {1..2}; do
+for i in {1..4}; do
+TESTNAME="bcast"${DACCESS_SUFFIX[$a]}${MPMC_SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${MPMC_PARAMS[$i]} -pthread ${DACCESS[a]} ${BCAST_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+done
+
+STAGE_FILES="ecbuff_stage.c ecbuff_stage_tests.c"
+
+for i in {1..4}; do
+TESTNAME="stage"${MPMC_SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${MPMC_PARAMS[$i]} -pthread ${STAGE_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+
+VAR_FILES="ecbuff_var.c ecbuff_var_tests.c"
+VAR_PARAMS[1]="-DECBT_VAR_SIZE=128"
+VAR_PARAMS[2]="-DECBT_VAR_SIZE=4096"
+VAR_PARAMS[3]="-DECBT_VAR_SIZE=16384"
+VAR_PARAMS[4]="-DECBT_VAR_SIZE=4096 -DECB_VAR_ALIGN=16"
+VAR_SUFFIX[1]="_128b"
+VAR_SUFFIX[2]="_4kb"
+VAR_SUFFIX[3]="_16kb"
+VAR_SUFFIX[4]="_4kb_align16"
+
+for i in {1..4}; do
+TESTNAME="var"${VAR_SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${VAR_PARAMS[$i]} -pthread ${VAR_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+
+SHM_FILES="ecbuff.c ecbuff_shm.c ecbuff_shm_tests.c"
+
+for i in {1..6}; do
+TESTNAME="shm_atomic"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC ${SHM_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="shm_barrier_pad_pow2"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_BARRIER -DECB_CACHE_PAD -DECB_POW2 ${SHM_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+
+# ECB_TIMESTAMP keeps process-local pointers in the ecbuff, building has to fail
+TESTNAME="shm_atomic_timestamp_rejected"
+if ! ${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[3]} ${MULTI} -DECB_THREAD_ATOMIC -DECB_TIMESTAMP ${SHM_FILES} ehist.c -o ./${BUILD}/${TESTNAME} 2>/dev/null; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+IO_FILES="ecbuff.c ecbuff_io.c ecbuff_io_tests.c"
+
+for i in {1..6}; do
+TESTNAME="io_single_threaded"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${SINGLE} ${DACCESS[2]} ${IO_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="io_atomic"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC ${DACCESS[2]} ${IO_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="io_barrier_pad_pow2"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_BARRIER -DECB_CACHE_PAD -DECB_POW2 ${DACCESS[2]} ${IO_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+
+DISK_FILES="ecbuff.c ecbuff_disk.c ecbuff_disk_tests.c"
+
+for i in {1..6}; do
+TESTNAME="disk_atomic"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC ${DISK_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="disk_barrier_pad_pow2"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_BARRIER -DECB_CACHE_PAD -DECB_POW2 ${DISK_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+
+for i in {1..6}; do
+TESTNAME="single_threaded_simd_drop_extra"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${SINGLE} -DECB_COPY=ECB_COPY_SIMD ${DACCESS[2]} -DECB_EXTRA_CHECKS -DECB_WRITE_DROP ${FILES} ${COPY_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="single_threaded_stream_overwrite"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${SINGLE} -DECB_COPY=ECB_COPY_STREAM -DECB_WRITE_OVERWRITE ${FILES} ${COPY_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_volatile_vbyte_drop_extra"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_VOLATILE -DECB_COPY=ECB_COPY_VBYTE -DECB_EXTRA_CHECKS -DECB_WRITE_DROP ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_volatile_vline_pad_basic"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_VOLATILE -DECB_COPY=ECB_COPY_VLINE -DECB_CACHE_PAD ${DACCESS[2]} ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_atomic_simd_basic"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC -DECB_COPY=ECB_COPY_SIMD ${FILES} ${COPY_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_atomic_pad_pow2_stream_basic"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC -DECB_CACHE_PAD -DECB_POW2 -DECB_COPY=ECB_COPY_STREAM ${DACCESS[2]} ${FILES} ${COPY_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_barrier_stream_drop_extra"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_BARRIER -DECB_COPY=ECB_COPY_STREAM -DECB_EXTRA_CHECKS -DECB_WRITE_DROP ${FILES} ${COPY_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+
+LARGE_FILES="ecbuff.c ecbuff_large.c ecbuff_large_tests.c"
+
+for i in {1..6}; do
+TESTNAME="single_threaded_drop_extra_da_idx64"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC64} ${UINT64} ${UINT64_MAX} ${TEST_PARAMS[$i]} ${SINGLE} ${DACCESS[2]} ${FILES} -DECB_EXTRA_CHECKS -DECB_WRITE_DROP -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_atomic_pad_pow2_basic_da_idx64"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC64} ${UINT64} ${UINT64_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC -DECB_CACHE_PAD -DECB_POW2 ${DACCESS[2]} ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="large_single_threaded"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${SINGLE} ${LARGE_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="large_single_threaded_da_idx64"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC64} ${UINT64} ${UINT64_MAX} ${TEST_PARAMS[$i]} ${SINGLE} ${DACCESS[2]} ${LARGE_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="large_atomic_pad_pow2_da_idx64"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC64} ${UINT64} ${UINT64_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC -DECB_CACHE_PAD -DECB_POW2 ${DACCESS[2]} ${LARGE_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+
+SET_FILES="ecbuff.c ecbuff_set.c ecbuff_set_tests.c"
+
+for i in {1..6}; do
+TESTNAME="set_atomic"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC ${SET_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="set_barrier_pad_pow2"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_BARRIER -DECB_CACHE_PAD -DECB_POW2 ${SET_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+
+EVENT_FILES="ecbuff.c ecbuff_event.c ecbuff_event_tests.c"
+
+for i in {1..6}; do
+TESTNAME="event_atomic"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC ${EVENT_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="event_barrier_pad_pow2"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_BARRIER -DECB_CACHE_PAD -DECB_POW2 ${EVENT_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+
+TIMESTAMP_FILES="ehist.c"
+
+for i in {1..6}; do
+TESTNAME="single_threaded_timestamp_drop_extra"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${SINGLE} -DECB_TIMESTAMP -DECB_TIMESTAMP_EVERY=4 -DECB_EXTRA_CHECKS -DECB_WRITE_DROP ${DACCESS[2]} ${FILES} ${TIMESTAMP_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="single_threaded_pow2_timestamp_overwrite_extra"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${SINGLE} -DECB_POW2 -DECB_TIMESTAMP -DECB_EXTRA_CHECKS -DECB_WRITE_OVERWRITE ${DACCESS[2]} ${FILES} ${TIMESTAMP_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_barrier_timestamp_basic"${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_BARRIER -DECB_TIMESTAMP -DECB_TIMESTAMP_EVERY=2 ${FILES} ${TIMESTAMP_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="multi_threaded_atomic_pad_pow2_timestamp_basic"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC -DECB_CACHE_PAD -DECB_POW2 -DECB_TIMESTAMP ${DACCESS[2]} ${FILES} ${TIMESTAMP_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+
+OOO_FILES="ecbuff.c ecbuff_ooo.c ecbuff_ooo_tests.c"
+
+for i in {1..6}; do
+TESTNAME="ooo_atomic"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_ATOMIC ${DACCESS[2]} ${OOO_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="ooo_barrier_pad_pow2"${DACCESS_SUFFIX[2]}${SUFFIX[$i]}
+${CC} ${COMMON} ${ATOMIC} "${UINT}" ${UINT_MAX} ${TEST_PARAMS[$i]} ${MULTI} -DECB_THREAD_BARRIER -DECB_CACHE_PAD -DECB_POW2 ${DACCESS[2]} ${OOO_FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+done
+
 echo -e "Total ${PASS} ${PASS_CNT} ${FAIL} ${FAIL_CNT}"
\ No newline at end of file
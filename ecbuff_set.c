@@ -0,0 +1,197 @@
+/* See ecbuff_set.h for further information */
+
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // syscall()
+#endif
+
+#include "ecbuff_set.h"
+#include <time.h>
+
+#if defined(ECB_ASSERT)
+#include <assert.h>
+
+#if !defined(ASSERT)
+//use standard assert() if nothing custom was defined
+#define ASSERT(x) assert(x)
+#endif
+
+#else
+#define NDEBUG
+#undef ASSERT	//ignore earlier definition from ecbuff_cfg.h
+#define ASSERT(x)
+#endif
+
+#if !defined(ECB_THREAD_MULTI)
+#error ecbuff_set requires ECB_THREAD_MULTI!
+#endif
+
+#if ECB_SET_MAX % 64
+#error ECB_SET_MAX has to be a multiple of 64!
+#endif
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static inline void ecbuff_set_park(_Atomic uint32_t* const restrict parked, const uint64_t timeout_ns)
+{
+    struct timespec ts = {(time_t)(timeout_ns / 1000000000u), (long)(timeout_ns % 1000000000u)};
+    syscall(SYS_futex, parked, FUTEX_WAIT_PRIVATE, 1, timeout_ns == UINT64_MAX ? NULL : &ts, NULL, 0);
+}
+
+static inline void ecbuff_set_wake(_Atomic uint32_t* const restrict parked)
+{
+    syscall(SYS_futex, parked, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+#else
+static inline void ecbuff_set_park(_Atomic uint32_t* const restrict parked, const uint64_t timeout_ns)
+{
+    (void)parked;
+    uint64_t ns = timeout_ns < ECB_SET_POLL_US * 1000u ? timeout_ns : ECB_SET_POLL_US * 1000u;
+    struct timespec ts = {0, (long)ns};
+    nanosleep(&ts, NULL);
+}
+
+static inline void ecbuff_set_wake(_Atomic uint32_t* const restrict parked)
+{
+    (void)parked;
+}
+#endif
+
+static inline uint64_t ecbuff_set_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void ecbuff_set_init(ecbuff_set* const restrict set)
+{
+    ASSERT(set);
+    for(int i = 0; i < ECB_SET_WORDS; i++)
+        atomic_init(&set->ready[i], 0);
+    atomic_init(&set->parked, 0);
+    set->count = 0;
+    set->next = 0;
+}
+
+int ecbuff_set_add(ecbuff_set* const restrict set, ecbuff* const restrict rb)
+{
+    ASSERT(set);
+    ASSERT(rb);
+    if(set->count >= ECB_SET_MAX)
+        return -1;
+    set->rings[set->count] = rb;
+    return (int)set->count++;
+}
+
+void ecbuff_set_notify(ecbuff_set* const restrict set, const int index)
+{
+    ASSERT(set);
+    ASSERT(index >= 0 && (uint32_t)index < set->count);
+    _Atomic uint64_t* word = &set->ready[index / 64];
+    uint64_t bit = (uint64_t)1 << (index % 64);
+    /* Orders publishing the ring before checking the bit, pairs with
+     * the fence in ecbuff_set_idle() */
+    atomic_thread_fence(memory_order_seq_cst);
+    if(atomic_load_explicit(word, memory_order_relaxed) & bit)
+        return;
+    atomic_fetch_or(word, bit);
+    if(atomic_load(&set->parked))
+    {
+        atomic_store_explicit(&set->parked, 0, memory_order_relaxed);
+        ecbuff_set_wake(&set->parked);
+    }
+}
+
+ECB_VOID_BOOL_T ecbuff_set_write(ecbuff_set* const restrict set, const int index, const void* const restrict element)
+{
+    ASSERT(set);
+    ASSERT(index >= 0 && (uint32_t)index < set->count);
+#if defined(ECB_EXTRA_CHECKS)
+    bool ret = ecbuff_write(set->rings[index], element);
+    ecbuff_set_notify(set, index);
+    return ret;
+#else
+    ecbuff_write(set->rings[index], element);
+    ecbuff_set_notify(set, index);
+#endif
+}
+
+ECB_UINT_T ecbuff_set_write_n(ecbuff_set* const restrict set, const int index, const void* const restrict elements,
+                              const ECB_UINT_T n)
+{
+    ASSERT(set);
+    ASSERT(index >= 0 && (uint32_t)index < set->count);
+    ECB_UINT_T ret = ecbuff_write_n(set->rings[index], elements, n);
+    if(ret)
+        ecbuff_set_notify(set, index);
+    return ret;
+}
+
+int ecbuff_set_poll(ecbuff_set* const restrict set)
+{
+    ASSERT(set);
+    uint32_t words = (set->count + 63) / 64;
+    if(!words)
+        return -1;
+    uint32_t start = set->next < set->count ? set->next : 0;
+    uint32_t w = start / 64;
+    /* First the start word from start on, then the remaining words, then
+     * the start word below start */
+    uint64_t mask = ~(uint64_t)0 << (start % 64);
+    for(uint32_t i = 0; i <= words; i++)
+    {
+        uint64_t ready = atomic_load_explicit(&set->ready[w], memory_order_relaxed) & mask;
+        if(ready)
+        {
+            uint32_t index = w * 64 + (uint32_t)__builtin_ctzll(ready);
+            set->next = index + 1;
+            return (int)index;
+        }
+        w = w + 1 < words ? w + 1 : 0;
+        mask = i + 1 < words ? ~(uint64_t)0 : ~(~(uint64_t)0 << (start % 64));
+    }
+    return -1;
+}
+
+bool ecbuff_set_idle(ecbuff_set* const restrict set, const int index)
+{
+    ASSERT(set);
+    ASSERT(index >= 0 && (uint32_t)index < set->count);
+    _Atomic uint64_t* word = &set->ready[index / 64];
+    uint64_t bit = (uint64_t)1 << (index % 64);
+    atomic_fetch_and(word, ~bit);
+    /* Pairs with the fence in ecbuff_set_notify(), either the producer
+     * sees the bit cleared or its write is seen here */
+    atomic_thread_fence(memory_order_seq_cst);
+    if(ecbuff_is_empty(set->rings[index]))
+        return true;
+    atomic_fetch_or(word, bit);
+    return false;
+}
+
+int ecbuff_set_wait(ecbuff_set* const restrict set, const uint32_t timeout_us)
+{
+    ASSERT(set);
+    int index = ecbuff_set_poll(set);
+    if(index >= 0 || !timeout_us)
+        return index;
+    uint64_t deadline = timeout_us == ECB_SET_FOREVER ? UINT64_MAX : ecbuff_set_now_ns() + timeout_us * 1000ull;
+    for(;;)
+    {
+        /* Announce parking before the final scan, a producer setting a bit
+         * afterwards sees the flag */
+        atomic_store(&set->parked, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        if((index = ecbuff_set_poll(set)) >= 0)
+            break;
+        uint64_t now = deadline == UINT64_MAX ? 0 : ecbuff_set_now_ns();
+        if(now >= deadline)
+            break;
+        ecbuff_set_park(&set->parked, deadline == UINT64_MAX ? UINT64_MAX : deadline - now);
+    }
+    atomic_store_explicit(&set->parked, 0, memory_order_relaxed);
+    return index;
+}
@@ -0,0 +1,94 @@
+/*
+ * ecbuff_set lets a single consumer serve many ecbuff instances, e.g. one
+ * per worker thread, without polling each of them. A shared bitmap holds a
+ * ready bit per ring. Producers set their ring's bit once it turns
+ * non-empty, the consumer finds ready rings with find-first-set and clears
+ * a bit once it has drained that ring. Polling thus costs a scan of the
+ * bitmap, touching individual rings only as far as they hold data, and the
+ * consumer may sleep until any producer signals.
+ *
+ * A producer only writes the bitmap if its bit is clear, i.e. on the
+ * empty to non-empty transition as seen by the consumer, otherwise it's a
+ * load from a shared cache line. Clearing a bit and publishing a write are
+ * each followed by a full fence before the consumer rechecks its ring
+ * (the producer checks its bit), so no write goes unnoticed.
+ *
+ * Requires ECB_THREAD_MULTI and C11 atomics. Blocking uses futexes on Linux
+ * and polls elsewhere.
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#ifndef ECBUFF_SET_H
+#define ECBUFF_SET_H
+
+#include "ecbuff.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+#if !defined(ECB_CACHELINE)
+#define ECB_CACHELINE 64
+#endif
+
+/* ECB_SET_MAX
+ * Upper limit of rings per set, a multiple of 64. Each ring costs a bit of
+ * the shared bitmap and a pointer on the consumer's side.
+ */
+#if !defined(ECB_SET_MAX)
+#define ECB_SET_MAX 256
+#endif
+
+/* ECB_SET_POLL_US
+ * Sleep between scans of a waiting consumer without futex support.
+ */
+#if !defined(ECB_SET_POLL_US)
+#define ECB_SET_POLL_US 100
+#endif
+
+#define ECB_SET_WORDS (ECB_SET_MAX / 64)
+#define ECB_SET_FOREVER UINT32_MAX
+
+typedef struct {
+    _Alignas(ECB_CACHELINE) _Atomic uint64_t ready[ECB_SET_WORDS]; /* bit per ring holding data */
+    _Atomic uint32_t parked;                    /* consumer sleeps, futex word on Linux */
+    _Alignas(ECB_CACHELINE) ecbuff* rings[ECB_SET_MAX];
+    uint32_t count;
+    uint32_t next;                              /* consumer's scan position, for fairness */
+} ecbuff_set;
+
+/* ecbuff_set_init / ecbuff_set_add
+ * Set up an empty set, then add rings before any thread uses them.
+ * ecbuff_set_add() returns the ring's index within the set, which its
+ * producer passes to ecbuff_set_notify(), or -1 once the set is full.
+ */
+void ecbuff_set_init(ecbuff_set* const restrict set);
+int ecbuff_set_add(ecbuff_set* const restrict set, ecbuff* const restrict rb);
+
+/* ecbuff_set_notify
+ * Called by the producer of ring index after it published one or more
+ * elements through any of the ecbuff write functions. ecbuff_set_write()
+ * and ecbuff_set_write_n() combine both.
+ */
+void ecbuff_set_notify(ecbuff_set* const restrict set, const int index);
+ECB_VOID_BOOL_T ecbuff_set_write(ecbuff_set* const restrict set, const int index, const void* const restrict element);
+ECB_UINT_T ecbuff_set_write_n(ecbuff_set* const restrict set, const int index, const void* const restrict elements,
+                              const ECB_UINT_T n);
+
+/* ecbuff_set_poll
+ * Consumer only. Returns the index of a ring flagged ready, starting after
+ * the one returned last so every ring gets its turn, or -1 if there is none.
+ * The flag stays set until ecbuff_set_idle(), which the consumer calls once
+ * it finds the ring empty. ecbuff_set_idle() returns false if data arrived
+ * meanwhile, the flag is then set again.
+ */
+int ecbuff_set_poll(ecbuff_set* const restrict set);
+bool ecbuff_set_idle(ecbuff_set* const restrict set, const int index);
+
+/* ecbuff_set_wait
+ * Consumer only. Blocks until a ring is flagged ready or timeout_us
+ * microseconds have passed (ECB_SET_FOREVER: indefinitely) and returns
+ * its index like ecbuff_set_poll(), or -1 on timeout.
+ */
+int ecbuff_set_wait(ecbuff_set* const restrict set, const uint32_t timeout_us);
+
+#endif // ECBUFF_SET_H
@@ -0,0 +1,228 @@
+/*
+ * Tests for ecbuff_set
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#if !defined(_GNU_SOURCE) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "ecbuff_set.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#if defined(ECB_POW2)
+#define ECBT_ELEM_CNT (ECBT_BUFF_SIZ / ECBT_ELEM_SIZ)
+#else
+#define ECBT_ELEM_CNT ((ECBT_BUFF_SIZ / ECBT_ELEM_SIZ) - 1)
+#endif
+
+/* Spans two bitmap words, every producer owns a contiguous group of rings */
+#define ECBSET_RINGS 70
+#define ECBSET_PRODUCERS 5
+#define ECBSET_PER_RING 2000
+
+typedef struct {
+    ecbuff_set* set;
+    int first;
+} ecbset_thread;
+
+ecbuff* ecbset_new(void);
+void ecbset_value(uint8_t* value, int ring, uint32_t seq);
+void ecbset_setup(ecbuff_set* set, ecbuff** rings);
+void ecbset_teardown(ecbuff** rings);
+void ecbset_check(ecbuff_set* set, int ring, uint32_t seq);
+void ecbset_test_st(void);
+void ecbset_test_mt(uint32_t timeout_us);
+void* ecbset_mt_source(void* arg);
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    ecbset_test_st();
+    ecbset_test_mt(ECB_SET_FOREVER);
+    ecbset_test_mt(1000);
+    return 0;
+}
+
+ecbuff* ecbset_new(void)
+{
+    ecbuff* rb = malloc(sizeof(ecbuff) + ECBT_BUFF_SIZ);
+    assert(rb);
+    ecbuff_init(rb, ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+    return rb;
+}
+
+void ecbset_value(uint8_t* value, int ring, uint32_t seq)
+{
+    memset(value, (uint8_t)(seq * 7 + (uint32_t)ring), ECBT_ELEM_SIZ);
+    memcpy(value, &seq, ECBT_ELEM_SIZ < sizeof(seq) ? ECBT_ELEM_SIZ : sizeof(seq));
+}
+
+void ecbset_setup(ecbuff_set* set, ecbuff** rings)
+{
+    ecbuff_set_init(set);
+    for(int i = 0; i < ECBSET_RINGS; i++)
+    {
+        rings[i] = ecbset_new();
+        assert(ecbuff_set_add(set, rings[i]) == i);
+    }
+}
+
+void ecbset_teardown(ecbuff** rings)
+{
+    for(int i = 0; i < ECBSET_RINGS; i++)
+        free(rings[i]);
+}
+
+/* Reads the next element of ring and compares it against seq */
+void ecbset_check(ecbuff_set* set, int ring, uint32_t seq)
+{
+    uint8_t value[ECBT_ELEM_SIZ];
+    uint8_t expected[ECBT_ELEM_SIZ];
+    ecbuff_read(set->rings[ring], value);
+    ecbset_value(expected, ring, seq);
+    if(memcmp(value, expected, ECBT_ELEM_SIZ))
+    {
+        printf("Read unexpected value! (ring %d, element %u)\n", ring, seq);
+        assert(false);
+    }
+}
+
+void ecbset_test_st(void)
+{
+    static ecbuff_set set;
+    ecbuff* rings[ECBSET_RINGS];
+    uint8_t value[ECBT_ELEM_SIZ];
+    ecbset_setup(&set, rings);
+    assert(ecbuff_set_poll(&set) == -1);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    assert(ecbuff_set_wait(&set, 2000) == -1);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    assert((end.tv_sec - start.tv_sec) * 1000000000L + end.tv_nsec - start.tv_nsec >= 2000000L);
+
+    /* Ready rings come up in turn, starting after the last one returned */
+    const int ready[] = {3, 64, 69};
+    for(int i = 0; i < 3; i++)
+    {
+        ecbset_value(value, ready[i], 0);
+        ecbuff_set_write(&set, ready[i], value);
+    }
+    for(int round = 0; round < 2; round++)
+    {
+        for(int i = 0; i < 3; i++)
+            assert(ecbuff_set_poll(&set) == ready[i]);
+    }
+    assert(ecbuff_set_wait(&set, ECB_SET_FOREVER) == ready[0]);
+
+    /* A ring still holding data keeps its flag */
+    assert(!ecbuff_set_idle(&set, ready[1]));
+    ecbset_check(&set, ready[0], 0);
+    assert(ecbuff_set_idle(&set, ready[0]));
+    assert(ecbuff_set_poll(&set) == ready[1]);
+    assert(ecbuff_set_poll(&set) == ready[2]);
+    assert(ecbuff_set_poll(&set) == ready[1]);
+    ecbset_check(&set, ready[1], 0);
+    ecbset_check(&set, ready[2], 0);
+    assert(ecbuff_set_idle(&set, ready[1]));
+    assert(ecbuff_set_idle(&set, ready[2]));
+    assert(ecbuff_set_poll(&set) == -1);
+
+    /* Further writes while flagged, then write_n */
+    if(ECBT_ELEM_CNT >= 2)
+    {
+        ecbset_value(value, 7, 1);
+        ecbuff_set_write(&set, 7, value);
+        ecbset_value(value, 7, 2);
+        ecbuff_set_write(&set, 7, value);
+        assert(ecbuff_set_poll(&set) == 7);
+        ecbset_check(&set, 7, 1);
+        ecbset_check(&set, 7, 2);
+        assert(ecbuff_set_idle(&set, 7));
+    }
+    ecbset_value(value, 65, 3);
+    assert(ecbuff_set_write_n(&set, 65, value, 1) == 1);
+    assert(ecbuff_set_wait(&set, 0) == 65);
+    ecbset_check(&set, 65, 3);
+    assert(ecbuff_set_idle(&set, 65));
+    assert(ecbuff_set_wait(&set, 0) == -1);
+
+    ecbuff_set_init(&set);
+    for(int i = 0; i < ECB_SET_MAX; i++)
+        assert(ecbuff_set_add(&set, rings[0]) == i);
+    assert(ecbuff_set_add(&set, rings[0]) == -1);
+    ecbset_teardown(rings);
+}
+
+/* Producers fill their rings round-robin, the consumer drains whichever
+ * ring is flagged and checks every ring's sequence */
+void ecbset_test_mt(uint32_t timeout_us)
+{
+    static ecbuff_set set;
+    ecbuff* rings[ECBSET_RINGS];
+    ecbset_setup(&set, rings);
+
+    pthread_t threads[ECBSET_PRODUCERS];
+    ecbset_thread args[ECBSET_PRODUCERS];
+    for(int i = 0; i < ECBSET_PRODUCERS; i++)
+    {
+        args[i].set = &set;
+        args[i].first = i * (ECBSET_RINGS / ECBSET_PRODUCERS);
+        if(pthread_create(&threads[i], NULL, ecbset_mt_source, &args[i]))
+        {
+            printf("Failed to spawn thread!\n");
+            assert(false);
+            return;
+        }
+    }
+
+    uint32_t seq[ECBSET_RINGS] = {0};
+    uint32_t left = ECBSET_RINGS * ECBSET_PER_RING;
+    while(left)
+    {
+        int ring = ecbuff_set_wait(&set, timeout_us);
+        if(ring < 0)
+            continue;
+        while(!ecbuff_is_empty(rings[ring]))
+        {
+            assert(seq[ring] < ECBSET_PER_RING);
+            ecbset_check(&set, ring, seq[ring]++);
+            left--;
+        }
+        ecbuff_set_idle(&set, ring);
+    }
+    for(int i = 0; i < ECBSET_PRODUCERS; i++)
+        pthread_join(threads[i], NULL);
+    for(int i = 0; i < ECBSET_RINGS; i++)
+        assert(ecbuff_is_empty(rings[i]));
+    assert(ecbuff_set_poll(&set) == -1);
+    ecbset_teardown(rings);
+}
+
+void* ecbset_mt_source(void* arg)
+{
+    ecbset_thread* t = arg;
+    uint8_t value[ECBT_ELEM_SIZ];
+    for(uint32_t seq = 0; seq < ECBSET_PER_RING; seq++)
+    {
+        for(int ring = t->first; ring < t->first + ECBSET_RINGS / ECBSET_PRODUCERS; ring++)
+        {
+            while(ecbuff_is_full(t->set->rings[ring]))
+                sched_yield();
+            ecbset_value(value, ring, seq);
+            ecbuff_set_write(t->set, ring, value);
+        }
+    }
+    pthread_exit((void*)true);
+}
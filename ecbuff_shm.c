@@ -0,0 +1,194 @@
+/* See ecbuff_shm.h for further information */
+
+#if !defined(_GNU_SOURCE) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L     // shm_open(), ftruncate(), kill()
+#endif
+
+#include "ecbuff_shm.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(ECB_ASSERT)
+#include <assert.h>
+
+#if !defined(ASSERT)
+//use standard assert() if nothing custom was defined
+#define ASSERT(x) assert(x)
+#endif
+
+#else
+#define NDEBUG
+#undef ASSERT	//ignore earlier definition from ecbuff_cfg.h
+#define ASSERT(x)
+#endif
+
+#if !defined(ECB_THREAD_MULTI)
+#error ecbuff_shm requires ECB_THREAD_MULTI!
+#endif
+
+/* The stamp array and histogram attached by ecbuff_timestamp_init() are
+ * referenced by process-local pointers inside the shared ecbuff */
+#if defined(ECB_TIMESTAMP)
+#error ecbuff_shm is incompatible with ECB_TIMESTAMP!
+#endif
+
+_Static_assert(sizeof(ecbuff_shm_hdr) <= ECBUFF_SHM_RB_OFFSET, "ecbuff_shm_hdr exceeds ECBUFF_SHM_RB_OFFSET");
+
+static ecbuff_shm_status ecbuff_shm_map(ecbuff_shm* const restrict shm, const int fd, const size_t size)
+{
+    void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(map == MAP_FAILED)
+        return ECB_SHM_ERR_SYS;
+    shm->hdr = map;
+    shm->rb = (ecbuff*)((char*)map + ECBUFF_SHM_RB_OFFSET);
+    shm->map_size = size;
+    shm->role = -1;
+    return ECB_SHM_OK;
+}
+
+ecbuff_shm_status ecbuff_shm_create(ecbuff_shm* const restrict shm, const char* const restrict name,
+                                    const ECB_UINT_T total_size, const ECB_UINT_T element_size)
+{
+    ASSERT(shm);
+    ASSERT(name);
+    size_t size = ECBUFF_SHM_SIZE(total_size);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(fd < 0)
+        return ECB_SHM_ERR_SYS;
+    if(ftruncate(fd, (off_t)size) || ecbuff_shm_map(shm, fd, size) != ECB_SHM_OK)
+    {
+        int err = errno;
+        close(fd);
+        shm_unlink(name);
+        errno = err;
+        return ECB_SHM_ERR_SYS;
+    }
+    close(fd);
+
+    ecbuff_shm_hdr* hdr = shm->hdr;
+    hdr->version = ECBUFF_SHM_VERSION;
+    hdr->fingerprint = ecbuff_config_fingerprint();
+    hdr->rb_offset = ECBUFF_SHM_RB_OFFSET;
+    hdr->total_size = total_size;
+    hdr->element_size = element_size;
+    atomic_init(&hdr->pid[ECB_SHM_PRODUCER], 0);
+    atomic_init(&hdr->pid[ECB_SHM_CONSUMER], 0);
+    ecbuff_init(shm->rb, total_size, element_size);
+    // Publish the header, attaching processes check it first
+    atomic_store_explicit(&hdr->magic, ECBUFF_SHM_MAGIC, memory_order_release);
+    return ECB_SHM_OK;
+}
+
+ecbuff_shm_status ecbuff_shm_attach(ecbuff_shm* const restrict shm, const char* const restrict name)
+{
+    ASSERT(shm);
+    ASSERT(name);
+    struct stat st;
+    int fd = shm_open(name, O_RDWR, 0);
+    if(fd < 0)
+        return ECB_SHM_ERR_SYS;
+    if(fstat(fd, &st))
+    {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return ECB_SHM_ERR_SYS;
+    }
+    if((size_t)st.st_size < ECBUFF_SHM_RB_OFFSET)
+    {
+        // Not yet truncated by the creator
+        close(fd);
+        return ECB_SHM_ERR_NOT_READY;
+    }
+    ecbuff_shm_status ret = ecbuff_shm_map(shm, fd, (size_t)st.st_size);
+    close(fd);
+    if(ret != ECB_SHM_OK)
+        return ret;
+
+    const ecbuff_shm_hdr* hdr = shm->hdr;
+    uint32_t magic = atomic_load_explicit(&hdr->magic, memory_order_acquire);
+    if(!magic)
+        ret = ECB_SHM_ERR_NOT_READY;
+    else if(magic != ECBUFF_SHM_MAGIC)
+        ret = ECB_SHM_ERR_MAGIC;
+    else if(hdr->version != ECBUFF_SHM_VERSION)
+        ret = ECB_SHM_ERR_VERSION;
+    else if(hdr->fingerprint != ecbuff_config_fingerprint() || hdr->rb_offset != ECBUFF_SHM_RB_OFFSET)
+        ret = ECB_SHM_ERR_CONFIG;
+    else if(hdr->total_size > ECB_ATOMIC_MAX || (size_t)st.st_size < ECBUFF_SHM_SIZE(hdr->total_size) ||
+            (ECB_UINT_T)hdr->total_size != (ECB_UINT_T)shm->rb->total_size ||
+            (ECB_UINT_T)hdr->element_size != (ECB_UINT_T)shm->rb->element_size)
+        ret = ECB_SHM_ERR_SIZE;
+
+    if(ret != ECB_SHM_OK)
+    {
+        munmap(shm->hdr, shm->map_size);
+        shm->hdr = NULL;
+        shm->rb = NULL;
+    }
+    return ret;
+}
+
+/* A pid of 0 denotes an unclaimed role */
+static inline bool ecbuff_shm_alive(const int64_t pid)
+{
+    return pid && (kill((pid_t)pid, 0) == 0 || errno != ESRCH);
+}
+
+ecbuff_shm_status ecbuff_shm_claim(ecbuff_shm* const restrict shm, const ecbuff_shm_role role)
+{
+    ASSERT(shm);
+    ASSERT(shm->hdr);
+    ASSERT(role == ECB_SHM_PRODUCER || role == ECB_SHM_CONSUMER);
+    _Atomic int64_t* slot = &shm->hdr->pid[role];
+    int64_t self = (int64_t)getpid();
+    int64_t holder = atomic_load_explicit(slot, memory_order_acquire);
+
+    for(;;)
+    {
+        if(holder == self)
+            break;
+        if(ecbuff_shm_alive(holder))
+            return ECB_SHM_ERR_BUSY;
+        // Unclaimed or left behind by a dead process
+        if(atomic_compare_exchange_weak_explicit(slot, &holder, self, memory_order_acq_rel, memory_order_acquire))
+            break;
+    }
+    shm->role = role;
+    return ECB_SHM_OK;
+}
+
+bool ecbuff_shm_peer_alive(const ecbuff_shm* const restrict shm)
+{
+    ASSERT(shm);
+    ASSERT(shm->hdr);
+    ASSERT(shm->role == ECB_SHM_PRODUCER || shm->role == ECB_SHM_CONSUMER);
+    return ecbuff_shm_alive(atomic_load_explicit(&shm->hdr->pid[!shm->role], memory_order_acquire));
+}
+
+void ecbuff_shm_detach(ecbuff_shm* const restrict shm)
+{
+    ASSERT(shm);
+    if(!shm->hdr)
+        return;
+    if(shm->role >= 0)
+    {
+        int64_t self = (int64_t)getpid();
+        atomic_compare_exchange_strong_explicit(&shm->hdr->pid[shm->role], &self, 0,
+                                                memory_order_acq_rel, memory_order_relaxed);
+    }
+    munmap(shm->hdr, shm->map_size);
+    shm->hdr = NULL;
+    shm->rb = NULL;
+    shm->role = -1;
+}
+
+ecbuff_shm_status ecbuff_shm_unlink(const char* const restrict name)
+{
+    ASSERT(name);
+    return shm_unlink(name) ? ECB_SHM_ERR_SYS : ECB_SHM_OK;
+}
@@ -0,0 +1,99 @@
+/*
+ * ecbuff_shm places an ecbuff into POSIX shared memory, so a producer and a
+ * consumer in different processes can communicate without syscalls or
+ * extra copies. The creating process initializes a versioned header that
+ * records a magic number, the layout fingerprint of the ecbuff
+ * configuration (see ecbuff_config_fingerprint()), element size and
+ * capacity. Attaching verifies all of them, as both processes have to be
+ * built with the same configuration.
+ *
+ * Each side claims its role, which records its pid in the header. A role
+ * held by a process that no longer exists may be claimed again, allowing a
+ * crashed peer to be replaced. Since indices are only published after an
+ * element has been copied, a producer dying mid-write loses the partial
+ * element while a consumer dying mid-read (e.g. between
+ * ecbuff_read_dequeue() and ecbuff_read_free()) has its element delivered
+ * again to its successor. ecbuff_shm_peer_alive() lets either side detect
+ * a vanished peer, e.g. when the buffer stays full or empty.
+ *
+ * Requires ECB_THREAD_MULTI and C11 atomics, memory has to be lock-free
+ * atomic across processes (true for common platforms). ECB_TIMESTAMP is
+ * rejected, as it keeps process-local pointers inside the ecbuff.
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#ifndef ECBUFF_SHM_H
+#define ECBUFF_SHM_H
+
+#include "ecbuff.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define ECBUFF_SHM_MAGIC 0x53424345u          /* "ECBS" */
+#define ECBUFF_SHM_VERSION 1u
+
+typedef enum {
+    ECB_SHM_OK = 0,
+    ECB_SHM_ERR_SYS,                            /* system call failed, see errno */
+    ECB_SHM_ERR_NOT_READY,                      /* creator hasn't finished initialization, retry */
+    ECB_SHM_ERR_MAGIC,                          /* not an ecbuff_shm object */
+    ECB_SHM_ERR_VERSION,                        /* created by an incompatible version */
+    ECB_SHM_ERR_CONFIG,                         /* created with a different ecbuff configuration */
+    ECB_SHM_ERR_SIZE,                           /* object smaller than its header claims */
+    ECB_SHM_ERR_BUSY                            /* role held by a live process */
+} ecbuff_shm_status;
+
+typedef enum {
+    ECB_SHM_PRODUCER = 0,
+    ECB_SHM_CONSUMER = 1
+} ecbuff_shm_role;
+
+/* Lives at offset 0 of the shared memory object, the ecbuff follows at
+ * ECBUFF_SHM_RB_OFFSET. Only fixed width types, so processes built for
+ * different data models agree on the header at least. */
+typedef struct {
+    _Atomic uint32_t magic;                     /* stored last by the creator */
+    uint32_t version;
+    uint32_t fingerprint;
+    uint32_t rb_offset;
+    uint64_t total_size;
+    uint64_t element_size;
+    _Atomic int64_t pid[2];                     /* per role, 0 if unclaimed */
+} ecbuff_shm_hdr;
+
+#define ECBUFF_SHM_RB_OFFSET 128
+#define ECBUFF_SHM_SIZE(total_size) (ECBUFF_SHM_RB_OFFSET + sizeof(ecbuff) + (size_t)(total_size))
+
+typedef struct {
+    ecbuff_shm_hdr* hdr;
+    ecbuff* rb;                                 /* ready to be used with the ecbuff API */
+    size_t map_size;
+    int role;                                   /* claimed role, -1 if none */
+} ecbuff_shm;
+
+/* ecbuff_shm_create
+ * Creates the shared memory object name (see shm_open()), which must not
+ * exist yet, and initializes an ecbuff like ecbuff_init() would.
+ */
+ecbuff_shm_status ecbuff_shm_create(ecbuff_shm* const restrict shm, const char* const restrict name,
+                                    const ECB_UINT_T total_size, const ECB_UINT_T element_size);
+/* ecbuff_shm_attach
+ * Maps an existing object and verifies that its layout matches.
+ */
+ecbuff_shm_status ecbuff_shm_attach(ecbuff_shm* const restrict shm, const char* const restrict name);
+/* ecbuff_shm_claim
+ * Registers the calling process for role. Fails with ECB_SHM_ERR_BUSY while
+ * another live process holds it, takes over from one that died.
+ */
+ecbuff_shm_status ecbuff_shm_claim(ecbuff_shm* const restrict shm, const ecbuff_shm_role role);
+/* Returns whether the other role is held by a live process */
+bool ecbuff_shm_peer_alive(const ecbuff_shm* const restrict shm);
+/* Releases the claimed role and unmaps */
+void ecbuff_shm_detach(ecbuff_shm* const restrict shm);
+/* Removes the name, mappings stay valid until detached */
+ecbuff_shm_status ecbuff_shm_unlink(const char* const restrict name);
+
+#endif // ECBUFF_SHM_H
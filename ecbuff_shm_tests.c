@@ -0,0 +1,207 @@
+/*
+ * Tests for ecbuff_shm
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#if !defined(_GNU_SOURCE) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "ecbuff_shm.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define ECBSHT_COUNT (ECBT_ELEM_CNT * 1000)
+
+#if defined(ECB_POW2)
+#define ECBT_ELEM_CNT (ECBT_BUFF_SIZ / ECBT_ELEM_SIZ)
+#else
+#define ECBT_ELEM_CNT ((ECBT_BUFF_SIZ / ECBT_ELEM_SIZ) - 1)
+#endif
+
+static char ecbsht_name[64];
+
+void ecbsht_test_header(void);
+void ecbsht_test_mp_basic(void);
+void ecbsht_test_mp_dead_peer(void);
+void ecbsht_put(ecbuff* rb, uint32_t seq);
+bool ecbsht_get(ecbuff* rb, uint32_t seq);
+void ecbsht_attach(ecbuff_shm* shm, ecbuff_shm_role role);
+void ecbsht_consume(uint32_t first, uint32_t count);
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    snprintf(ecbsht_name, sizeof(ecbsht_name), "/ecbuff_shm_test_%ld", (long)getpid());
+    ecbsht_test_header();
+    ecbsht_test_mp_basic();
+    ecbsht_test_mp_dead_peer();
+    return 0;
+}
+
+void ecbsht_put(ecbuff* rb, uint32_t seq)
+{
+    uint8_t value[ECBT_ELEM_SIZ];
+    memset(value, (uint8_t)seq, ECBT_ELEM_SIZ);
+    memcpy(value, &seq, ECBT_ELEM_SIZ < sizeof(seq) ? ECBT_ELEM_SIZ : sizeof(seq));
+    while(ecbuff_is_full(rb))
+        sched_yield();
+    ecbuff_write(rb, value);
+}
+
+/* Reads one element and checks it against seq */
+bool ecbsht_get(ecbuff* rb, uint32_t seq)
+{
+    uint8_t value[ECBT_ELEM_SIZ];
+    uint8_t expected[ECBT_ELEM_SIZ];
+    memset(expected, (uint8_t)seq, ECBT_ELEM_SIZ);
+    memcpy(expected, &seq, ECBT_ELEM_SIZ < sizeof(seq) ? ECBT_ELEM_SIZ : sizeof(seq));
+    while(ecbuff_is_empty(rb))
+        sched_yield();
+    ecbuff_read(rb, value);
+    if(memcmp(value, expected, ECBT_ELEM_SIZ))
+    {
+        printf("Read unexpected value! (%hhu instead of %hhu)\n", value[0], expected[0]);
+        return false;
+    }
+    return true;
+}
+
+void ecbsht_attach(ecbuff_shm* shm, ecbuff_shm_role role)
+{
+    ecbuff_shm_status ret;
+    while((ret = ecbuff_shm_attach(shm, ecbsht_name)) == ECB_SHM_ERR_NOT_READY)
+        sched_yield();
+    if(ret != ECB_SHM_OK || ecbuff_shm_claim(shm, role) != ECB_SHM_OK)
+    {
+        printf("Failed to attach! (%d)\n", (int)ret);
+        _exit(EXIT_FAILURE);
+    }
+}
+
+/* Child process: consumes count elements starting at first, exits without detaching */
+void ecbsht_consume(uint32_t first, uint32_t count)
+{
+    ecbuff_shm shm;
+    ecbsht_attach(&shm, ECB_SHM_CONSUMER);
+    for(uint32_t i = 0; i < count; i++)
+        if(!ecbsht_get(shm.rb, first + i))
+            _exit(EXIT_FAILURE);
+    _exit(EXIT_SUCCESS);
+}
+
+void ecbsht_test_header(void)
+{
+    ecbuff_shm a, b;
+    ecbuff_shm_unlink(ecbsht_name);
+
+    assert(ecbuff_shm_attach(&a, ecbsht_name) == ECB_SHM_ERR_SYS && errno == ENOENT);
+    assert(ecbuff_shm_create(&a, ecbsht_name, ECBT_BUFF_SIZ, ECBT_ELEM_SIZ) == ECB_SHM_OK);
+    assert(ecbuff_shm_create(&b, ecbsht_name, ECBT_BUFF_SIZ, ECBT_ELEM_SIZ) == ECB_SHM_ERR_SYS && errno == EEXIST);
+    assert(ecbuff_shm_attach(&b, ecbsht_name) == ECB_SHM_OK);
+    assert(b.rb->total_size == ECBT_BUFF_SIZ && b.rb->element_size == ECBT_ELEM_SIZ);
+
+    /* Both mappings refer to the same buffer */
+    ecbsht_put(a.rb, 42);
+    assert(ecbuff_used(b.rb) == 1);
+    assert(ecbsht_get(b.rb, 42));
+    assert(ecbuff_is_empty(a.rb));
+    ecbuff_shm_detach(&b);
+
+    /* Mismatches are detected */
+    a.hdr->fingerprint ^= 1;
+    assert(ecbuff_shm_attach(&b, ecbsht_name) == ECB_SHM_ERR_CONFIG);
+    a.hdr->fingerprint ^= 1;
+    a.hdr->version++;
+    assert(ecbuff_shm_attach(&b, ecbsht_name) == ECB_SHM_ERR_VERSION);
+    a.hdr->version--;
+    a.hdr->total_size *= 2;
+    assert(ecbuff_shm_attach(&b, ecbsht_name) == ECB_SHM_ERR_SIZE);
+    a.hdr->total_size /= 2;
+    atomic_store(&a.hdr->magic, 0x12345678);
+    assert(ecbuff_shm_attach(&b, ecbsht_name) == ECB_SHM_ERR_MAGIC);
+    atomic_store(&a.hdr->magic, 0);
+    assert(ecbuff_shm_attach(&b, ecbsht_name) == ECB_SHM_ERR_NOT_READY);
+    atomic_store(&a.hdr->magic, ECBUFF_SHM_MAGIC);
+
+    /* A role can only be held by one live process */
+    assert(ecbuff_shm_attach(&b, ecbsht_name) == ECB_SHM_OK);
+    assert(ecbuff_shm_claim(&a, ECB_SHM_PRODUCER) == ECB_SHM_OK);
+    assert(!ecbuff_shm_peer_alive(&a));
+    assert(ecbuff_shm_claim(&b, ECB_SHM_PRODUCER) == ECB_SHM_OK);   // same process
+    assert(ecbuff_shm_claim(&b, ECB_SHM_CONSUMER) == ECB_SHM_OK);
+    assert(ecbuff_shm_peer_alive(&a));
+    ecbuff_shm_detach(&b);
+    assert(!ecbuff_shm_peer_alive(&a));
+
+    ecbuff_shm_detach(&a);
+    assert(ecbuff_shm_unlink(ecbsht_name) == ECB_SHM_OK);
+}
+
+void ecbsht_test_mp_basic(void)
+{
+    ecbuff_shm shm;
+    int status;
+    assert(ecbuff_shm_create(&shm, ecbsht_name, ECBT_BUFF_SIZ, ECBT_ELEM_SIZ) == ECB_SHM_OK);
+    assert(ecbuff_shm_claim(&shm, ECB_SHM_PRODUCER) == ECB_SHM_OK);
+
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if(!pid)
+        ecbsht_consume(0, ECBSHT_COUNT);
+
+    for(uint32_t i = 0; i < ECBSHT_COUNT; i++)
+        ecbsht_put(shm.rb, i);
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+    assert(ecbuff_is_empty(shm.rb));
+
+    ecbuff_shm_detach(&shm);
+    assert(ecbuff_shm_unlink(ecbsht_name) == ECB_SHM_OK);
+}
+
+void ecbsht_test_mp_dead_peer(void)
+{
+    ecbuff_shm shm;
+    int status;
+    uint32_t half = ECBSHT_COUNT / 2;
+    assert(ecbuff_shm_create(&shm, ecbsht_name, ECBT_BUFF_SIZ, ECBT_ELEM_SIZ) == ECB_SHM_OK);
+    assert(ecbuff_shm_claim(&shm, ECB_SHM_PRODUCER) == ECB_SHM_OK);
+
+    /* The first consumer dies after half of the elements, leaving its role claimed */
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if(!pid)
+        ecbsht_consume(0, half);
+    uint32_t i = 0;
+    for(; i < half; i++)
+        ecbsht_put(shm.rb, i);
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+    assert(atomic_load(&shm.hdr->pid[ECB_SHM_CONSUMER]) == pid);
+    assert(!ecbuff_shm_peer_alive(&shm));
+
+    /* Its successor takes over and continues where it stopped */
+    pid = fork();
+    assert(pid >= 0);
+    if(!pid)
+        ecbsht_consume(half, ECBSHT_COUNT - half);
+    for(; i < ECBSHT_COUNT; i++)
+        ecbsht_put(shm.rb, i);
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+    assert(ecbuff_is_empty(shm.rb));
+
+    ecbuff_shm_detach(&shm);
+    assert(ecbuff_shm_unlink(ecbsht_name) == ECB_SHM_OK);
+}
@@ -0,0 +1,177 @@
+/* See ecbuff_stage.h for further information */
+
+#include "ecbuff_stage.h"
+
+#if defined(ECB_ASSERT)
+#include <assert.h>
+
+#if !defined(ASSERT)
+//use standard assert() if nothing custom was defined
+#define ASSERT(x) assert(x)
+#endif
+
+#else
+#define NDEBUG
+#undef ASSERT	//ignore earlier definition from ecbuff_cfg.h
+#define ASSERT(x)
+#endif
+
+_Static_assert(sizeof(ecbuff_stage_cursor) == ECB_CACHELINE, "ecbuff_stage_cursor has to fill a cache line");
+
+static inline void* ecbuff_stage_elem(const ecbuff_stage* const restrict rb, const size_t pos)
+{
+    return (char*)&rb->elems[(pos & rb->mask) * rb->element_size];
+}
+
+/* The producer's tail acts as cursor preceding stage 0 */
+static inline const atomic_size_t* ecbuff_stage_upstream(const ecbuff_stage* const restrict rb, const size_t stage)
+{
+    return stage ? &rb->stage[stage - 1].cursor : &rb->tail;
+}
+
+void ecbuff_stage_init(ecbuff_stage* const restrict rb, const ECB_UINT_T count, const ECB_UINT_T element_size,
+                       const ECB_UINT_T stages)
+{
+    ASSERT(rb);
+    ASSERT(count >= 2);
+    ASSERT(!(count & (count - 1)));
+    ASSERT(element_size);
+    ASSERT(stages && stages <= ECB_STAGE_MAX);
+    rb->mask = count - 1;
+    rb->element_size = element_size;
+    rb->stages = stages;
+    atomic_init(&rb->tail, 0);
+    rb->head_cache = 0;
+    for(size_t i = 0; i < ECB_STAGE_MAX; i++)
+    {
+        atomic_init(&rb->stage[i].cursor, 0);
+        rb->stage[i].upstream_cache = 0;
+    }
+}
+
+/* Number of free slots from tail on, reloading the final cursor once the cached one runs short */
+static inline size_t ecbuff_stage_unused(ecbuff_stage* const restrict rb, const size_t tail, const size_t n)
+{
+    size_t count = rb->mask + 1;
+    size_t unused = count - (tail - rb->head_cache);
+    if(unused < n)
+    {
+        rb->head_cache = atomic_load_explicit(&rb->stage[rb->stages - 1].cursor, memory_order_acquire);
+        unused = count - (tail - rb->head_cache);
+    }
+    return unused;
+}
+
+/* Number of elements pending for stage from cursor on, likewise */
+static inline size_t ecbuff_stage_ready(ecbuff_stage* const restrict rb, const size_t stage,
+                                        const size_t cursor, const size_t n)
+{
+    ecbuff_stage_cursor* c = &rb->stage[stage];
+    size_t ready = c->upstream_cache - cursor;
+    if(ready < n)
+    {
+        c->upstream_cache = atomic_load_explicit(ecbuff_stage_upstream(rb, stage), memory_order_acquire);
+        ready = c->upstream_cache - cursor;
+    }
+    return ready;
+}
+
+/* Limits a run starting at pos to the wrap point */
+static inline size_t ecbuff_stage_contig(const ecbuff_stage* const restrict rb, const size_t pos, const size_t len)
+{
+    size_t contig = rb->mask + 1 - (pos & rb->mask);
+    return len < contig ? len : contig;
+}
+
+void* ecbuff_stage_write_alloc(ecbuff_stage* const restrict rb)
+{
+    ASSERT(rb);
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    if(!ecbuff_stage_unused(rb, tail, 1))
+        return NULL;
+    return ecbuff_stage_elem(rb, tail);
+}
+
+void ecbuff_stage_write_enqueue(ecbuff_stage* const restrict rb)
+{
+    ecbuff_stage_write_enqueue_n(rb, 1);
+}
+
+void* ecbuff_stage_write_alloc_span(ecbuff_stage* const restrict rb, ECB_UINT_T* const restrict count)
+{
+    ASSERT(rb);
+    ASSERT(count);
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    size_t len = ecbuff_stage_contig(rb, tail, ecbuff_stage_unused(rb, tail, 1));
+    *count = (ECB_UINT_T)len;
+    if(!len)
+        return NULL;
+    return ecbuff_stage_elem(rb, tail);
+}
+
+void ecbuff_stage_write_enqueue_n(ecbuff_stage* const restrict rb, const ECB_UINT_T n)
+{
+    ASSERT(rb);
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    /* Computed either way, the call refreshes head_cache */
+    size_t unused = ecbuff_stage_unused(rb, tail, n);
+    ASSERT(n <= unused);
+    (void)unused;
+    atomic_store_explicit(&rb->tail, tail + n, memory_order_release);
+}
+
+void* ecbuff_stage_dequeue(ecbuff_stage* const restrict rb, const ECB_UINT_T stage)
+{
+    ASSERT(rb);
+    ASSERT(stage < rb->stages);
+    size_t cursor = atomic_load_explicit(&rb->stage[stage].cursor, memory_order_relaxed);
+    if(!ecbuff_stage_ready(rb, stage, cursor, 1))
+        return NULL;
+    return ecbuff_stage_elem(rb, cursor);
+}
+
+void ecbuff_stage_free(ecbuff_stage* const restrict rb, const ECB_UINT_T stage)
+{
+    ecbuff_stage_free_n(rb, stage, 1);
+}
+
+void* ecbuff_stage_dequeue_span(ecbuff_stage* const restrict rb, const ECB_UINT_T stage, ECB_UINT_T* const restrict count)
+{
+    ASSERT(rb);
+    ASSERT(count);
+    ASSERT(stage < rb->stages);
+    size_t cursor = atomic_load_explicit(&rb->stage[stage].cursor, memory_order_relaxed);
+    size_t len = ecbuff_stage_contig(rb, cursor, ecbuff_stage_ready(rb, stage, cursor, 1));
+    *count = (ECB_UINT_T)len;
+    if(!len)
+        return NULL;
+    return ecbuff_stage_elem(rb, cursor);
+}
+
+void ecbuff_stage_free_n(ecbuff_stage* const restrict rb, const ECB_UINT_T stage, const ECB_UINT_T n)
+{
+    ASSERT(rb);
+    ASSERT(stage < rb->stages);
+    atomic_size_t* cursor = &rb->stage[stage].cursor;
+    size_t pos = atomic_load_explicit(cursor, memory_order_relaxed);
+    /* Likewise for upstream_cache */
+    size_t ready = ecbuff_stage_ready(rb, stage, pos, n);
+    ASSERT(n <= ready);
+    (void)ready;
+    atomic_store_explicit(cursor, pos + n, memory_order_release);
+}
+
+ECB_UINT_T ecbuff_stage_used(const ecbuff_stage* const restrict rb)
+{
+    ASSERT(rb);
+    size_t head = atomic_load_explicit(&rb->stage[rb->stages - 1].cursor, memory_order_acquire);
+    return (ECB_UINT_T)(atomic_load_explicit(&rb->tail, memory_order_acquire) - head);
+}
+
+ECB_UINT_T ecbuff_stage_pending(const ecbuff_stage* const restrict rb, const ECB_UINT_T stage)
+{
+    ASSERT(rb);
+    ASSERT(stage < rb->stages);
+    size_t cursor = atomic_load_explicit(&rb->stage[stage].cursor, memory_order_acquire);
+    return (ECB_UINT_T)(atomic_load_explicit(ecbuff_stage_upstream(rb, stage), memory_order_acquire) - cursor);
+}
@@ -0,0 +1,97 @@
+/*
+ * ecbuff_stage lets a pipeline of processing stages (e.g. capture, filter,
+ * decode, log) share a single ring instead of copying each element from one
+ * ecbuff into the next. A producer allocates and enqueues elements, then
+ * every stage in turn dequeues them in place, may modify them and frees them
+ * for the following stage. Each stage has its own cursor on its own cache
+ * line and may only advance up to the cursor of the stage before it. Slots
+ * return to the producer once the final stage freed them.
+ *
+ * It follows the ECB_DIRECT_ACCESS pointer model of ecbuff, including span
+ * variants for batches up to the wrap point. Each cursor is written by one
+ * thread only, so a stage costs no more than an SPSC ecbuff hop minus the
+ * copy. It requires C11 atomics and a power of two element count.
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#ifndef ECBUFF_STAGE_H
+#define ECBUFF_STAGE_H
+
+#include "ecbuff.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+#if !defined(ECB_CACHELINE)
+#define ECB_CACHELINE 64
+#endif
+
+/* ECB_STAGE_MAX
+ * Upper limit of stages per instance, each one costs a cache line.
+ */
+#if !defined(ECB_STAGE_MAX)
+#define ECB_STAGE_MAX 8
+#endif
+
+typedef struct {
+    atomic_size_t cursor;                       /* next position to be processed by this stage */
+    size_t upstream_cache;                      /* stage's copy of the preceding cursor */
+    char pad[ECB_CACHELINE - 2 * sizeof(atomic_size_t)];
+} ecbuff_stage_cursor;
+
+typedef struct {
+    size_t mask;                                /* element count - 1 */
+    size_t element_size;
+    size_t stages;
+    char pad_config[ECB_CACHELINE - 3 * sizeof(size_t)];
+    atomic_size_t tail;                         /* next position to be written by the producer */
+    size_t head_cache;                          /* producer's copy of the final stage's cursor */
+    char pad_tail[ECB_CACHELINE - 2 * sizeof(atomic_size_t)];
+    ecbuff_stage_cursor stage[ECB_STAGE_MAX];
+    char elems[];                               /* count * element_size bytes */
+} ecbuff_stage;
+
+/* Number of bytes to allocate for an instance holding count elements */
+#define ECBUFF_STAGE_SIZE(count, element_size) \
+    (sizeof(ecbuff_stage) + (size_t)(count) * (size_t)(element_size))
+
+/* ecbuff_stage_init
+ * count has to be a power of two and at least 2, stages between 1 and
+ * ECB_STAGE_MAX. Stages are numbered 0 to stages - 1 in processing order.
+ * rb has to provide ECBUFF_STAGE_SIZE(count, element_size) bytes.
+ */
+void ecbuff_stage_init(ecbuff_stage* const restrict rb, const ECB_UINT_T count, const ECB_UINT_T element_size,
+                       const ECB_UINT_T stages);
+
+/* Producer: ecbuff_stage_write_alloc() returns the next free slot or NULL if
+ * the final stage has yet to free it, ecbuff_stage_write_enqueue() passes it
+ * on to stage 0.
+ */
+void* ecbuff_stage_write_alloc(ecbuff_stage* const restrict rb);
+void ecbuff_stage_write_enqueue(ecbuff_stage* const restrict rb);
+
+/* Stage: ecbuff_stage_dequeue() returns the stage's next element or NULL if
+ * the preceding stage hasn't freed it yet, ecbuff_stage_free() passes it on.
+ */
+void* ecbuff_stage_dequeue(ecbuff_stage* const restrict rb, const ECB_UINT_T stage);
+void ecbuff_stage_free(ecbuff_stage* const restrict rb, const ECB_UINT_T stage);
+
+/* ecbuff_stage_write_alloc_span / ecbuff_stage_dequeue_span
+ * Return the largest contiguous run of free (or pending) elements up to the
+ * wrap point and store its length to *count, NULL and 0 if there is none.
+ * ecbuff_stage_write_enqueue_n() / ecbuff_stage_free_n() pass on the first
+ * n elements of such a run.
+ */
+void* ecbuff_stage_write_alloc_span(ecbuff_stage* const restrict rb, ECB_UINT_T* const restrict count);
+void ecbuff_stage_write_enqueue_n(ecbuff_stage* const restrict rb, const ECB_UINT_T n);
+void* ecbuff_stage_dequeue_span(ecbuff_stage* const restrict rb, const ECB_UINT_T stage, ECB_UINT_T* const restrict count);
+void ecbuff_stage_free_n(ecbuff_stage* const restrict rb, const ECB_UINT_T stage, const ECB_UINT_T n);
+
+/* Snapshots, may be outdated as soon as they return.
+ * ecbuff_stage_used(): elements between the producer and the final stage.
+ * ecbuff_stage_pending(): elements the given stage may dequeue.
+ */
+ECB_UINT_T ecbuff_stage_used(const ecbuff_stage* const restrict rb);
+ECB_UINT_T ecbuff_stage_pending(const ecbuff_stage* const restrict rb, const ECB_UINT_T stage);
+
+#endif // ECBUFF_STAGE_H
@@ -0,0 +1,264 @@
+/*
+ * Tests for ecbuff_stage
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#include "ecbuff_stage.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define ECBST_STAGES 3
+#define ECBST_PER_RUN 50000
+/* Element layout: sequence number, one mark per stage, producer fill */
+#define ECBST_MARK(stage) (sizeof(uint32_t) + (stage))
+#define ECBST_FILL ECBST_MARK(ECBST_STAGES)
+
+_Static_assert(ECBT_ELEM_SIZ > ECBST_FILL, "ECBT_ELEM_SIZ too small for ecbuff_stage tests");
+
+typedef struct {
+    ecbuff_stage* buff;
+    uint32_t id;
+} ecbst_thread;
+
+ecbuff_stage* ecbst_new(void);
+void ecbst_delete(ecbuff_stage* buff);
+void ecbst_test_st(ECB_UINT_T count);
+void ecbst_test_mt(ECB_UINT_T count);
+void* ecbst_mt_source(void* buff);
+void* ecbst_mt_stage(void* arg);
+void ecbst_fill(uint8_t* elem, uint32_t seq);
+void ecbst_process(uint8_t* elem, uint32_t seq, ECB_UINT_T stage);
+ECB_UINT_T ecbst_put(ecbuff_stage* buff, uint32_t seq, ECB_UINT_T num, bool span);
+ECB_UINT_T ecbst_run(ecbuff_stage* buff, ECB_UINT_T stage, uint32_t seq, ECB_UINT_T num, bool span);
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    ecbst_test_st(1337);
+    ecbst_test_mt(5);
+    return 0;
+}
+
+ecbuff_stage* ecbst_new(void)
+{
+    ecbuff_stage* buff = malloc(ECBUFF_STAGE_SIZE(ECBT_ELEM_CNT, ECBT_ELEM_SIZ));
+    assert(buff);
+    ecbuff_stage_init(buff, ECBT_ELEM_CNT, ECBT_ELEM_SIZ, ECBST_STAGES);
+    assert(ecbuff_stage_used(buff) == 0);
+    for(ECB_UINT_T s = 0; s < ECBST_STAGES; s++)
+        assert(ecbuff_stage_pending(buff, s) == 0);
+    return buff;
+}
+
+void ecbst_delete(ecbuff_stage* buff)
+{
+    assert(buff);
+    free(buff);
+}
+
+void ecbst_fill(uint8_t* elem, uint32_t seq)
+{
+    memset(elem, (uint8_t)(seq * 7 + 1), ECBT_ELEM_SIZ);
+    memcpy(elem, &seq, sizeof(seq));
+    memset(elem + ECBST_MARK(0), 0, ECBST_STAGES);
+}
+
+/* Checks that exactly the stages before this one have seen the element, then marks it */
+void ecbst_process(uint8_t* elem, uint32_t seq, ECB_UINT_T stage)
+{
+    uint32_t value;
+    memcpy(&value, elem, sizeof(value));
+    if(value != seq)
+    {
+        printf("Stage %u: read unexpected value! (%u instead of %u)\n", (unsigned)stage, value, seq);
+        assert(false);
+    }
+    for(ECB_UINT_T s = 0; s < ECBST_STAGES; s++)
+    {
+        uint8_t mark = s < stage ? (uint8_t)(seq + s + 1) : 0;
+        if(elem[ECBST_MARK(s)] != mark)
+        {
+            printf("Stage %u: element %u has unexpected mark of stage %u!\n", (unsigned)stage, seq, (unsigned)s);
+            assert(false);
+        }
+    }
+    for(size_t i = ECBST_FILL; i < ECBT_ELEM_SIZ; i++)
+        assert(elem[i] == (uint8_t)(seq * 7 + 1));
+    elem[ECBST_MARK(stage)] = (uint8_t)(seq + stage + 1);
+}
+
+/* Writes up to num elements starting at seq, returns how many were written */
+ECB_UINT_T ecbst_put(ecbuff_stage* buff, uint32_t seq, ECB_UINT_T num, bool span)
+{
+    if(span)
+    {
+        ECB_UINT_T count;
+        uint8_t* ptr = ecbuff_stage_write_alloc_span(buff, &count);
+        assert(!ptr == !count);
+        if(count > num)
+            count = num;
+        for(ECB_UINT_T j = 0; j < count; j++)
+            ecbst_fill(ptr + j * ECBT_ELEM_SIZ, seq + j);
+        ecbuff_stage_write_enqueue_n(buff, count);
+        return count;
+    }
+    ECB_UINT_T j = 0;
+    for(; j < num; j++)
+    {
+        uint8_t* ptr = ecbuff_stage_write_alloc(buff);
+        if(!ptr)
+            break;
+        ecbst_fill(ptr, seq + j);
+        ecbuff_stage_write_enqueue(buff);
+    }
+    return j;
+}
+
+/* Processes up to num elements starting at seq in place, returns how many were */
+ECB_UINT_T ecbst_run(ecbuff_stage* buff, ECB_UINT_T stage, uint32_t seq, ECB_UINT_T num, bool span)
+{
+    if(span)
+    {
+        ECB_UINT_T count;
+        uint8_t* ptr = ecbuff_stage_dequeue_span(buff, stage, &count);
+        assert(!ptr == !count);
+        if(count > num)
+            count = num;
+        for(ECB_UINT_T j = 0; j < count; j++)
+            ecbst_process(ptr + j * ECBT_ELEM_SIZ, seq + j, stage);
+        ecbuff_stage_free_n(buff, stage, count);
+        return count;
+    }
+    ECB_UINT_T j = 0;
+    for(; j < num; j++)
+    {
+        uint8_t* ptr = ecbuff_stage_dequeue(buff, stage);
+        if(!ptr)
+            break;
+        ecbst_process(ptr, seq + j, stage);
+        ecbuff_stage_free(buff, stage);
+    }
+    return j;
+}
+
+void ecbst_test_st(ECB_UINT_T count)
+{
+    ecbuff_stage* buff = ecbst_new();
+    uint32_t wseq = 0;
+    uint32_t cursor[ECBST_STAGES] = {0};
+
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        /* Only the final stage frees slots for the producer */
+        ECB_UINT_T num = rand() % (ECBT_ELEM_CNT + 2);
+        ECB_UINT_T unused = ECBT_ELEM_CNT - (wseq - cursor[ECBST_STAGES - 1]);
+        ECB_UINT_T written = ecbst_put(buff, wseq, num, i & 1);
+        assert(written <= unused && written <= num);
+        /* Spans end at the wrap point, single elements only once the buffer is full */
+        if(!(i & 1))
+            assert(written == (num < unused ? num : unused));
+        wseq += written;
+        assert(ecbuff_stage_used(buff) == wseq - cursor[ECBST_STAGES - 1]);
+
+        /* Each stage is limited by the one before it */
+        for(ECB_UINT_T s = 0; s < ECBST_STAGES; s++)
+        {
+            uint32_t upstream = s ? cursor[s - 1] : wseq;
+            assert(ecbuff_stage_pending(buff, s) == upstream - cursor[s]);
+            num = rand() % (upstream - cursor[s] + 2);
+            ECB_UINT_T done = ecbst_run(buff, s, cursor[s], num, (i + s) & 1);
+            assert(done <= num && done <= upstream - cursor[s]);
+            if(!((i + s) & 1))
+                assert(done == (num < upstream - cursor[s] ? num : upstream - cursor[s]));
+            cursor[s] += done;
+        }
+    }
+
+    /* Draining the pipeline stage by stage frees every slot */
+    for(ECB_UINT_T s = 0; s < ECBST_STAGES; s++)
+    {
+        uint32_t upstream = s ? cursor[s - 1] : wseq;
+        while(cursor[s] != upstream)
+            cursor[s] += ecbst_run(buff, s, cursor[s], ECBT_ELEM_CNT, true);
+        assert(!ecbuff_stage_dequeue(buff, s));
+    }
+    assert(ecbuff_stage_used(buff) == 0);
+    assert(ecbst_put(buff, wseq, ECBT_ELEM_CNT + 1, false) == ECBT_ELEM_CNT);
+    assert(!ecbuff_stage_write_alloc(buff));
+    ecbst_delete(buff);
+}
+
+void ecbst_test_mt(ECB_UINT_T count)
+{
+    ecbuff_stage* buff = ecbst_new();
+
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        pthread_t threads[ECBST_STAGES + 1];
+        ecbst_thread args[ECBST_STAGES];
+        ecbuff_stage_init(buff, ECBT_ELEM_CNT, ECBT_ELEM_SIZ, ECBST_STAGES);
+
+        for(uint32_t t = 0; t < ECBST_STAGES; t++)
+        {
+            args[t] = (ecbst_thread){buff, t};
+            if(pthread_create(&threads[t], NULL, ecbst_mt_stage, &args[t]))
+            {
+                printf("Failed to spawn thread!\n");
+                assert(false);
+                return;
+            }
+        }
+        if(pthread_create(&threads[ECBST_STAGES], NULL, ecbst_mt_source, buff))
+        {
+            printf("Failed to spawn thread!\n");
+            assert(false);
+            return;
+        }
+
+        for(uint32_t t = 0; t <= ECBST_STAGES; t++)
+            pthread_join(threads[t], NULL);
+        assert(ecbuff_stage_used(buff) == 0);
+    }
+
+    ecbst_delete(buff);
+}
+
+void* ecbst_mt_source(void* buff)
+{
+    for(uint32_t seq = 0; seq < ECBST_PER_RUN;)
+    {
+        ECB_UINT_T num = ECBST_PER_RUN - seq;
+        ECB_UINT_T written = ecbst_put(buff, seq, num < 16 ? num : 16, seq & 1);
+        if(!written)
+            sched_yield();
+        seq += written;
+    }
+
+    pthread_exit((void*)true);
+}
+
+void* ecbst_mt_stage(void* arg)
+{
+    ecbst_thread* t = arg;
+
+    /* The middle stage is slowed down, holding back the ones after it */
+    for(uint32_t seq = 0, n = 0; seq < ECBST_PER_RUN; n++)
+    {
+        if(t->id == 1 && !(rand() % 16))
+            sched_yield();
+        ECB_UINT_T done = ecbst_run(t->buff, t->id, seq, ECBST_PER_RUN - seq, (n + t->id) & 1);
+        if(!done)
+            sched_yield();
+        seq += done;
+    }
+
+    pthread_exit((void*)true);
+}
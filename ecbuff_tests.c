@@ -12,12 +12,23 @@
 #include <stdbool.h>
 #include <assert.h>
 #include <string.h>
+#if defined(ECB_THREAD_MULTI) || defined(ECB_MIRROR)
+#include <unistd.h>
+#endif
 #ifdef ECB_THREAD_MULTI
 #include <pthread.h>
-#include <unistd.h>
 #endif
 
+#if defined(ECB_POW2)
+#define ECBT_ELEM_CNT (ECBT_BUFF_SIZ / ECBT_ELEM_SIZ)
+#else
 #define ECBT_ELEM_CNT ((ECBT_BUFF_SIZ / ECBT_ELEM_SIZ) - 1)
+#endif
+
+/* Size requested from ecbuff_new_mirror(), which rounds it up */
+#if !defined(ECBT_MIRROR_SIZ)
+#define ECBT_MIRROR_SIZ ECBT_BUFF_SIZ
+#endif
 
 ecbuff* ecbt_new(ECB_UINT_T total_size, ECB_UINT_T element_size);
 void ecbt_delete(ecbuff* buff);
@@ -28,16 +39,51 @@ void ecbt_write_over(ecbuff* buff, uint8_t* write_count, uint8_t* read_count, EC
 void ecbt_write_drop(ecbuff* buff, uint8_t* write_count, ECB_UINT_T num);
 void ecbt_read(ecbuff* buff, uint8_t* read_count, ECB_UINT_T num);
 void ecbt_read_empty(ecbuff* buff, ECB_UINT_T num);
+void ecbt_write_n(ecbuff* buff, uint8_t* write_count, ECB_UINT_T num);
+void ecbt_read_n(ecbuff* buff, uint8_t* read_count, ECB_UINT_T num);
+#if defined(ECB_DIRECT_ACCESS)
+void ecbt_write_span(ecbuff* buff, uint8_t* write_count, ECB_UINT_T num);
+void ecbt_read_span(ecbuff* buff, uint8_t* read_count, ECB_UINT_T num);
+void ecbt_test_st_span(ECB_UINT_T count);
+void ecbt_test_st_peek(ECB_UINT_T count);
+void ecbt_test_mt_span(ECB_UINT_T count);
+void* ecbt_mt_source_span(void* buff);
+void* ecbt_mt_sink_span(void* buff);
+#endif
 void ecbt_test_st_basic(ECB_UINT_T count);
 void ecbt_test_st_rand(ECB_UINT_T count);
 void ecbt_test_st_rand_over(ECB_UINT_T count);
 void ecbt_test_st_rand_drop(ECB_UINT_T count);
+void ecbt_test_st_bulk(ECB_UINT_T count);
 void ecbt_test_mt_basic(ECB_UINT_T count);
 void* ecbt_mt_source_basic(void* buff);
 void* ecbt_mt_sink_basic(void* buff);
 void ecbt_test_mt_drop(ECB_UINT_T count);
 void* ecbt_mt_source_drop(void* buff);
 void* ecbt_mt_sink_drop(void* buff);
+void ecbt_test_mt_bulk(ECB_UINT_T count);
+void* ecbt_mt_source_bulk(void* buff);
+void* ecbt_mt_sink_bulk(void* buff);
+#if defined(ECB_WAIT)
+void ecbt_test_mt_wait(ECB_UINT_T count);
+void* ecbt_mt_source_wait(void* buff);
+void* ecbt_mt_sink_wait(void* buff);
+#endif
+#if defined(ECB_MIRROR)
+void ecbt_test_mirror(ECB_UINT_T count);
+#endif
+#if defined(ECB_STATS)
+void ecbt_verify_counters(ecbuff* buff, ECB_UINT_T writes, ECB_UINT_T reads, ECB_UINT_T lost,
+                          ECB_UINT_T full, ECB_UINT_T empty, ECB_UINT_T high_water);
+void ecbt_test_stats(void);
+#endif
+#if ECB_COPY == ECB_COPY_SIMD || ECB_COPY == ECB_COPY_STREAM
+void ecbt_test_copy(void);
+#endif
+#if defined(ECB_TIMESTAMP)
+ECB_UINT_T ecbt_stamped(ECB_UINT_T first, ECB_UINT_T num);
+void ecbt_test_timestamp(void);
+#endif
 
 int main(int argc, char *argv[])
 {
@@ -46,6 +92,11 @@ int main(int argc, char *argv[])
 #if defined(ECB_THREAD_SINGLE)
     ecbt_test_st_basic(1337);
     ecbt_test_st_rand(1337);
+    ecbt_test_st_bulk(1337);
+#endif
+#if defined(ECB_THREAD_SINGLE) && defined(ECB_DIRECT_ACCESS)
+    ecbt_test_st_span(1337);
+    ecbt_test_st_peek(1337);
 #endif
 #if defined(ECB_THREAD_SINGLE) && defined(ECB_WRITE_OVERWRITE)
     ecbt_test_st_rand_over(1337);
@@ -54,6 +105,27 @@ int main(int argc, char *argv[])
     ecbt_test_st_rand_drop(1337);
 #endif
 
+#if defined(ECB_MIRROR)
+    ecbt_test_mirror(1337);
+#endif
+#if defined(ECB_STATS)
+    ecbt_test_stats();
+#endif
+#if ECB_COPY == ECB_COPY_SIMD || ECB_COPY == ECB_COPY_STREAM
+    ecbt_test_copy();
+#endif
+#if defined(ECB_TIMESTAMP) && defined(ECB_THREAD_SINGLE)
+    ecbt_test_timestamp();
+#endif
+#if defined(ECB_THREAD_MULTI)
+    ecbt_test_mt_bulk(13);
+#endif
+#if defined(ECB_THREAD_MULTI) && defined(ECB_DIRECT_ACCESS)
+    ecbt_test_mt_span(13);
+#endif
+#if defined(ECB_WAIT)
+    ecbt_test_mt_wait(13);
+#endif
 #if defined(ECB_THREAD_MULTI) && !defined(ECB_WRITE_DROP)
     ecbt_test_mt_basic(13);
 #endif
@@ -136,6 +208,155 @@ void ecbt_test_mt_drop(ECB_UINT_T count)
     ecbt_delete(buff);
 }
 
+void ecbt_test_mt_bulk(ECB_UINT_T count)
+{
+    ecbuff* buff = ecbt_new(ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        pthread_t threads[2];
+        int ret[2] = {1, 1};
+        ecbuff_init(buff, ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+        if(pthread_create(&threads[0], NULL, ecbt_mt_source_bulk, (void*)buff))
+        {
+            printf("Failed to spawn source thread!\n");
+            assert(false);
+            return;
+        }
+
+        if(pthread_create(&threads[1], NULL, ecbt_mt_sink_bulk, (void*)buff))
+        {
+            printf("Failed to spawn sink thread!\n");
+            assert(false);
+            return;
+        }
+
+#if defined(ECB_STATS)
+        /* Poll the counters like a monitoring thread would */
+        ecbuff_stats last = {0};
+        for(;;)
+        {
+            ecbuff_stats now;
+            ecbuff_stats_get(buff, &now);
+            assert(now.writes >= last.writes && now.reads >= last.reads);
+            assert(now.high_water >= last.high_water && now.high_water <= ECBT_ELEM_CNT);
+            assert(!now.drops && !now.overwrites);
+            last = now;
+            if(now.reads == ECBT_ELEM_CNT * 10)
+                break;
+            usleep(100);
+        }
+        assert(last.writes == ECBT_ELEM_CNT * 10);
+#endif
+
+        pthread_join(threads[0], (void*)&ret[0]);
+        pthread_join(threads[1], (void*)&ret[1]);
+        if(!ret[0] || !ret[1])
+        {
+            assert(false);
+            return;
+        }
+    }
+
+    ecbt_delete(buff);
+}
+
+#if defined(ECB_DIRECT_ACCESS)
+void ecbt_test_mt_span(ECB_UINT_T count)
+{
+    ecbuff* buff = ecbt_new(ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        pthread_t threads[2];
+        int ret[2] = {1, 1};
+        ecbuff_init(buff, ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+        if(pthread_create(&threads[0], NULL, ecbt_mt_source_span, (void*)buff))
+        {
+            printf("Failed to spawn source thread!\n");
+            assert(false);
+            return;
+        }
+
+        if(pthread_create(&threads[1], NULL, ecbt_mt_sink_span, (void*)buff))
+        {
+            printf("Failed to spawn sink thread!\n");
+            assert(false);
+            return;
+        }
+
+        pthread_join(threads[0], (void*)&ret[0]);
+        pthread_join(threads[1], (void*)&ret[1]);
+        if(!ret[0] || !ret[1])
+        {
+            assert(false);
+            return;
+        }
+    }
+
+    ecbt_delete(buff);
+}
+
+void* ecbt_mt_source_span(void* buff)
+{
+    uint8_t write_count = 0;
+
+    for(unsigned int i = 0; i < (ECBT_ELEM_CNT * 10);)
+    {
+        ECB_UINT_T num;
+        uint8_t* ptr = (uint8_t*)ecbuff_write_alloc_span(buff, &num);
+        if(!ptr)
+        {
+            usleep(1000);
+            continue;
+        }
+        if(num > (ECBT_ELEM_CNT * 10) - i)
+            num = (ECBT_ELEM_CNT * 10) - i;
+        for(ECB_UINT_T j = 0; j < num; j++)
+        {
+            memset(ptr + j * ECBT_ELEM_SIZ, 0, ECBT_ELEM_SIZ);
+            memcpy(ptr + j * ECBT_ELEM_SIZ, &write_count, sizeof(write_count));
+            write_count = ecbt_val_next(write_count);
+        }
+        ecbuff_write_enqueue_n(buff, num);
+        i += num;
+    }
+
+    pthread_exit((void*)true);
+}
+
+void* ecbt_mt_sink_span(void* buff)
+{
+    uint8_t expected_read_value = 0;
+
+    for(unsigned int i = 0; i < (ECBT_ELEM_CNT * 10);)
+    {
+        ECB_UINT_T num;
+        uint8_t* ptr = (uint8_t*)ecbuff_read_dequeue_span(buff, &num);
+        if(!ptr)
+        {
+            usleep(1000);
+            continue;
+        }
+        for(ECB_UINT_T j = 0; j < num; j++)
+        {
+            if(memcmp(ptr + j * ECBT_ELEM_SIZ, &expected_read_value, sizeof(expected_read_value)))
+            {
+                printf("Read unexpected value! (%hhu instead of %hhu)\n", ptr[j * ECBT_ELEM_SIZ], expected_read_value);
+                assert(false);
+                pthread_exit((void*)false);
+            }
+            expected_read_value = ecbt_val_next(expected_read_value);
+        }
+        assert(ecbuff_peek(buff, num - 1) == ptr + (num - 1) * ECBT_ELEM_SIZ);
+        ecbuff_read_free_n(buff, num);
+        i += num;
+    }
+
+    pthread_exit((void*)true);
+}
+#endif
+
 void* ecbt_mt_source_basic(void* buff)
 {
     uint8_t write_value[ECBT_ELEM_SIZ];
@@ -175,6 +396,40 @@ void* ecbt_mt_source_drop(void* buff)
     pthread_exit((void*)true);
 }
 
+void* ecbt_mt_source_bulk(void* buff)
+{
+    uint8_t write_values[ECBT_ELEM_CNT][ECBT_ELEM_SIZ];
+    uint8_t write_count = 0;
+    memset(write_values, 0, sizeof(write_values));
+
+    for(unsigned int i = 0; i < (ECBT_ELEM_CNT * 10);)
+    {
+        ECB_UINT_T num = ecbuff_unused(buff);
+        if(!num)
+        {
+            usleep(1000);
+            continue;
+        }
+        num = (rand() % num) + 1;
+        if(num > (ECBT_ELEM_CNT * 10) - i)
+            num = (ECBT_ELEM_CNT * 10) - i;
+        for(ECB_UINT_T j = 0; j < num; j++)
+        {
+            memcpy(write_values[j], &write_count, sizeof(write_count));
+            write_count = ecbt_val_next(write_count);
+        }
+        if(ecbuff_write_n(buff, write_values, num) != num)
+        {
+            printf("ecbuff_write_n() failed to write %u elements!\n", (unsigned int)num);
+            assert(false);
+            pthread_exit((void*)false);
+        }
+        i += num;
+    }
+
+    pthread_exit((void*)true);
+}
+
 void* ecbt_mt_sink_basic(void* buff)
 {
     uint8_t read_value[ECBT_ELEM_SIZ];
@@ -218,6 +473,145 @@ void* ecbt_mt_sink_drop(void* buff)
 
     pthread_exit((void*)true);    
 }
+
+void* ecbt_mt_sink_bulk(void* buff)
+{
+    uint8_t read_values[ECBT_ELEM_CNT][ECBT_ELEM_SIZ];
+    uint8_t expected_read_value = 0;
+
+    for(unsigned int i = 0; i < (ECBT_ELEM_CNT * 10);)
+    {
+        ECB_UINT_T num = ecbuff_used(buff);
+        if(!num)
+        {
+            usleep(1000);
+            continue;
+        }
+        num = ecbuff_read_n(buff, read_values, num);
+        for(ECB_UINT_T j = 0; j < num; j++)
+        {
+            if(memcmp(read_values[j], &expected_read_value, sizeof(expected_read_value)))
+            {
+                printf("Read unexpected value! (%hhu instead of %hhu)\n", read_values[j][0], expected_read_value);
+                assert(false);
+                pthread_exit((void*)false);
+            }
+            expected_read_value = ecbt_val_next(expected_read_value);
+        }
+        i += num;
+    }
+
+    pthread_exit((void*)true);
+}
+#endif
+
+#if defined(ECB_WAIT)
+static uint64_t ecbt_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+void ecbt_test_mt_wait(ECB_UINT_T count)
+{
+    ecbuff* buff = ecbt_new(ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+    uint8_t value[ECBT_ELEM_SIZ];
+    memset(value, 0, ECBT_ELEM_SIZ);
+
+    /* Time out on an empty and on a full buffer */
+    uint64_t start = ecbt_now_us();
+    assert(!ecbuff_read_wait(buff, value, 2000));
+    assert(ecbt_now_us() - start >= 2000);
+    assert(!ecbuff_read_wait(buff, value, 0));
+    for(ECB_UINT_T i = 0; i < ECBT_ELEM_CNT; i++)
+        assert(ecbuff_write_wait(buff, value, 0));
+    start = ecbt_now_us();
+    assert(!ecbuff_write_wait(buff, value, 2000));
+    assert(ecbt_now_us() - start >= 2000);
+    assert(ecbuff_read_wait(buff, value, 0));
+    assert(ecbuff_write_wait(buff, value, 0));
+
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        pthread_t threads[2];
+        int ret[2] = {1, 1};
+        ecbuff_init(buff, ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+        if(pthread_create(&threads[0], NULL, ecbt_mt_source_wait, (void*)buff))
+        {
+            printf("Failed to spawn source thread!\n");
+            assert(false);
+            return;
+        }
+
+        if(pthread_create(&threads[1], NULL, ecbt_mt_sink_wait, (void*)buff))
+        {
+            printf("Failed to spawn sink thread!\n");
+            assert(false);
+            return;
+        }
+
+        pthread_join(threads[0], (void*)&ret[0]);
+        pthread_join(threads[1], (void*)&ret[1]);
+        if(!ret[0] || !ret[1])
+        {
+            assert(false);
+            return;
+        }
+        assert(ecbuff_is_empty(buff));
+    }
+
+    ecbt_delete(buff);
+}
+
+/* Pauses now and then, so both sides get to park */
+void* ecbt_mt_source_wait(void* buff)
+{
+    uint8_t write_value[ECBT_ELEM_SIZ];
+    uint8_t write_count = 0;
+    memset(write_value, 0, ECBT_ELEM_SIZ);
+
+    for(unsigned int i = 0; i < (ECBT_ELEM_CNT * 10); i++)
+    {
+        if(!(rand() % 16))
+            usleep(rand() % 1000);
+        memcpy(write_value, &write_count, sizeof(write_count));
+        if(!ecbuff_write_wait(buff, write_value, ECB_WAIT_FOREVER))
+        {
+            assert(false);
+            pthread_exit((void*)false);
+        }
+        write_count = ecbt_val_next(write_count);
+    }
+
+    pthread_exit((void*)true);
+}
+
+void* ecbt_mt_sink_wait(void* buff)
+{
+    uint8_t read_value[ECBT_ELEM_SIZ];
+    uint8_t expected_read_value = 0;
+
+    for(unsigned int i = 0; i < (ECBT_ELEM_CNT * 10); i++)
+    {
+        if(!(rand() % 16))
+            usleep(rand() % 1000);
+        if(!ecbuff_read_wait(buff, read_value, ECB_WAIT_FOREVER))
+        {
+            assert(false);
+            pthread_exit((void*)false);
+        }
+        if(memcmp(read_value, &expected_read_value, sizeof(expected_read_value)))
+        {
+            printf("Read unexpected value! (%hhu instead of %hhu)\n", (uint8_t)*read_value, (uint8_t)expected_read_value);
+            assert(false);
+            pthread_exit((void*)false);
+        }
+        expected_read_value = ecbt_val_next(expected_read_value);
+    }
+
+    pthread_exit((void*)true);
+}
 #endif
 
 void ecbt_test_st_basic(ECB_UINT_T count)
@@ -307,6 +701,337 @@ void ecbt_test_st_rand_drop(ECB_UINT_T count)
     ecbt_delete(buff);
 }
 
+void ecbt_test_st_bulk(ECB_UINT_T count)
+{
+    srand(time(NULL));
+    uint8_t write_count = ecbt_val_next((ECB_UINT_T)rand());
+    uint8_t read_count = write_count;
+
+    ecbuff* buff = ecbt_new(ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        ECB_UINT_T rnd = rand() % (ecbuff_unused(buff) + 1);
+        ecbt_write_n(buff, &write_count, rnd);
+        rnd = rand() % (ecbuff_used(buff) + 1);
+        ecbt_read_n(buff, &read_count, rnd);
+    }
+    ecbt_read_n(buff, &read_count, ecbuff_used(buff));
+
+#if defined(ECB_WRITE_DROP) || defined(ECB_WRITE_OVERWRITE) || defined(ECB_EXTRA_CHECKS)
+    uint8_t values[ECBT_ELEM_CNT * 3][ECBT_ELEM_SIZ];
+    memset(values, 0, sizeof(values));
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        ECB_UINT_T used = ecbuff_used(buff);
+        ECB_UINT_T rnd = rand() % (ECBT_ELEM_CNT * 3 + 1);
+        ECB_UINT_T ret;
+#if defined(ECB_WRITE_DROP) || defined(ECB_WRITE_OVERWRITE)
+        for(ECB_UINT_T j = 0; j < rnd; j++)
+        {
+            memcpy(values[j], &write_count, sizeof(write_count));
+            write_count = ecbt_val_next(write_count);
+        }
+        ret = ecbuff_write_n(buff, values, rnd);
+#if defined(ECB_WRITE_DROP)
+        /* Elements that didn't fit have been dropped */
+        assert(ret == (rnd < ECBT_ELEM_CNT - used ? rnd : ECBT_ELEM_CNT - used));
+        if(ret < rnd)
+            write_count = values[ret][0];
+        used += ret;
+#else
+        /* Oldest elements have been evicted */
+        assert(ret == rnd);
+        for(ECB_UINT_T j = ECBT_ELEM_CNT; j < used + rnd; j++)
+            read_count = ecbt_val_next(read_count);
+        used = (used + rnd > ECBT_ELEM_CNT) ? ECBT_ELEM_CNT : used + rnd;
+#endif
+        ecbt_verify_stats(buff, used);
+#else
+        ecbt_write_n(buff, &write_count, rand() % (ECBT_ELEM_CNT - used + 1));
+        used = ecbuff_used(buff);
+#endif /* ECB_WRITE_DROP || ECB_WRITE_OVERWRITE */
+#if defined(ECB_EXTRA_CHECKS)
+        /* Reading more than available only returns what is there */
+        rnd = used + (rand() % (ECBT_ELEM_CNT + 1));
+        ret = ecbuff_read_n(buff, values, rnd);
+        assert(ret == used);
+        for(ECB_UINT_T j = 0; j < ret; j++)
+        {
+            if(memcmp(values[j], &read_count, sizeof(read_count)))
+            {
+                printf("Read unexpected value! (%hhu instead of %hhu)\n", values[j][0], read_count);
+                assert(false);
+                return;
+            }
+            read_count = ecbt_val_next(read_count);
+        }
+        ecbt_verify_stats(buff, 0);
+#else
+        ecbt_read_n(buff, &read_count, used);
+#endif
+    }
+#endif
+    ecbt_delete(buff);
+}
+
+#if defined(ECB_DIRECT_ACCESS)
+void ecbt_test_st_span(ECB_UINT_T count)
+{
+    srand(time(NULL));
+    uint8_t write_count = ecbt_val_next((ECB_UINT_T)rand());
+    uint8_t read_count = write_count;
+
+    ecbuff* buff = ecbt_new(ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        ECB_UINT_T rnd = rand() % (ecbuff_unused(buff) + 1);
+        ecbt_write_span(buff, &write_count, rnd);
+        rnd = rand() % (ecbuff_used(buff) + 1);
+        ecbt_read_span(buff, &read_count, rnd);
+    }
+    ecbt_read_span(buff, &read_count, ecbuff_used(buff));
+
+    ECB_UINT_T num;
+    assert(!ecbuff_read_dequeue_span(buff, &num));
+    assert(num == 0);
+#if defined(ECB_EXTRA_CHECKS)
+    assert(!ecbuff_read_free_n(buff, 1));
+#endif
+#if !defined(ECB_WRITE_OVERWRITE)
+    ecbt_write_span(buff, &write_count, ECBT_ELEM_CNT);
+    assert(!ecbuff_write_alloc_span(buff, &num));
+    assert(num == 0);
+#endif
+    ecbt_delete(buff);
+}
+#endif
+
+#if defined(ECB_DIRECT_ACCESS)
+/* Looks ahead at random fill levels, then consumes a random prefix */
+void ecbt_test_st_peek(ECB_UINT_T count)
+{
+    srand(time(NULL));
+    uint8_t write_count = ecbt_val_next((ECB_UINT_T)rand());
+    uint8_t read_count = write_count;
+
+    ecbuff* buff = ecbt_new(ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+    ecbuff_iter it;
+    assert(!ecbuff_peek(buff, 0));
+    assert(ecbuff_iter_init(&it, buff) == 0);
+    assert(!ecbuff_iter_next(&it));
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        ecbt_write(buff, &write_count, rand() % (ecbuff_unused(buff) + 1));
+        ECB_UINT_T used = ecbuff_used(buff);
+        uint8_t expected = read_count;
+        for(ECB_UINT_T j = 0; j < used; j++)
+        {
+            uint8_t* ptr = (uint8_t*)ecbuff_peek(buff, j);
+            assert(ptr);
+            if(memcmp(ptr, &expected, sizeof(expected)))
+            {
+                printf("Peeked unexpected value! (%hhu instead of %hhu)\n", *ptr, expected);
+                assert(false);
+                return;
+            }
+            expected = ecbt_val_next(expected);
+        }
+        assert(!ecbuff_peek(buff, used));
+
+        expected = read_count;
+        assert(ecbuff_iter_init(&it, buff) == used);
+        for(ECB_UINT_T j = 0; j < used; j++)
+        {
+            uint8_t* ptr = (uint8_t*)ecbuff_iter_next(&it);
+            assert(ptr == ecbuff_peek(buff, j));
+            assert(!memcmp(ptr, &expected, sizeof(expected)));
+            expected = ecbt_val_next(expected);
+        }
+        assert(!ecbuff_iter_next(&it));
+        ecbt_verify_stats(buff, used);
+
+        ECB_UINT_T n = rand() % (used + 1);
+        ecbuff_read_free_n(buff, n);
+        while(n--)
+            read_count = ecbt_val_next(read_count);
+    }
+    ecbt_delete(buff);
+}
+#endif
+
+#if defined(ECB_MIRROR)
+void ecbt_test_mirror(ECB_UINT_T count)
+{
+    srand(time(NULL));
+    uint8_t write_count = ecbt_val_next((ECB_UINT_T)rand());
+    uint8_t read_count = write_count;
+
+    ecbuff* buff = ecbuff_new_mirror(ECBT_MIRROR_SIZ, ECBT_ELEM_SIZ);
+    assert(buff);
+    ECB_UINT_T total = buff->total_size;
+    assert(total >= ECBT_MIRROR_SIZ);
+    assert(!(total % (ECB_UINT_T)sysconf(_SC_PAGESIZE)) && !(total % ECBT_ELEM_SIZ));
+#if defined(ECB_POW2)
+    assert(!(total & (total - 1)));
+    ECB_UINT_T cnt = total / ECBT_ELEM_SIZ;
+#else
+    ECB_UINT_T cnt = total / ECBT_ELEM_SIZ - 1;
+#endif
+    assert(ecbuff_unused(buff) == cnt);
+
+    /* Both mappings alias the same memory */
+    buff->elems[0] = 0x5a;
+    assert(buff->elems[total] == 0x5a);
+    buff->elems[total + total - 1] = 0xa5;
+    assert((uint8_t)buff->elems[total - 1] == 0xa5);
+
+    uint8_t (*values)[ECBT_ELEM_SIZ] = malloc((size_t)cnt * ECBT_ELEM_SIZ);
+    assert(values);
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        ECB_UINT_T rnd = rand() % (ecbuff_unused(buff) + 1);
+        for(ECB_UINT_T j = 0; j < rnd; j++)
+        {
+            memset(values[j], 0, ECBT_ELEM_SIZ);
+            memcpy(values[j], &write_count, sizeof(write_count));
+            write_count = ecbt_val_next(write_count);
+        }
+        assert(ecbuff_write_n(buff, values, rnd) == rnd);
+
+#if defined(ECB_DIRECT_ACCESS)
+        /* Spans are no longer cut short at the wrap point. With ECB_CACHE_PAD
+         * they may still be limited by the cached copy of the peer's index.
+         */
+        ECB_UINT_T num;
+        ECB_UINT_T used = ecbuff_used(buff);
+        ecbuff_read_dequeue_span(buff, &num);
+#if defined(ECB_CACHE_PAD)
+        assert(num <= used && (num || !used));
+#else
+        assert(num == used);
+#endif
+        ecbuff_write_alloc_span(buff, &num);
+#if defined(ECB_CACHE_PAD)
+        assert(num <= cnt - used && (num || used == cnt));
+#else
+        assert(num == cnt - used);
+#endif
+#endif
+
+        rnd = rand() % (ecbuff_used(buff) + 1);
+        assert(ecbuff_read_n(buff, values, rnd) == rnd);
+        for(ECB_UINT_T j = 0; j < rnd; j++)
+        {
+            if(memcmp(values[j], &read_count, sizeof(read_count)))
+            {
+                printf("Read unexpected value! (%hhu instead of %hhu)\n", values[j][0], read_count);
+                assert(false);
+                return;
+            }
+            read_count = ecbt_val_next(read_count);
+        }
+    }
+
+    free(values);
+    ecbuff_delete_mirror(buff);
+}
+#endif
+
+#if defined(ECB_STATS)
+/* lost refers to drops or overwrites, depending on the configuration */
+void ecbt_verify_counters(ecbuff* buff, ECB_UINT_T writes, ECB_UINT_T reads, ECB_UINT_T lost,
+                          ECB_UINT_T full, ECB_UINT_T empty, ECB_UINT_T high_water)
+{
+    ecbuff_stats stats;
+    ecbuff_stats_get(buff, &stats);
+#if defined(ECB_WRITE_OVERWRITE)
+    assert(stats.overwrites == lost && !stats.drops);
+    assert(stats.writes - stats.overwrites - stats.reads == ecbuff_used(buff));
+#else
+    assert(stats.drops == lost && !stats.overwrites);
+    assert(stats.writes - stats.reads == ecbuff_used(buff));
+#endif
+    if(stats.writes != writes || stats.reads != reads || stats.full != full ||
+       stats.empty != empty || stats.high_water != high_water)
+    {
+        printf("ecbuff_stats_get() reports wrong values! (%u/%u/%u/%u/%u expected %u/%u/%u/%u/%u)\n",
+               (unsigned int)stats.writes, (unsigned int)stats.reads, (unsigned int)stats.full,
+               (unsigned int)stats.empty, (unsigned int)stats.high_water,
+               (unsigned int)writes, (unsigned int)reads, (unsigned int)full,
+               (unsigned int)empty, (unsigned int)high_water);
+        assert(false);
+    }
+}
+
+void ecbt_test_stats(void)
+{
+    uint8_t values[ECBT_ELEM_CNT + 2][ECBT_ELEM_SIZ];
+    memset(values, 0, sizeof(values));
+    ECB_UINT_T w = 0, r = 0, lost = 0, full = 0, empty = 0;
+
+    ecbuff* buff = ecbt_new(ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+    ecbt_verify_counters(buff, 0, 0, 0, 0, 0, 0);
+
+    for(ECB_UINT_T i = 0; i < ECBT_ELEM_CNT; i++)
+        ecbuff_write(buff, values[0]);
+    w += ECBT_ELEM_CNT;
+    ecbt_verify_counters(buff, w, r, lost, full, empty, ECBT_ELEM_CNT);
+
+#if defined(ECB_WRITE_DROP)
+    /* Writes into a full buffer are counted as drops */
+    ecbuff_write(buff, values[0]);
+    ecbuff_write_n(buff, values, 2);
+    lost += 3;
+    full += 2;
+    ecbt_verify_counters(buff, w, r, lost, full, empty, ECBT_ELEM_CNT);
+#elif defined(ECB_WRITE_OVERWRITE)
+    /* Or as overwrites */
+    ecbuff_write(buff, values[0]);
+    ecbuff_write_n(buff, values, 2);
+    w += 3;
+    lost += 3;
+    full += 2;
+    ecbt_verify_counters(buff, w, r, lost, full, empty, ECBT_ELEM_CNT);
+#endif
+
+    ECB_UINT_T half = ECBT_ELEM_CNT / 2;
+    ecbuff_read_n(buff, values, half);
+    ecbuff_read_n(buff, values, ECBT_ELEM_CNT - half);
+    r += ECBT_ELEM_CNT;
+    ecbt_verify_counters(buff, w, r, lost, full, empty, ECBT_ELEM_CNT);
+
+#if defined(ECB_EXTRA_CHECKS)
+    /* Reading an empty buffer is only defined with ECB_EXTRA_CHECKS */
+    ecbuff_read(buff, values[0]);
+    ecbuff_read_n(buff, values, 1);
+    empty += 2;
+    ecbt_verify_counters(buff, w, r, lost, full, empty, ECBT_ELEM_CNT);
+#endif
+
+#if defined(ECB_DIRECT_ACCESS)
+    ECB_UINT_T num;
+    assert(!ecbuff_read_dequeue_span(buff, &num));
+    empty++;
+    ecbuff_write_alloc(buff);
+    ecbuff_write_enqueue(buff);
+    ecbuff_read_dequeue(buff);
+    ecbuff_read_free(buff);
+    assert(ecbuff_write_alloc_span(buff, &num));
+    ecbuff_write_enqueue_n(buff, 1);
+    assert(ecbuff_read_dequeue_span(buff, &num));
+    ecbuff_read_free_n(buff, 1);
+    w += 2;
+    r += 2;
+    ecbt_verify_counters(buff, w, r, lost, full, empty, ECBT_ELEM_CNT);
+#endif
+
+    /* ecbuff_init() clears the counters */
+    ecbuff_init(buff, ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+    ecbt_verify_counters(buff, 0, 0, 0, 0, 0, 0);
+    ecbt_delete(buff);
+}
+#endif
+
 uint8_t ecbt_val_next(uint8_t lastval)
 {
     return (lastval + 31337);
@@ -318,6 +1043,14 @@ ecbuff* ecbt_new(ECB_UINT_T total_size, ECB_UINT_T element_size)
     assert(buff);
 
     ecbuff_init(buff, total_size, element_size);
+#if defined(ECB_TIMESTAMP)
+    /* Every test runs timed */
+    uint64_t* stamps = malloc(ECB_TIMESTAMP_SLOTS(total_size, element_size) * sizeof(uint64_t));
+    ehist* hist = malloc(sizeof(ehist));
+    assert(stamps && hist);
+    ehist_init(hist);
+    ecbuff_timestamp_init(buff, stamps, hist);
+#endif
     ecbt_verify_stats(buff, 0);
     return buff;
 }
@@ -325,6 +1058,10 @@ ecbuff* ecbt_new(ECB_UINT_T total_size, ECB_UINT_T element_size)
 void ecbt_delete(ecbuff* buff)
 {
     assert(buff);
+#if defined(ECB_TIMESTAMP)
+    free((void*)buff->timestamp.stamps);
+    free(buff->timestamp.hist);
+#endif
     free(buff);
 }
 
@@ -334,7 +1071,7 @@ void ecbt_verify_stats(ecbuff* buff, ECB_UINT_T used_elements)
     if(ret != ECBT_ELEM_CNT - used_elements)
     {
         printf("ecbuff_unused() reports wrong value! (%u expected %u)\n",
-                ret, (unsigned int)(ECBT_ELEM_CNT - used_elements));
+                (unsigned int)ret, (unsigned int)(ECBT_ELEM_CNT - used_elements));
         assert(false);
         return;
     }
@@ -343,7 +1080,7 @@ void ecbt_verify_stats(ecbuff* buff, ECB_UINT_T used_elements)
     if(ret != used_elements)
     {
         printf("ecbuff_used() reports wrong value! (%u expected %u)\n",
-                ret, used_elements);
+                (unsigned int)ret, (unsigned int)used_elements);
         assert(false);
         return;
     }
@@ -352,7 +1089,7 @@ void ecbt_verify_stats(ecbuff* buff, ECB_UINT_T used_elements)
     if(ret != (used_elements == 0))
     {
         printf("ecbuff_is_empty() reports wrong value! (%u expected %u)\n",
-                ret, (used_elements == 0));
+                (unsigned int)ret, (used_elements == 0));
         assert(false);
         return;
     }
@@ -361,7 +1098,7 @@ void ecbt_verify_stats(ecbuff* buff, ECB_UINT_T used_elements)
     if(ret != (used_elements == ECBT_ELEM_CNT))
     {
         printf("ecbuff_is_full() reports wrong value! (%u expected %u)\n",
-                ret, (used_elements == ECBT_ELEM_CNT));
+                (unsigned int)ret, (used_elements == ECBT_ELEM_CNT));
         assert(false);
         return;
     }
@@ -382,7 +1119,7 @@ void ecbt_write(ecbuff* buff, uint8_t* write_count, ECB_UINT_T num)
 #elif !defined(ECB_EXTRA_CHECKS) && !defined(ECB_DIRECT_ACCESS)
         ecbuff_write(buff, write_value);
 #elif defined(ECB_DIRECT_ACCESS)
-        void* ptr = ecbuff_write_alloc(buff);
+        void* ptr = (void*)ecbuff_write_alloc(buff);
         assert(ptr);
         memcpy(ptr, write_value, ECBT_ELEM_SIZ);
 #if defined(ECB_EXTRA_CHECKS)
@@ -409,7 +1146,7 @@ void ecbt_read(ecbuff* buff, uint8_t* read_count, ECB_UINT_T num)
 #elif !defined(ECB_EXTRA_CHECKS) && !defined(ECB_DIRECT_ACCESS)
         ecbuff_read(buff, read_value);
 #elif defined(ECB_DIRECT_ACCESS)
-        void* ptr = ecbuff_read_dequeue(buff);
+        void* ptr = (void*)ecbuff_read_dequeue(buff);
         assert(ptr);
         memcpy(read_value, ptr, ECBT_ELEM_SIZ);
 #if defined(ECB_EXTRA_CHECKS)
@@ -440,7 +1177,7 @@ void ecbt_read_empty(ecbuff* buff, ECB_UINT_T num)
         uint8_t read_value[ECBT_ELEM_SIZ];
         assert(!ecbuff_read(buff, read_value));
 #elif defined(ECB_EXTRA_CHECKS) && defined(ECB_DIRECT_ACCESS)
-        void* ptr = ecbuff_read_dequeue(buff);
+        void* ptr = (void*)ecbuff_read_dequeue(buff);
         assert(!ptr);
         assert(!ecbuff_read_free(buff));
 #else
@@ -468,7 +1205,7 @@ void ecbt_write_over(ecbuff* buff, uint8_t* write_count, uint8_t* read_count, EC
 #elif !defined(ECB_EXTRA_CHECKS) && !defined(ECB_DIRECT_ACCESS)
         ecbuff_write(buff, write_value);
 #elif defined(ECB_DIRECT_ACCESS)
-        void* ptr = ecbuff_write_alloc(buff);
+        void* ptr = (void*)ecbuff_write_alloc(buff);
         assert(ptr);
         memcpy(ptr, write_value, ECBT_ELEM_SIZ);
 #if defined(ECB_EXTRA_CHECKS)
@@ -499,7 +1236,7 @@ void ecbt_write_drop(ecbuff* buff, uint8_t* write_count, ECB_UINT_T num)
 #elif !defined(ECB_EXTRA_CHECKS) && !defined(ECB_DIRECT_ACCESS)
         ecbuff_write(buff, write_value);
 #elif defined(ECB_DIRECT_ACCESS)
-        void* ptr = ecbuff_write_alloc(buff);
+        void* ptr = (void*)ecbuff_write_alloc(buff);
         assert(ptr);
         memcpy(ptr, write_value, ECBT_ELEM_SIZ);
 #if defined(ECB_EXTRA_CHECKS)
@@ -511,4 +1248,216 @@ void ecbt_write_drop(ecbuff* buff, uint8_t* write_count, ECB_UINT_T num)
         ecbt_verify_stats(buff, ECBT_ELEM_CNT);
         *write_count = ecbt_val_next(*write_count);
     }
-}
\ No newline at end of file
+}
+
+void ecbt_write_n(ecbuff* buff, uint8_t* write_count, ECB_UINT_T num)
+{
+    uint8_t write_values[ECBT_ELEM_CNT][ECBT_ELEM_SIZ];
+    memset(write_values, 0, sizeof(write_values));
+    assert(num <= ECBT_ELEM_CNT);
+
+    ECB_UINT_T oldlevel = ecbuff_used(buff);
+    for(ECB_UINT_T i = 0; i < num; i++)
+    {
+        memcpy(write_values[i], write_count, sizeof(*write_count));
+        *write_count = ecbt_val_next(*write_count);
+    }
+    if(ecbuff_write_n(buff, write_values, num) != num)
+    {
+        printf("ecbuff_write_n() failed to write %u elements!\n", (unsigned int)num);
+        assert(false);
+        return;
+    }
+    ecbt_verify_stats(buff, oldlevel + num);
+}
+
+void ecbt_read_n(ecbuff* buff, uint8_t* read_count, ECB_UINT_T num)
+{
+    uint8_t read_values[ECBT_ELEM_CNT][ECBT_ELEM_SIZ];
+    assert(num <= ECBT_ELEM_CNT);
+
+    ECB_UINT_T oldlevel = ecbuff_used(buff);
+    if(ecbuff_read_n(buff, read_values, num) != num)
+    {
+        printf("ecbuff_read_n() failed to read %u elements!\n", (unsigned int)num);
+        assert(false);
+        return;
+    }
+    for(ECB_UINT_T i = 0; i < num; i++)
+    {
+        if(memcmp(read_values[i], read_count, sizeof(*read_count)))
+        {
+            printf("Read unexpected value! (%hhu instead of %hhu)\n", read_values[i][0], *read_count);
+            assert(false);
+            return;
+        }
+        *read_count = ecbt_val_next(*read_count);
+    }
+    ecbt_verify_stats(buff, oldlevel - num);
+}
+
+#if defined(ECB_DIRECT_ACCESS)
+void ecbt_write_span(ecbuff* buff, uint8_t* write_count, ECB_UINT_T num)
+{
+    ECB_UINT_T oldlevel = ecbuff_used(buff);
+    ECB_UINT_T left = num;
+    while(left)
+    {
+        ECB_UINT_T span;
+        uint8_t* ptr = (uint8_t*)ecbuff_write_alloc_span(buff, &span);
+        assert(ptr);
+        assert(span);
+        if(span > left)
+            span = left;
+        for(ECB_UINT_T i = 0; i < span; i++)
+        {
+            memset(ptr + i * ECBT_ELEM_SIZ, 0, ECBT_ELEM_SIZ);
+            memcpy(ptr + i * ECBT_ELEM_SIZ, write_count, sizeof(*write_count));
+            *write_count = ecbt_val_next(*write_count);
+        }
+#if defined(ECB_EXTRA_CHECKS)
+        assert(ecbuff_write_enqueue_n(buff, span));
+#else
+        ecbuff_write_enqueue_n(buff, span);
+#endif
+        left -= span;
+    }
+    ecbt_verify_stats(buff, oldlevel + num);
+}
+
+void ecbt_read_span(ecbuff* buff, uint8_t* read_count, ECB_UINT_T num)
+{
+    ECB_UINT_T oldlevel = ecbuff_used(buff);
+    ECB_UINT_T left = num;
+    while(left)
+    {
+        ECB_UINT_T span;
+        uint8_t* ptr = (uint8_t*)ecbuff_read_dequeue_span(buff, &span);
+        assert(ptr);
+        assert(span);
+        if(span > left)
+            span = left;
+        for(ECB_UINT_T i = 0; i < span; i++)
+        {
+            if(memcmp(ptr + i * ECBT_ELEM_SIZ, read_count, sizeof(*read_count)))
+            {
+                printf("Read unexpected value! (%hhu instead of %hhu)\n", ptr[i * ECBT_ELEM_SIZ], *read_count);
+                assert(false);
+                return;
+            }
+            *read_count = ecbt_val_next(*read_count);
+        }
+#if defined(ECB_EXTRA_CHECKS)
+        assert(ecbuff_read_free_n(buff, span));
+#else
+        ecbuff_read_free_n(buff, span);
+#endif
+        left -= span;
+    }
+    ecbt_verify_stats(buff, oldlevel - num);
+}
+#endif
+
+#if ECB_COPY == ECB_COPY_SIMD || ECB_COPY == ECB_COPY_STREAM
+/* Compares the copy engine against memcpy() for every length up to beyond
+ * streaming and all relative alignments, the bytes around must stay intact. */
+void ecbt_test_copy(void)
+{
+    enum { LEN_MAX = 1100, OFS_MAX = 32 };
+    static uint8_t src[LEN_MAX + OFS_MAX];
+    static uint8_t dst[LEN_MAX + 2 * OFS_MAX];
+    static uint8_t expected[LEN_MAX + 2 * OFS_MAX];
+    for(size_t i = 0; i < sizeof(src); i++)
+        src[i] = (uint8_t)(i * 13 + 1);
+    for(size_t len = 0; len <= LEN_MAX; len += len < 300 ? 1 : 37)
+    {
+        for(size_t so = 0; so < OFS_MAX; so += 3)
+        {
+            for(size_t dof = 0; dof < OFS_MAX; dof++)
+            {
+                memset(dst, 0xA5, sizeof(dst));
+                memset(expected, 0xA5, sizeof(expected));
+                memcpy(expected + dof, src + so, len);
+                ecbuff_copy(dst + dof, src + so, len);
+                assert(!memcmp(dst, expected, sizeof(dst)));
+                memset(dst, 0xA5, sizeof(dst));
+                ecbuff_copy_stream(dst + dof, src + so, len);
+                assert(!memcmp(dst, expected, sizeof(dst)));
+            }
+        }
+    }
+    assert(ecbuff_copy_name());
+}
+#endif
+
+#if defined(ECB_TIMESTAMP)
+/* Number of stamped slots among num elements starting at slot first */
+ECB_UINT_T ecbt_stamped(ECB_UINT_T first, ECB_UINT_T num)
+{
+    ECB_UINT_T stamped = 0;
+    for(ECB_UINT_T i = first; i < first + num; i++)
+    {
+        if((i % (ECBT_BUFF_SIZ / ECBT_ELEM_SIZ)) % ECB_TIMESTAMP_EVERY == 0)
+            stamped++;
+    }
+    return stamped;
+}
+
+/* Elements sit in the buffer for a millisecond, once through each API and
+ * across the wrap point. Every stamped slot has to be recorded once. */
+void ecbt_test_timestamp(void)
+{
+    const struct timespec delay = {0, 1000000};
+    uint8_t write_count = 0, read_count = 0;
+    ECB_UINT_T slot = 0, expected = 0;
+    ehist_snap snap;
+    ecbuff* buff = ecbt_new(ECBT_BUFF_SIZ, ECBT_ELEM_SIZ);
+
+    ecbt_write(buff, &write_count, ECBT_ELEM_CNT);
+    nanosleep(&delay, NULL);
+    ecbt_read(buff, &read_count, ECBT_ELEM_CNT);
+    expected += ecbt_stamped(slot, ECBT_ELEM_CNT);
+    slot += ECBT_ELEM_CNT;
+
+    ecbt_write(buff, &write_count, 1);
+    ecbt_read(buff, &read_count, 1);
+    expected += ecbt_stamped(slot++, 1);
+    ecbt_write_n(buff, &write_count, ECBT_ELEM_CNT);
+    nanosleep(&delay, NULL);
+    ecbt_read_n(buff, &read_count, ECBT_ELEM_CNT);
+    expected += ecbt_stamped(slot, ECBT_ELEM_CNT);
+    slot += ECBT_ELEM_CNT;
+#if defined(ECB_DIRECT_ACCESS)
+    ecbt_write_span(buff, &write_count, ECBT_ELEM_CNT);
+    nanosleep(&delay, NULL);
+    ecbt_read_span(buff, &read_count, ECBT_ELEM_CNT);
+    expected += ecbt_stamped(slot, ECBT_ELEM_CNT);
+    slot += ECBT_ELEM_CNT;
+#endif
+
+    ehist_snapshot(buff->timestamp.hist, &snap);
+    if(snap.total != expected)
+    {
+        printf("Unexpected number of latencies recorded! (%llu expected %u)\n",
+                (unsigned long long)snap.total, (unsigned int)expected);
+        assert(false);
+    }
+#if !defined(ECB_TIMESTAMP_TSC) && !defined(ECB_TIMESTAMP_NOW)
+    /* All but the single element round trip waited a millisecond */
+    uint64_t waited = 0;
+    for(unsigned int i = ehist_bucket(1000000); i < EHIST_BUCKETS; i++)
+        waited += snap.count[i];
+    assert(waited + 1 >= expected);
+#endif
+
+    /* Detached, nothing is recorded anymore */
+    uint64_t* stamps = (uint64_t*)buff->timestamp.stamps;
+    ecbuff_timestamp_init(buff, NULL, buff->timestamp.hist);
+    ecbt_write(buff, &write_count, ECBT_ELEM_CNT);
+    ecbt_read(buff, &read_count, ECBT_ELEM_CNT);
+    ehist_snapshot(buff->timestamp.hist, &snap);
+    assert(snap.total == expected);
+    buff->timestamp.stamps = stamps;
+    ecbt_delete(buff);
+}
+#endif
@@ -0,0 +1,173 @@
+/* See ecbuff_var.h for further information */
+
+#include "ecbuff_var.h"
+#include <string.h>
+#include <stdint.h>
+
+#if defined(ECB_ASSERT)
+#include <assert.h>
+
+#if !defined(ASSERT)
+//use standard assert() if nothing custom was defined
+#define ASSERT(x) assert(x)
+#endif
+
+#else
+#define NDEBUG
+#undef ASSERT	//ignore earlier definition from ecbuff_cfg.h
+#define ASSERT(x)
+#endif
+
+#if (ECB_VAR_ALIGN < 4) || (ECB_VAR_ALIGN & (ECB_VAR_ALIGN - 1))
+#error "ECB_VAR_ALIGN has to be a power of two and at least 4"
+#endif
+
+/* The header holds a record's length, or ECB_VAR_WRAP if the record
+ * continues at offset 0. Offsets are always multiples of ECB_VAR_ALIGN,
+ * so there is room for a wrap marker in front of the buffer's end.
+ * wp == rp denotes an empty buffer, hence the producer never advances
+ * wp onto rp.
+ */
+#define ECB_VAR_WRAP UINT32_MAX
+#define ECB_VAR_ROUND(x) (((size_t)(x) + ECB_VAR_ALIGN - 1) & ~(size_t)(ECB_VAR_ALIGN - 1))
+#define ECB_VAR_SPAN(len) (ECB_VAR_ALIGN + ECB_VAR_ROUND(len))
+
+static inline uint32_t* ecbuff_var_hdr(ecbuff_var* const restrict rb, const size_t pos)
+{
+    return (uint32_t*)&rb->data[pos];
+}
+
+void ecbuff_var_init(ecbuff_var* const restrict rb, const ECB_UINT_T size)
+{
+    ASSERT(rb);
+    ASSERT(size >= 4 * ECB_VAR_ALIGN);
+    ASSERT(!(size % ECB_VAR_ALIGN));
+    rb->size = size;
+    rb->alloc_pos = 0;
+    rb->alloc_len = 0;
+    atomic_init(&rb->wp, 0);
+    atomic_init(&rb->rp, 0);
+}
+
+void* ecbuff_var_alloc(ecbuff_var* const restrict rb, const ECB_UINT_T len)
+{
+    ASSERT(rb);
+    if(len >= ECB_VAR_WRAP)
+        return NULL;
+    size_t need = ECB_VAR_SPAN(len);
+    size_t wp = atomic_load_explicit(&rb->wp, memory_order_relaxed);
+    size_t rp = atomic_load_explicit(&rb->rp, memory_order_acquire);
+    size_t pos;
+
+    if(wp < rp)
+    {
+        // Free space lies between wp and rp
+        if(need >= rp - wp)
+            return NULL;
+        pos = wp;
+    }
+    else if(wp + need < rb->size || (wp + need == rb->size && rp))
+    {
+        // Fits in front of the buffer's end, without wrapping onto rp == 0
+        pos = wp;
+    }
+    else if(need < rp)
+    {
+        // Skip the tail, the marker is published along with the record
+        *ecbuff_var_hdr(rb, wp) = ECB_VAR_WRAP;
+        pos = 0;
+    }
+    else
+        return NULL;
+
+    rb->alloc_pos = pos;
+    rb->alloc_len = len;
+    return &rb->data[pos + ECB_VAR_ALIGN];
+}
+
+void ecbuff_var_commit(ecbuff_var* const restrict rb, const ECB_UINT_T len)
+{
+    ASSERT(rb);
+    ASSERT(len <= rb->alloc_len);
+    size_t wp = rb->alloc_pos + ECB_VAR_SPAN(len);
+    if(wp == rb->size)
+        wp = 0;
+    *ecbuff_var_hdr(rb, rb->alloc_pos) = (uint32_t)len;
+    rb->alloc_len = 0;
+    atomic_store_explicit(&rb->wp, wp, memory_order_release);
+}
+
+/* Offset of the oldest record's header, or SIZE_MAX if empty */
+static inline size_t ecbuff_var_head(ecbuff_var* const restrict rb)
+{
+    size_t rp = atomic_load_explicit(&rb->rp, memory_order_relaxed);
+    size_t wp = atomic_load_explicit(&rb->wp, memory_order_acquire);
+    if(rp == wp)
+        return SIZE_MAX;
+    // A wrap marker is always followed by a record at offset 0
+    if(*ecbuff_var_hdr(rb, rp) == ECB_VAR_WRAP)
+        rp = 0;
+    return rp;
+}
+
+const void* ecbuff_var_peek(ecbuff_var* const restrict rb, ECB_UINT_T* const restrict len)
+{
+    ASSERT(rb);
+    ASSERT(len);
+    size_t rp = ecbuff_var_head(rb);
+    if(rp == SIZE_MAX)
+        return NULL;
+    *len = *ecbuff_var_hdr(rb, rp);
+    return &rb->data[rp + ECB_VAR_ALIGN];
+}
+
+void ecbuff_var_release(ecbuff_var* const restrict rb)
+{
+    ASSERT(rb);
+    size_t rp = ecbuff_var_head(rb);
+    ASSERT(rp != SIZE_MAX);
+    rp += ECB_VAR_SPAN(*ecbuff_var_hdr(rb, rp));
+    if(rp == rb->size)
+        rp = 0;
+    atomic_store_explicit(&rb->rp, rp, memory_order_release);
+}
+
+bool ecbuff_var_write(ecbuff_var* const restrict rb, const void* const restrict record, const ECB_UINT_T len)
+{
+    ASSERT(rb);
+    ASSERT(record || !len);
+    void* ptr = ecbuff_var_alloc(rb, len);
+    if(!ptr)
+        return false;
+    memcpy(ptr, record, len);
+    ecbuff_var_commit(rb, len);
+    return true;
+}
+
+bool ecbuff_var_read(ecbuff_var* const restrict rb, void* const restrict record, ECB_UINT_T* const restrict len)
+{
+    ASSERT(rb);
+    ASSERT(len);
+    ECB_UINT_T cap = *len;
+    const void* ptr = ecbuff_var_peek(rb, len);
+    if(!ptr || *len > cap)
+        return false;
+    memcpy(record, ptr, *len);
+    ecbuff_var_release(rb);
+    return true;
+}
+
+bool ecbuff_var_is_empty(const ecbuff_var* const restrict rb)
+{
+    ASSERT(rb);
+    return atomic_load_explicit(&rb->rp, memory_order_acquire) ==
+           atomic_load_explicit(&rb->wp, memory_order_acquire);
+}
+
+ECB_UINT_T ecbuff_var_used(const ecbuff_var* const restrict rb)
+{
+    ASSERT(rb);
+    size_t rp = atomic_load_explicit(&rb->rp, memory_order_acquire);
+    size_t wp = atomic_load_explicit(&rb->wp, memory_order_acquire);
+    return wp >= rp ? wp - rp : rb->size - rp + wp;
+}
@@ -0,0 +1,85 @@
+/*
+ * ecbuff_var is a single-producer/single-consumer byte ring holding
+ * variable-length records. Each record is prefixed by a header carrying its
+ * length and is stored contiguously, a wrap marker makes the consumer skip
+ * the unused bytes at the end of the buffer. This suits messages of widely
+ * varying size, which would waste most of a fixed ecbuff element.
+ *
+ * Records are accessed in place through a two staged API, like ecbuff's
+ * direct access mode:
+ * Producer: ecbuff_var_alloc(len) reserves a record, ecbuff_var_commit()
+ *           publishes it, optionally with a smaller length than reserved.
+ * Consumer: ecbuff_var_peek() returns the oldest record, ecbuff_var_release()
+ *           frees it.
+ * ecbuff_var_write() and ecbuff_var_read() are copying convenience wrappers.
+ *
+ * Headers and records are aligned to ECB_VAR_ALIGN bytes. A record fits into
+ * a drained buffer of size bytes as long as its length doesn't exceed
+ * ECBUFF_VAR_MAX(size), larger ones may fit depending on the current offset.
+ * Other than ecbuff it requires C11 atomics.
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#ifndef ECBUFF_VAR_H
+#define ECBUFF_VAR_H
+
+#include "ecbuff.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+#if !defined(ECB_CACHELINE)
+#define ECB_CACHELINE 64
+#endif
+
+/* ECB_VAR_ALIGN
+ * Header size and record alignment, power of two and at least 4.
+ */
+#if !defined(ECB_VAR_ALIGN)
+#define ECB_VAR_ALIGN 8
+#endif
+
+typedef struct {
+    size_t size;                                /* bytes of record storage */
+    char pad_config[ECB_CACHELINE - sizeof(size_t)];
+    atomic_size_t wp;                           /* offset after the last committed record */
+    size_t alloc_pos;                           /* producer only, offset of the reserved record */
+    size_t alloc_len;                           /* producer only, reserved length */
+    char pad_wp[ECB_CACHELINE - sizeof(atomic_size_t) - 2 * sizeof(size_t)];
+    atomic_size_t rp;                           /* offset of the oldest record */
+    char pad_rp[ECB_CACHELINE - sizeof(atomic_size_t)];
+    char data[];                                /* size bytes */
+} ecbuff_var;
+
+/* Number of bytes to allocate for an instance with size bytes of storage */
+#define ECBUFF_VAR_SIZE(size) (sizeof(ecbuff_var) + (size_t)(size))
+/* Largest record length that always fits into a drained buffer */
+#define ECBUFF_VAR_MAX(size) ((size_t)(size) / 2 - 2 * ECB_VAR_ALIGN)
+
+/* ecbuff_var_init
+ * size has to be a multiple of ECB_VAR_ALIGN and at least 4 * ECB_VAR_ALIGN.
+ * rb has to provide ECBUFF_VAR_SIZE(size) bytes.
+ */
+void ecbuff_var_init(ecbuff_var* const restrict rb, const ECB_UINT_T size);
+
+/* Producer: returns NULL if there is no contiguous space for len bytes */
+void* ecbuff_var_alloc(ecbuff_var* const restrict rb, const ECB_UINT_T len);
+/* Producer: publishes the reserved record, len must not exceed the reserved length */
+void ecbuff_var_commit(ecbuff_var* const restrict rb, const ECB_UINT_T len);
+/* Consumer: returns NULL if empty, otherwise the oldest record and its length */
+const void* ecbuff_var_peek(ecbuff_var* const restrict rb, ECB_UINT_T* const restrict len);
+/* Consumer: frees the record returned by ecbuff_var_peek() */
+void ecbuff_var_release(ecbuff_var* const restrict rb);
+
+/* Return false if there was no space (write) or no record (read).
+ * len passes the capacity of record to ecbuff_var_read() and returns the
+ * record's length. A record exceeding the capacity is left in place.
+ */
+bool ecbuff_var_write(ecbuff_var* const restrict rb, const void* const restrict record, const ECB_UINT_T len);
+bool ecbuff_var_read(ecbuff_var* const restrict rb, void* const restrict record, ECB_UINT_T* const restrict len);
+
+bool ecbuff_var_is_empty(const ecbuff_var* const restrict rb);
+/* Bytes occupied by records, headers and padding included */
+ECB_UINT_T ecbuff_var_used(const ecbuff_var* const restrict rb);
+
+#endif // ECBUFF_VAR_H
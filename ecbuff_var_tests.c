@@ -0,0 +1,263 @@
+/*
+ * Tests for ecbuff_var
+ *
+ * Written by Elias Oenal <ecbuff@eliasoenal.com>, released as public domain.
+ */
+
+#include "ecbuff_var.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define ECBVT_RECORDS 200000
+
+ecbuff_var* ecbvt_new(ECB_UINT_T size);
+void ecbvt_delete(ecbuff_var* buff);
+ECB_UINT_T ecbvt_len(uint32_t seq);
+bool ecbvt_put(ecbuff_var* buff, uint32_t seq);
+bool ecbvt_get(ecbuff_var* buff, uint32_t seq, bool* ok);
+void ecbvt_test_st_basic(ECB_UINT_T count);
+void ecbvt_test_st_limits(void);
+void ecbvt_test_mt_stress(ECB_UINT_T count);
+void* ecbvt_mt_source(void* arg);
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    ecbvt_test_st_limits();
+    ecbvt_test_st_basic(1337);
+    ecbvt_test_mt_stress(5);
+    return 0;
+}
+
+ecbuff_var* ecbvt_new(ECB_UINT_T size)
+{
+    ecbuff_var* buff = malloc(ECBUFF_VAR_SIZE(size));
+    assert(buff);
+    ecbuff_var_init(buff, size);
+    assert(ecbuff_var_is_empty(buff));
+    return buff;
+}
+
+void ecbvt_delete(ecbuff_var* buff)
+{
+    assert(buff);
+    free(buff);
+}
+
+/* Record length and contents are derived from the sequence number */
+ECB_UINT_T ecbvt_len(uint32_t seq)
+{
+    uint32_t h = seq * 2654435761u;
+    // Mostly short records, every eighth one up to the maximum
+    if(h & 0x700)
+        return (h >> 16) % 33;
+    return (h >> 16) % (ECBUFF_VAR_MAX(ECBT_VAR_SIZE) + 1);
+}
+
+static inline uint8_t ecbvt_byte(uint32_t seq, ECB_UINT_T i)
+{
+    return (uint8_t)(seq + i * 7);
+}
+
+/* Alternates between the copying and the in place API, some records
+ * reserve more space than they commit
+ */
+bool ecbvt_put(ecbuff_var* buff, uint32_t seq)
+{
+    uint8_t record[ECBT_VAR_SIZE];
+    ECB_UINT_T len = ecbvt_len(seq);
+    for(ECB_UINT_T i = 0; i < len; i++)
+        record[i] = ecbvt_byte(seq, i);
+
+    if(seq & 1)
+        return ecbuff_var_write(buff, record, len);
+
+    ECB_UINT_T extra = (seq % 3 || len + 12 > ECBUFF_VAR_MAX(ECBT_VAR_SIZE)) ? 0 : 12;
+    uint8_t* ptr = ecbuff_var_alloc(buff, len + extra);
+    if(!ptr)
+        return false;
+    memcpy(ptr, record, len);
+    ecbuff_var_commit(buff, len);
+    return true;
+}
+
+/* Returns false if empty, sets ok to false if the record is corrupt */
+bool ecbvt_get(ecbuff_var* buff, uint32_t seq, bool* ok)
+{
+    uint8_t record[ECBT_VAR_SIZE];
+    ECB_UINT_T len = sizeof(record);
+    *ok = true;
+
+    if(seq & 1)
+    {
+        if(!ecbuff_var_read(buff, record, &len))
+            return false;
+    }
+    else
+    {
+        const uint8_t* ptr = ecbuff_var_peek(buff, &len);
+        if(!ptr)
+            return false;
+        memcpy(record, ptr, len);
+        ecbuff_var_release(buff);
+    }
+
+    if(len != ecbvt_len(seq))
+    {
+        printf("Read unexpected length! (%u instead of %u, record %u)\n",
+               (unsigned)len, (unsigned)ecbvt_len(seq), seq);
+        *ok = false;
+        return true;
+    }
+    for(ECB_UINT_T i = 0; i < len; i++)
+    {
+        if(record[i] != ecbvt_byte(seq, i))
+        {
+            printf("Read unexpected value! (record %u offset %u)\n", seq, (unsigned)i);
+            *ok = false;
+            return true;
+        }
+    }
+    return true;
+}
+
+void ecbvt_test_st_limits(void)
+{
+    ecbuff_var* buff = ecbvt_new(ECBT_VAR_SIZE);
+    uint8_t record[ECBT_VAR_SIZE];
+    ECB_UINT_T len;
+    memset(record, 0x5a, sizeof(record));
+
+    // Nothing to read, a too large record doesn't fit
+    len = sizeof(record);
+    assert(!ecbuff_var_peek(buff, &len));
+    assert(!ecbuff_var_read(buff, record, &len));
+    assert(!ecbuff_var_write(buff, record, ECBT_VAR_SIZE));
+
+    // Empty records are valid
+    assert(ecbuff_var_write(buff, record, 0));
+    assert(!ecbuff_var_is_empty(buff));
+    assert(ecbuff_var_used(buff) == ECB_VAR_ALIGN);
+    len = 0;
+    assert(ecbuff_var_read(buff, record, &len) && len == 0);
+    assert(ecbuff_var_is_empty(buff));
+
+    // A record exceeding the read capacity stays in place
+    assert(ecbuff_var_write(buff, record, 3));
+    len = 2;
+    assert(!ecbuff_var_read(buff, record, &len) && len == 3);
+    assert(ecbuff_var_read(buff, record, &len) && len == 3);
+
+    // The largest guaranteed record fits at varying offsets of a drained buffer
+    for(ECB_UINT_T i = 0; i < ECBT_VAR_SIZE / ECB_VAR_ALIGN; i++)
+    {
+        assert(ecbuff_var_write(buff, record, ECBUFF_VAR_MAX(ECBT_VAR_SIZE)));
+        len = sizeof(record);
+        assert(ecbuff_var_read(buff, record, &len) && len == ECBUFF_VAR_MAX(ECBT_VAR_SIZE));
+        assert(ecbuff_var_write(buff, record, 0));
+        len = 0;
+        assert(ecbuff_var_read(buff, record, &len));
+        assert(ecbuff_var_is_empty(buff));
+    }
+
+    ecbvt_delete(buff);
+}
+
+void ecbvt_test_st_basic(ECB_UINT_T count)
+{
+    ecbuff_var* buff = ecbvt_new(ECBT_VAR_SIZE);
+    uint32_t wseq = 0;
+    uint32_t rseq = 0;
+    bool ok;
+
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        ECB_UINT_T num = rand() % 16;
+        for(ECB_UINT_T j = 0; j < num && ecbvt_put(buff, wseq); j++)
+            wseq++;
+
+        num = rand() % (wseq - rseq + 1);
+        for(ECB_UINT_T j = 0; j < num; j++, rseq++)
+        {
+            assert(ecbvt_get(buff, rseq, &ok));
+            if(!ok)
+            {
+                assert(false);
+                return;
+            }
+        }
+        assert(ecbuff_var_is_empty(buff) == (wseq == rseq));
+        assert(ecbuff_var_used(buff) < ECBT_VAR_SIZE);
+    }
+
+    while(rseq != wseq)
+    {
+        assert(ecbvt_get(buff, rseq++, &ok));
+        assert(ok);
+    }
+    assert(!ecbvt_get(buff, rseq, &ok));
+    assert(ecbuff_var_used(buff) == 0);
+    ecbvt_delete(buff);
+}
+
+void ecbvt_test_mt_stress(ECB_UINT_T count)
+{
+    ecbuff_var* buff = ecbvt_new(ECBT_VAR_SIZE);
+
+    for(ECB_UINT_T i = 0; i < count; i++)
+    {
+        pthread_t thread;
+        ecbuff_var_init(buff, ECBT_VAR_SIZE);
+        if(pthread_create(&thread, NULL, ecbvt_mt_source, buff))
+        {
+            printf("Failed to spawn thread!\n");
+            assert(false);
+            return;
+        }
+
+        for(uint32_t seq = 0; seq < ECBVT_RECORDS;)
+        {
+            bool ok;
+            if(!ecbvt_get(buff, seq, &ok))
+            {
+                sched_yield();
+                continue;
+            }
+            if(!ok)
+            {
+                assert(false);
+                return;
+            }
+            seq++;
+        }
+
+        pthread_join(thread, NULL);
+        assert(ecbuff_var_is_empty(buff));
+    }
+
+    ecbvt_delete(buff);
+}
+
+void* ecbvt_mt_source(void* arg)
+{
+    ecbuff_var* buff = arg;
+
+    for(uint32_t seq = 0; seq < ECBVT_RECORDS;)
+    {
+        if(!ecbvt_put(buff, seq))
+        {
+            sched_yield();
+            continue;
+        }
+        seq++;
+    }
+
+    pthread_exit((void*)true);
+}
@@ -0,0 +1,164 @@
+/* Blocking access for ecbuff, see ECB_WAIT in ecbuff_cfg.h */
+
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // syscall()
+#endif
+
+#include "ecbuff.h"
+
+#if defined(ECB_WAIT)
+
+#if defined(ECB_ASSERT)
+#include <assert.h>
+
+#if !defined(ASSERT)
+//use standard assert() if nothing custom was defined
+#define ASSERT(x) assert(x)
+#endif
+
+#else
+#define NDEBUG
+#undef ASSERT	//ignore earlier definition from ecbuff_cfg.h
+#define ASSERT(x)
+#endif
+
+/* ECB_WAIT_SPIN
+ * Number of polls before parking, covering short gaps without a syscall.
+ */
+#if !defined(ECB_WAIT_SPIN)
+#define ECB_WAIT_SPIN 256
+#endif
+
+#if !defined(ECB_WAIT_PAUSE)
+#if defined(__x86_64__) || defined(__i386__)
+#define ECB_WAIT_PAUSE() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define ECB_WAIT_PAUSE() __asm__ __volatile__("yield")
+#else
+#define ECB_WAIT_PAUSE()
+#endif
+#endif
+
+/* ECB_WAIT_PARK(parked, timeout_us) has to block while *parked is 1, for at
+ * most timeout_us (ECB_WAIT_FOREVER: indefinitely) and may return early.
+ * ECB_WAIT_WAKE(parked) wakes a thread blocked on parked.
+ * ECB_WAIT_NOW_US() returns a monotonic time in microseconds.
+ * Linux defaults to futexes, other platforms (e.g. an RTOS) define their own.
+ */
+#if !defined(ECB_WAIT_PARK)
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+
+static inline void ecbuff_futex_park(ECB_PARKED_T* const restrict parked, const uint32_t timeout_us)
+{
+    struct timespec ts;
+    struct timespec* pts = NULL;
+    if(timeout_us != ECB_WAIT_FOREVER)
+    {
+        ts.tv_sec = timeout_us / 1000000;
+        ts.tv_nsec = (long)(timeout_us % 1000000) * 1000;
+        pts = &ts;
+    }
+    // Returns right away if *parked is no longer 1. Not FUTEX_PRIVATE_FLAG,
+    // the buffer may be shared between processes (ecbuff_shm).
+    syscall(SYS_futex, (uint32_t*)parked, FUTEX_WAIT, 1, pts, NULL, 0);
+}
+
+static inline void ecbuff_futex_wake(ECB_PARKED_T* const restrict parked)
+{
+    syscall(SYS_futex, (uint32_t*)parked, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+static inline uint64_t ecbuff_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+#define ECB_WAIT_PARK(parked, timeout_us) ecbuff_futex_park((parked), (timeout_us))
+#define ECB_WAIT_WAKE(parked) ecbuff_futex_wake(parked)
+#define ECB_WAIT_NOW_US() ecbuff_now_us()
+#else
+#error ECB_WAIT requires ECB_WAIT_PARK(), ECB_WAIT_WAKE() and ECB_WAIT_NOW_US() on this platform!
+#endif /* __linux__ */
+#endif /* ECB_WAIT_PARK */
+
+static inline bool ecbuff_wait_ready(const ecbuff* const restrict rb, const bool consumer)
+{
+    return consumer ? !ecbuff_is_empty(rb) : !ecbuff_is_full(rb);
+}
+
+/* Spin, then announce being parked and re-check before actually parking.
+ * Pairs with ecbuff_notify() in ecbuff.c.
+ */
+static bool ecbuff_wait_private(const ecbuff* const restrict rb, ECB_PARKED_T* const restrict parked,
+                                const bool consumer, const uint32_t timeout_us)
+{
+    for(unsigned int i = 0; i < ECB_WAIT_SPIN; i++)
+    {
+        if(ecbuff_wait_ready(rb, consumer))
+            return true;
+        ECB_WAIT_PAUSE();
+    }
+
+    uint64_t deadline = 0;
+    if(timeout_us != ECB_WAIT_FOREVER)
+        deadline = ECB_WAIT_NOW_US() + timeout_us;
+
+    for(;;)
+    {
+        atomic_store_explicit(parked, 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        if(ecbuff_wait_ready(rb, consumer))
+            break;
+
+        uint32_t remaining = ECB_WAIT_FOREVER;
+        if(timeout_us != ECB_WAIT_FOREVER)
+        {
+            uint64_t now = ECB_WAIT_NOW_US();
+            if(now >= deadline)
+            {
+                atomic_store_explicit(parked, 0, memory_order_relaxed);
+                return false;
+            }
+            remaining = (uint32_t)(deadline - now);
+        }
+        ECB_WAIT_PARK(parked, remaining);
+    }
+
+    atomic_store_explicit(parked, 0, memory_order_relaxed);
+    return true;
+}
+
+bool ecbuff_read_wait(ecbuff* const restrict rb, void* const restrict element, const uint32_t timeout_us)
+{
+    ASSERT(rb);
+    ASSERT(element);
+    if(!ecbuff_wait_private(rb, &rb->rd_parked, true, timeout_us))
+        return false;
+    (void)ecbuff_read(rb, element);
+    return true;
+}
+
+bool ecbuff_write_wait(ecbuff* const restrict rb, const void* const restrict element, const uint32_t timeout_us)
+{
+    ASSERT(rb);
+    ASSERT(element);
+    if(!ecbuff_wait_private(rb, &rb->wr_parked, false, timeout_us))
+        return false;
+    (void)ecbuff_write(rb, element);
+    return true;
+}
+
+void ecbuff_wake(ECB_PARKED_T* const restrict parked)
+{
+    ASSERT(parked);
+    atomic_store_explicit(parked, 0, memory_order_relaxed);
+    ECB_WAIT_WAKE(parked);
+}
+
+#endif /* ECB_WAIT */
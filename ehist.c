@@ -0,0 +1,102 @@
+/*
+ * See ehist.h for further information.
+ *
+ * Written by Elias Oenal <ehist@eliasoenal.com>, released as public domain.
+ */
+
+#include "ehist.h"
+
+#if defined(EHIST_ASSERT)
+#include <assert.h>
+#else
+#define NDEBUG
+#define assert(x)
+#endif
+
+static inline unsigned int ehist_msb(uint64_t value)
+{
+#if defined(__GNUC__)
+    return 63u - (unsigned int)__builtin_clzll(value);
+#else
+    unsigned int msb = 0;
+    while(value >>= 1)
+        msb++;
+    return msb;
+#endif
+}
+
+unsigned int ehist_bucket(const uint64_t value)
+{
+    if(value < EHIST_SUB)
+        return (unsigned int)value;
+    const unsigned int shift = ehist_msb(value) - EHIST_SUB_BITS;
+    return (shift + 1) * EHIST_SUB + (unsigned int)(value >> shift) - EHIST_SUB;
+}
+
+uint64_t ehist_bucket_low(const unsigned int bucket)
+{
+    assert(bucket < EHIST_BUCKETS);
+    if(bucket < EHIST_SUB)
+        return bucket;
+    const unsigned int shift = bucket / EHIST_SUB - 1;
+    return (uint64_t)(bucket % EHIST_SUB + EHIST_SUB) << shift;
+}
+
+uint64_t ehist_bucket_high(const unsigned int bucket)
+{
+    assert(bucket < EHIST_BUCKETS);
+    if(bucket < EHIST_SUB)
+        return bucket;
+    /* Inclusive, so the topmost bucket ends at UINT64_MAX without overflow */
+    const unsigned int shift = bucket / EHIST_SUB - 1;
+    return ehist_bucket_low(bucket) + ((UINT64_C(1) << shift) - 1);
+}
+
+void ehist_init(ehist* const restrict hist)
+{
+    assert(hist);
+    for(unsigned int i = 0; i < EHIST_BUCKETS; i++)
+        atomic_init(&hist->count[i], 0);
+}
+
+void ehist_record(ehist* const restrict hist, const uint64_t value)
+{
+    assert(hist);
+    atomic_fetch_add_explicit(&hist->count[ehist_bucket(value)], 1, memory_order_relaxed);
+}
+
+void ehist_snapshot(const ehist* const restrict hist, ehist_snap* const restrict snap)
+{
+    assert(hist);
+    assert(snap);
+    snap->total = 0;
+    for(unsigned int i = 0; i < EHIST_BUCKETS; i++)
+    {
+        snap->count[i] = atomic_load_explicit(&hist->count[i], memory_order_relaxed);
+        snap->total += snap->count[i];
+    }
+}
+
+uint64_t ehist_percentile(const ehist_snap* const restrict snap, const double q)
+{
+    assert(snap);
+    assert(q >= 0.0 && q <= 1.0);
+    if(!snap->total)
+        return 0;
+    /* Rank of the value sought, 1-based */
+    uint64_t rank = (uint64_t)(q * (double)snap->total);
+    if((double)rank < q * (double)snap->total)
+        rank++;
+    if(!rank)
+        rank = 1;
+    if(rank > snap->total)
+        rank = snap->total;
+    uint64_t seen = 0;
+    for(unsigned int i = 0; i < EHIST_BUCKETS; i++)
+    {
+        seen += snap->count[i];
+        if(seen >= rank)
+            return ehist_bucket_high(i);
+    }
+    return ehist_bucket_high(EHIST_BUCKETS - 1);
+}
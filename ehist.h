@@ -0,0 +1,59 @@
+/*
+ * ehist is a log-linear histogram for latencies and other non-negative
+ * integer values. Values below 2^EHIST_SUB_BITS get a bucket each, above
+ * that every power of two is split into 2^EHIST_SUB_BITS equal buckets,
+ * which bounds the relative error to 2^-EHIST_SUB_BITS over the whole
+ * 64-bit range at a fixed size. Recording is a single relaxed atomic add,
+ * lock-free and safe from several threads, while any thread may take
+ * snapshots to evaluate. Requires C11 atomics.
+ *
+ * Written by Elias Oenal <ehist@eliasoenal.com>, released as public domain.
+ */
+
+#ifndef EHIST_H
+#define EHIST_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/* EHIST_SUB_BITS
+ * Buckets per power of two are 2^EHIST_SUB_BITS, 4 gives a relative
+ * error of 6.25% at 976 buckets (7.8 KiB).
+ */
+#if !defined(EHIST_SUB_BITS)
+#define EHIST_SUB_BITS 4
+#endif
+
+#define EHIST_SUB (1u << EHIST_SUB_BITS)
+#define EHIST_BUCKETS ((65 - EHIST_SUB_BITS) * EHIST_SUB)
+
+typedef struct {
+    atomic_uint_least64_t count[EHIST_BUCKETS];
+} ehist;
+
+typedef struct {
+    uint64_t count[EHIST_BUCKETS];
+    uint64_t total;                             /* sum of count[] */
+} ehist_snap;
+
+void ehist_init(ehist* const restrict hist);
+void ehist_record(ehist* const restrict hist, const uint64_t value);
+
+/* ehist_snapshot
+ * Copies the counters. Each counter is read atomically, but values recorded
+ * meanwhile may be partially included.
+ */
+void ehist_snapshot(const ehist* const restrict hist, ehist_snap* const restrict snap);
+
+/* ehist_percentile
+ * Upper bound of the bucket holding the q-quantile (0.0 to 1.0) of snap,
+ * i.e. at least q of the values recorded are less or equal. 0 if empty.
+ */
+uint64_t ehist_percentile(const ehist_snap* const restrict snap, const double q);
+
+/* Bucket of value and the range of values [low, high] a bucket holds */
+unsigned int ehist_bucket(const uint64_t value);
+uint64_t ehist_bucket_low(const unsigned int bucket);
+uint64_t ehist_bucket_high(const unsigned int bucket);
+
+#endif // EHIST_H
@@ -0,0 +1,39 @@
+#!/usr/bin/env bash
+# Tests for ehist
+# Written and placed into the public domain by
+# Elias Oenal <ehist@eliasoenal.com>
+
+set -e
+
+BUILD="ehist_build_test"
+rm -rf "./${BUILD}"
+mkdir -p "./${BUILD}"
+
+CC=cc
+COMMON="-Wall -Wextra -pthread -DEHIST_ASSERT"
+FILES="ehist.c ehist_tests.c"
+
+RED="\033[0;31m"
+GREEN="\033[0;32m"
+NC="\033[0m"
+PASS="${GREEN}Passed:${NC}"
+PASS_CNT=0
+FAIL="${RED}Failed:${NC}"
+FAIL_CNT=0
+
+
+
+TESTNAME="default"
+${CC} ${COMMON} ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="sub_bits_2"
+${CC} ${COMMON} -DEHIST_SUB_BITS=2 ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+TESTNAME="sub_bits_7"
+${CC} ${COMMON} -DEHIST_SUB_BITS=7 ${FILES} -o ./${BUILD}/${TESTNAME}
+if ./${BUILD}/${TESTNAME}; then ((++PASS_CNT)); echo -e "${PASS} ${TESTNAME}"; else ((++FAIL_CNT)); echo -e "${FAIL} ${TESTNAME}"; fi
+
+
+echo -e "Total ${PASS} ${PASS_CNT} ${FAIL} ${FAIL_CNT}"
@@ -0,0 +1,119 @@
+/*
+ * Tests for ehist
+ *
+ * Written by Elias Oenal <ehist@eliasoenal.com>, released as public domain.
+ */
+
+#include "ehist.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <pthread.h>
+
+#define EHT_THREADS 4
+#define EHT_PER_THREAD 100000
+
+void eht_test_buckets(void);
+void eht_test_percentile(void);
+void eht_test_mt(void);
+void* eht_mt_thread(void* arg);
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    eht_test_buckets();
+    eht_test_percentile();
+    eht_test_mt();
+    return 0;
+}
+
+/* Buckets tile the whole range without gaps, and values land inside theirs */
+void eht_test_buckets(void)
+{
+    assert(ehist_bucket_low(0) == 0);
+    for(unsigned int i = 1; i < EHIST_BUCKETS; i++)
+    {
+        assert(ehist_bucket_low(i) == ehist_bucket_high(i - 1) + 1);
+        assert(ehist_bucket(ehist_bucket_low(i)) == i);
+        assert(ehist_bucket(ehist_bucket_high(i)) == i);
+        /* Width stays within the relative error bound */
+        assert(ehist_bucket_high(i) - ehist_bucket_low(i) <= ehist_bucket_low(i) / EHIST_SUB);
+    }
+    assert(ehist_bucket_high(EHIST_BUCKETS - 1) == UINT64_MAX);
+    assert(ehist_bucket(UINT64_MAX) == EHIST_BUCKETS - 1);
+
+    uint64_t value = 1;
+    for(unsigned int i = 0; i < 10000; i++)
+    {
+        value = value * 6364136223846793005ull + 1442695040888963407ull;
+        uint64_t v = value >> (i % 64);
+        unsigned int bucket = ehist_bucket(v);
+        assert(ehist_bucket_low(bucket) <= v && v <= ehist_bucket_high(bucket));
+    }
+}
+
+void eht_test_percentile(void)
+{
+    static ehist hist;
+    ehist_snap snap;
+    ehist_init(&hist);
+    ehist_snapshot(&hist, &snap);
+    assert(snap.total == 0);
+    assert(ehist_percentile(&snap, 0.5) == 0);
+
+    /* Results are the upper bound of the bucket holding the ranked value */
+    for(uint64_t v = 1; v <= 10; v++)
+        ehist_record(&hist, v);
+    ehist_snapshot(&hist, &snap);
+    assert(snap.total == 10);
+    assert(ehist_percentile(&snap, 0.0) == ehist_bucket_high(ehist_bucket(1)));
+    assert(ehist_percentile(&snap, 0.5) == ehist_bucket_high(ehist_bucket(5)));
+    assert(ehist_percentile(&snap, 0.51) == ehist_bucket_high(ehist_bucket(6)));
+    assert(ehist_percentile(&snap, 1.0) == ehist_bucket_high(ehist_bucket(10)));
+
+    /* One outlier dominates only the top */
+    ehist_record(&hist, 1000000);
+    ehist_snapshot(&hist, &snap);
+    assert(ehist_percentile(&snap, 0.9) == ehist_bucket_high(ehist_bucket(10)));
+    uint64_t max = ehist_percentile(&snap, 1.0);
+    assert(max >= 1000000 && max <= 1000000 + 1000000 / EHIST_SUB);
+}
+
+void eht_test_mt(void)
+{
+    static ehist hist;
+    ehist_init(&hist);
+    pthread_t threads[EHT_THREADS];
+    for(int i = 0; i < EHT_THREADS; i++)
+    {
+        if(pthread_create(&threads[i], NULL, eht_mt_thread, &hist))
+        {
+            printf("Failed to spawn thread!\n");
+            assert(false);
+            return;
+        }
+    }
+    for(int i = 0; i < EHT_THREADS; i++)
+        pthread_join(threads[i], NULL);
+
+    ehist_snap snap;
+    ehist_snapshot(&hist, &snap);
+    if(snap.total != (uint64_t)EHT_THREADS * EHT_PER_THREAD)
+    {
+        printf("Lost updates! (%llu recorded)\n", (unsigned long long)snap.total);
+        assert(false);
+    }
+    for(uint64_t v = 0; v < 100; v++)
+        assert(snap.count[ehist_bucket(v)] >= (uint64_t)EHT_THREADS * (EHT_PER_THREAD / 100));
+}
+
+void* eht_mt_thread(void* arg)
+{
+    ehist* hist = arg;
+    for(uint32_t i = 0; i < EHT_PER_THREAD; i++)
+        ehist_record(hist, i % 100);
+    pthread_exit((void*)true);
+}